@@ -0,0 +1,856 @@
+/*********************************************************************************
+* Description: Timing benchmarks for the stages of the interpreter
+* Author(s): Isaac Joffe
+* Copyright: University of Alberta, 2024
+* License: CC-BY-4.0
+*********************************************************************************/
+
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "cache.h"
+#include "chunk.h"
+#include "compiler.h"
+#include "environment.h"
+#include "evaluator.h"
+#include "interpreter.h"
+#include "lexer.h"
+#include "operations.h"
+#include "optimizer.h"
+#include "parser.h"
+#include "resolver.h"
+#include "source.h"
+#include "symbols.h"
+#include "tree.h"
+#include "vm.h"
+
+
+// the number of scopes nested inside the global scope by the scopes benchmark
+#define MAX_BENCH_DEPTH 4
+
+// the number of characters set aside for each name made up by the environment benchmark
+#define BENCH_NAME_LEN 16
+
+// the number of variables created before the ones used by the variables benchmark
+#define NUM_OTHER_VARIABLES 60
+
+// the line repeated to make up the scripts of the script benchmark
+#define SCRIPT_LINE "x = x + 1\n"
+
+// the number of times the layout benchmark lexes and parses each command
+#define NUM_PARSE_REPEATS 100000
+
+// the number of bytes of source generated for each input of the lexer benchmark
+#define LEXER_INPUT_LEN (4 * 1024 * 1024)
+
+// the number of times the lexer benchmark scans each input, keeping the fastest
+#define NUM_LEXER_REPEATS 5
+
+// the number of times the cache benchmark sends its handful of commands
+#define NUM_CACHE_ROUNDS 20000
+
+// the number of operands in the longest expression of the parser benchmark
+#define MAX_PARSER_OPERANDS 4096
+
+// the number of operands parsed in total for each expression length of the parser benchmark
+#define NUM_PARSER_OPERANDS 4000000
+
+// the number of times the operators benchmark applies each operator
+#define NUM_OPERATOR_CALLS 20000000
+
+
+/** These benchmarks are not part of the interpreter itself; they exist to measure its speed.
+    Each one runs some Python source through the real lexer and parser, and then times only the stage of interest.
+    Sources are written on a single line, just like a command typed at the prompt.
+*/
+
+
+/**
+ * \brief Provides the current time for measuring how long something takes.
+ * \return The number of seconds since some fixed point in the past.
+ */
+double now() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+/**
+ * \brief Executes a single command within a given scope, timing only execution.
+ * \param [in] source Python source of the command (which need not be null-terminated).
+ * \param [in] length The number of characters in the command.
+ * \param [inout] env Pointer to the environment of the scope to run the command in.
+ * \param [in] use_vm True to use the compiler and virtual machine; false to use the tree-walk evaluator.
+ * \param [in] optimize True to replace the parts of the command known before it runs with their values first.
+ * \return The number of seconds taken to execute the command; a negative number if it failed to compile.
+ */
+double run_command(const char * source, int length, environment * env, bool use_vm, bool optimize) {
+    Evaluator evaluator(env);
+    VirtualMachine machine(env);
+    // lex, parse and resolve the command, which is not being measured
+    Lexer lexer(source, length);
+    syntax_tree tree;
+    Parser parser(&lexer, &tree);
+    if (parser.parse_input()) {
+        printf("benchmark source failed to parse: %.*s\n", length, source);
+        free_tree(&tree);
+        return -1;
+    }
+    if (optimize) {
+        Optimizer optimizer(&tree);
+        optimizer.optimize_input();
+    }
+    Resolver resolver(&tree, env);
+    if (resolver.resolve_input()) {
+        printf("benchmark source failed to resolve: %s\n", source);
+        free_tree(&tree);
+        return -1;
+    }
+    // execute the command
+    output_text output;
+    double start = now();
+    if (use_vm) {
+        chunk bytecode;
+        Compiler compiler(&tree, &bytecode);
+        if (!compiler.compile_input()) {
+            machine.run_input(&bytecode, &output);
+        }
+        free_chunk(&bytecode);
+    } else {
+        evaluator.evaluate_input(&tree, &output);
+    }
+    double elapsed = now() - start;
+    free_tree(&tree);
+    free_output(&output);
+    return elapsed;
+}
+
+
+/**
+ * \brief Executes a command with a fresh environment, timing only execution.
+ * \param [in] setup Python source run beforehand (untimed) to create the variables needed, one command per line.
+ * \param [in] source Python source to time.
+ * \param [in] use_vm True to use the compiler and virtual machine; false to use the tree-walk evaluator.
+ * \param [in] optimize True to replace the parts of each command known before it runs with their values first.
+ * \return The number of seconds taken to execute the source.
+ */
+double time_execution(const char * setup, const char * source, bool use_vm, bool optimize) {
+    environment env;
+    double elapsed = 0;
+    const char * next = setup;
+    while (next) {
+        // take the next line of the setup, or the source once the setup is done, however long it is
+        const char * line = next;
+        const char * end = strchr(line, '\n');
+        int length = end ? (end - line) : strlen(line);
+        bool timed = (line == source);
+        next = end ? (end + 1) : (timed ? NULL : source);
+        // execute the command, only timing the source of interest
+        elapsed = run_command(line, length, &env, use_vm, optimize);
+        if (elapsed < 0) {
+            elapsed = 0;
+            break;
+        }
+    }
+    free_environment(&env);
+    return elapsed;
+}
+
+
+/**
+ * \brief Compares the tree-walk evaluator and the virtual machine on a loop.
+ * \param [in] name The label to print for this loop.
+ * \param [in] setup Python source run beforehand (untimed) to create the variables needed.
+ * \param [in] source Python source for the loop to time.
+ */
+void compare_executors(const char * name, const char * setup, const char * source) {
+    double tree_walk = time_execution(setup, source, false, false);
+    double bytecode = time_execution(setup, source, true, false);
+    printf("%-24s tree-walk %8.2f ms    bytecode %8.2f ms    speedup %5.2fx\n",
+           name, tree_walk * 1000, bytecode * 1000, tree_walk / bytecode);
+}
+
+
+/**
+ * \brief Times while and for loops under both executors.
+ */
+void benchmark_loops() {
+    printf("loops (execution time only):\n");
+    compare_executors("while counter", "i = 0", "while i < 1000000: i += 1");
+    compare_executors("while arithmetic", "i = 0; t = 0", "while i < 300000: i += 1; t = (t + i * 3) % 7");
+    compare_executors("while branching", "i = 0; t = 0", "while i < 300000: i += 1; if i & 1: t += i");
+    compare_executors("for over string", "s = 'abcdefghijklmnopqrstuvwxyz'; n = 0",
+                      "while n < 20000: n += 1; for c in s: t = c");
+}
+
+
+/**
+ * \brief Times loops dominated by break and continue statements under both executors.
+ */
+void benchmark_control() {
+    printf("control (execution time only):\n");
+    compare_executors("while continue", "i = 0", "while i < 100000: i += 1; continue");
+    compare_executors("while skip odd", "i = 0; t = 0", "while i < 100000: i += 1; if i & 1: continue");
+    compare_executors("for continue", "s = 'abcdefghijklmnopqrstuvwxyz'; n = 0",
+                      "while n < 5000: n += 1; for c in s: continue");
+    compare_executors("for break", "s = 'abcdefghijklmnopqrstuvwxyz'; n = 0",
+                      "while n < 100000: n += 1; for c in s: break");
+}
+
+
+/**
+ * \brief Times loops that use a variable created after many others under both executors.
+ */
+void benchmark_variables() {
+    // create enough variables to nearly fill the environment, with the ones used last
+    static char setup[NUM_OTHER_VARIABLES * 16] = "";
+    if (!setup[0]) {
+        for (int i = 0; i < NUM_OTHER_VARIABLES; i++) {
+            sprintf(setup + strlen(setup), "v%d = %d\n", i, i);
+        }
+        strcat(setup, "i = 0; t = 0; s = 'abcdefghijklmnopqrstuvwxyz'");
+    }
+    printf("variables (execution time only, %d variables defined):\n", NUM_OTHER_VARIABLES + 4);
+    compare_executors("while counter", setup, "while i < 1000000: i += 1");
+    compare_executors("while accumulate", setup, "while i < 300000: i += 1; t += v1 + v50");
+    compare_executors("for over string", setup, "while i < 20000: i += 1; for c in s: t = c");
+}
+
+
+/**
+ * \brief Times creating and looking up variables as the environment grows.
+ */
+void benchmark_environment() {
+    printf("environment (per variable operation):\n");
+    const int num_lookups = 1000000;
+    for (int num_variables = 10; num_variables <= 100000; num_variables *= 10) {
+        environment env;
+        // make all the names beforehand
+        char (*names)[BENCH_NAME_LEN] = (char (*)[BENCH_NAME_LEN]) malloc(num_variables * BENCH_NAME_LEN);
+        int * symbols = (int *) malloc(num_variables * sizeof(int));
+        for (int i = 0; i < num_variables; i++) {
+            sprintf(names[i], "var%d", i);
+        }
+        // intern every name, which is what the lexer does the first time it sees an identifier
+        double start = now();
+        for (int i = 0; i < num_variables; i++) {
+            symbols[i] = intern_symbol(names[i]);
+        }
+        double intern_time = now() - start;
+        // look the names up again, as the lexer does for every later use of an identifier
+        long checksum = 0;
+        start = now();
+        for (int i = 0; i < num_lookups; i++) {
+            checksum += intern_symbol(names[(i * 7919L) % num_variables]);
+        }
+        double relex_time = now() - start;
+        // create every variable, which is what the resolver does the first time it sees a symbol
+        start = now();
+        for (int i = 0; i < num_variables; i++) {
+            declare_variable(&env, symbols[i]);
+        }
+        double declare_time = now() - start;
+        // look the variables up again, spread evenly over all of them
+        start = now();
+        for (int i = 0; i < num_lookups; i++) {
+            checksum += find_variable(&env, symbols[(i * 7919L) % num_variables]);
+        }
+        double lookup_time = now() - start;
+        printf("%6d variables    intern %6.1f ns    re-intern %6.1f ns    declare %6.1f ns    lookup %6.1f ns    (checksum %ld)\n",
+               num_variables, intern_time * 1e9 / num_variables, relex_time * 1e9 / num_lookups,
+               declare_time * 1e9 / num_variables, lookup_time * 1e9 / num_lookups, checksum);
+        free(names);
+        free(symbols);
+        free_environment(&env);
+    }
+}
+
+
+/**
+ * \brief Times a loop that reads global variables from inside nested scopes under both executors.
+ */
+void benchmark_scopes() {
+    printf("scopes (execution time only, globals read from nested scopes):\n");
+    for (int depth = 0; depth <= MAX_BENCH_DEPTH; depth += MAX_BENCH_DEPTH / 2) {
+        double times[2];
+        int totals[2];
+        for (int use_vm = 0; use_vm < 2; use_vm++) {
+            // chain the scopes together, with the global scope outermost
+            environment scopes[MAX_BENCH_DEPTH + 1];
+            for (int i = 1; i <= depth; i++) {
+                scopes[i].enclosing = &(scopes[i - 1]);
+            }
+            environment * innermost = &(scopes[depth]);
+            const char * globals = "a = 3; b = 4";
+            const char * locals = "n = 0; t = 0";
+            const char * loop = "while n < 300000: n += 1; t = t + a * b";
+            run_command(globals, strlen(globals), &(scopes[0]), use_vm, false);
+            run_command(locals, strlen(locals), innermost, use_vm, false);
+            times[use_vm] = run_command(loop, strlen(loop), innermost, use_vm, false);
+            // make sure the loop really found the globals
+            literal_value total;
+            totals[use_vm] = read_variable(innermost, "t", &total) ? -1 : number_of(&total);
+            for (int i = 0; i <= depth; i++) {
+                free_environment(&(scopes[i]));
+            }
+        }
+        printf("depth %d                  tree-walk %8.2f ms    bytecode %8.2f ms    (t = %d, %d)\n",
+               depth, times[0] * 1000, times[1] * 1000, totals[0], totals[1]);
+    }
+}
+
+
+/**
+ * \brief Finds the size of the type-specific part of a syntax tree node.
+ * \param [in] tree_node Pointer to the syntax tree node to measure.
+ * \return The number of bytes in the node's entry.
+ */
+int entry_size(const node * tree_node) {
+    switch (tree_node -> type) {
+        case ASSIGN_NODE:
+            return sizeof(assign_value);
+        case BINARY_NODE:
+            return sizeof(binary_value);
+        case BLOCK_NODE:
+            return sizeof(block_value);
+        case FORLOOP_NODE:
+            return sizeof(forloop_value);
+        case GROUPING_NODE:
+            return sizeof(grouping_value);
+        case IFELSE_NODE:
+            return sizeof(ifelse_value);
+        case LITERAL_NODE:
+            return sizeof(tree_node -> entry.literal_val);
+        case LOGICAL_NODE:
+            return sizeof(logical_value);
+        case SPECIAL_NODE:
+            return sizeof(special_value);
+        case UNARY_NODE:
+            return sizeof(unary_value);
+        case VARIABLE_NODE:
+            return sizeof(variable_value);
+        case WHILELOOP_NODE:
+            return sizeof(whileloop_value);
+    }
+    return 0;
+}
+
+
+/**
+ * \brief Estimates the bytes copied to visit each node of a syntax tree under both calling conventions, from the sizes involved.
+ * \param [in] tree Pointer to the syntax tree containing the node.
+ * \param [in] index The index of the syntax tree (or subtree, or node) to count.
+ * \param [inout] num_nodes Pointer to the running count of nodes.
+ * \param [inout] by_value Pointer to the running estimate of bytes copied when nodes and results are passed by value.
+ * \param [inout] by_pointer Pointer to the running estimate of bytes copied when they are passed by pointer.
+ */
+void model_copies(const syntax_tree * tree, int index, long * num_nodes, long * by_value, long * by_pointer) {
+    if (index == NO_NODE) {
+        return;
+    }
+    const node * tree_node = node_at(tree, index);
+    // nothing is counted as it runs, so this is a model of the calls: each node is visited once, with no loop repeating it
+    // evaluate(node) copied the node and evaluate_xxx(xxx_value) copied its entry, then each returned a value
+    (*num_nodes)++;
+    *by_value += sizeof(node) + entry_size(tree_node) + 2 * sizeof(literal_value);
+    // now each of the two calls passes only a pointer to its input and a pointer to its result slot
+    *by_pointer += 4 * sizeof(void *);
+    // visit the children of this node
+    int children[4] = {NO_NODE, NO_NODE, NO_NODE, NO_NODE};
+    switch (tree_node -> type) {
+        case ASSIGN_NODE:
+            children[0] = tree_node -> entry.assign_val.value;
+            break;
+        case BINARY_NODE:
+            children[0] = tree_node -> entry.binary_val.left;
+            children[1] = tree_node -> entry.binary_val.right;
+            break;
+        case BLOCK_NODE:
+            for (int i = 0; i < (tree_node -> entry.block_val.count); i++) {
+                model_copies(tree, statement_at(tree, &(tree_node -> entry.block_val), i), num_nodes, by_value, by_pointer);
+            }
+            break;
+        case FORLOOP_NODE:
+            children[0] = tree_node -> entry.forloop_val.expression;
+            children[1] = tree_node -> entry.forloop_val.statements;
+            children[2] = tree_node -> entry.forloop_val.end;
+            break;
+        case GROUPING_NODE:
+            children[0] = tree_node -> entry.grouping_val.expression;
+            break;
+        case IFELSE_NODE:
+            children[0] = tree_node -> entry.ifelse_val.condition;
+            children[1] = tree_node -> entry.ifelse_val.ifbranch;
+            children[2] = tree_node -> entry.ifelse_val.elsebranch;
+            break;
+        case LOGICAL_NODE:
+            children[0] = tree_node -> entry.logical_val.left;
+            children[1] = tree_node -> entry.logical_val.right;
+            break;
+        case UNARY_NODE:
+            children[0] = tree_node -> entry.unary_val.right;
+            break;
+        case WHILELOOP_NODE:
+            children[0] = tree_node -> entry.whileloop_val.expression;
+            children[1] = tree_node -> entry.whileloop_val.statements;
+            children[2] = tree_node -> entry.whileloop_val.end;
+            break;
+        default:
+            break;
+    }
+    for (int i = 0; i < 4; i++) {
+        model_copies(tree, children[i], num_nodes, by_value, by_pointer);
+    }
+}
+
+
+/**
+ * \brief Reports an estimate of the bytes copied per node visited by the tree-walk evaluator, with its measured timing.
+ * \param [in] name The label to print for this source.
+ * \param [in] setup Python source run beforehand (untimed) to create the variables needed.
+ * \param [in] source Python source to measure.
+ */
+void estimate_copies(const char * name, const char * setup, const char * source) {
+    // parse the source to find which nodes the evaluator will visit
+    Lexer lexer(source, strlen(source));
+    syntax_tree tree;
+    Parser parser(&lexer, &tree);
+    if (parser.parse_input()) {
+        printf("benchmark source failed to parse: %s\n", source);
+        free_tree(&tree);
+        return;
+    }
+    long num_nodes = 0;
+    long by_value = 0;
+    long by_pointer = 0;
+    model_copies(&tree, tree.root, &num_nodes, &by_value, &by_pointer);
+    free_tree(&tree);
+    double tree_walk = time_execution(setup, source, false, false);
+    printf("%-24s by value %4ld B/node    by pointer %3ld B/node    (estimated)    tree-walk %8.2f ms\n",
+           name, by_value / num_nodes, by_pointer / num_nodes, tree_walk * 1000);
+}
+
+
+/**
+ * \brief Estimates how much copying the tree-walk evaluator does to visit each node (the timings are measured).
+ */
+void benchmark_copy_estimate() {
+    printf("copy-estimate (bytes passed per syntax tree node, estimated from sizes rather than counted, node is %d B, value is %d B):\n",
+           (int) sizeof(node), (int) sizeof(literal_value));
+    estimate_copies("while counter", "i = 0", "while i < 1000000: i += 1");
+    estimate_copies("while arithmetic", "i = 0; t = 0", "while i < 300000: i += 1; t = (t + i * 3) % 7");
+    estimate_copies("while branching", "i = 0; t = 0", "while i < 300000: i += 1; if i & 1: t += i");
+}
+
+
+/**
+ * \brief Reports the memory taken by the syntax tree of a command, and how long it takes to lex and parse.
+ * \param [in] name The label to print for this source.
+ * \param [in] source Python source to parse.
+ */
+void measure_layout(const char * name, const char * source) {
+    // lex and parse the same source many times, reusing the tree's memory like the interpreter does
+    syntax_tree tree;
+    double start = now();
+    for (int i = 0; i < NUM_PARSE_REPEATS; i++) {
+        clear_tree(&tree);
+        Lexer lexer(source, strlen(source));
+        Parser parser(&lexer, &tree);
+        if (parser.parse_input()) {
+            printf("benchmark source failed to parse: %s\n", source);
+            free_tree(&tree);
+            return;
+        }
+    }
+    double elapsed = now() - start;
+    // the first node is the reserved empty one, so it is not counted (nodes are allocated a page at a time)
+    printf("%-24s %3d nodes %2d statements    arena %5ld B allocated %6ld B reserved    lex+parse %8.1f ns\n",
+           name, tree.num_nodes - 1, tree.num_statements, (long) tree.memory.bytes_allocated, (long) tree.memory.bytes_reserved,
+           elapsed * 1e9 / NUM_PARSE_REPEATS);
+    free_tree(&tree);
+}
+
+
+/**
+ * \brief Measures how compactly syntax trees are stored, and how fast they are built.
+ */
+void benchmark_layout() {
+    printf("layout (node is %d B, literal is %d B, stored in the node, %d nodes per page):\n",
+           (int) sizeof(node), (int) sizeof(literal_value), 1 << NODE_PAGE_SHIFT);
+    measure_layout("expression", "x = (a + b) * c - d // 2 + e % 3");
+    measure_layout("statements", "a = 1; b = 2; c = a + b; d = c * 2; e = 'hi'");
+    measure_layout("loop", "while i < 10: i += 1; t = t + i * 2 - 1");
+    measure_layout("long expression", "1+1+1+1+1+1+1+1+1+1+1+1+1+1+1+1+1+1+1+1+1+1+1+1+1+1+1+1+1+1+1+1");
+}
+
+
+/**
+ * \brief Reports how fast the parser builds the syntax tree of a long arithmetic expression.
+ * \param [in] num_operands The number of operands in the expression.
+ */
+void measure_parser(int num_operands) {
+    // cycle through every arithmetic operator, so that each level of precedence is climbed and left again
+    const char * operators[] = {" + ", " * ", " - ", " // ", " % ", " << ", " | ", " ^ ", " & ", " >> "};
+    int num_operators = sizeof(operators) / sizeof(operators[0]);
+    char * source = (char *) malloc(num_operands * 8 + 2);
+    if (!source) {
+        printf("benchmark input could not be allocated\n");
+        return;
+    }
+    int length = 0;
+    for (int i = 0; i < num_operands; i++) {
+        if (i > 0) {
+            length += sprintf(source + length, "%s", operators[i % num_operators]);
+        }
+        length += sprintf(source + length, "%d", (i % 9) + 1);
+    }
+    length += sprintf(source + length, "\n");
+
+    // lex and parse the same expression many times, reusing the tree's memory like the interpreter does
+    syntax_tree tree;
+    int repeats = NUM_PARSER_OPERANDS / num_operands;
+    double start = now();
+    for (int i = 0; i < repeats; i++) {
+        clear_tree(&tree);
+        Lexer lexer(source, length);
+        Parser parser(&lexer, &tree);
+        if (parser.parse_input()) {
+            printf("benchmark source failed to parse\n");
+            break;
+        }
+    }
+    double elapsed = now() - start;
+    printf("%4d operands    %8.1f ns/operand    %7.1f MB/s\n", num_operands,
+           elapsed * 1e9 / (repeats * (double) num_operands), repeats * (double) length / elapsed / (1024 * 1024));
+    free_tree(&tree);
+    free(source);
+}
+
+
+/**
+ * \brief Measures the throughput of the lexer and parser together on long arithmetic expressions.
+ */
+void benchmark_parser() {
+    printf("parser (lex+parse of arithmetic expressions, %d operands in all at each length):\n", NUM_PARSER_OPERANDS);
+    for (int num_operands = 4; num_operands <= MAX_PARSER_OPERANDS; num_operands *= 4) {
+        measure_parser(num_operands);
+    }
+}
+
+
+/**
+ * \brief Reports how fast the lexer scans a large input made of one line repeated over and over.
+ * \param [in] name The label to print for this input.
+ * \param [in] line The line to repeat, ending in a newline.
+ */
+void measure_lexer(const char * name, const char * line) {
+    // build the input in memory so that only the lexer itself is timed
+    int line_length = strlen(line);
+    int num_lines = LEXER_INPUT_LEN / line_length;
+    int length = num_lines * line_length;
+    char * input = (char *) malloc(length);
+    if (!input) {
+        printf("benchmark input could not be allocated\n");
+        return;
+    }
+    for (int i = 0; i < num_lines; i++) {
+        memcpy(input + i * line_length, line, line_length);
+    }
+
+    // scan every token of the input, with the fastest of a few runs showing the lexer's own speed
+    double best = 0;
+    long num_tokens = 0;
+    for (int i = 0; i < NUM_LEXER_REPEATS; i++) {
+        Lexer lexer(input, length);
+        lexed_token token;
+        num_tokens = 0;
+        double start = now();
+        while (!(lexer.scan_token(&token)) && (token.type != EMPTY)) {
+            num_tokens++;
+        }
+        double elapsed = now() - start;
+        if ((i == 0) || (elapsed < best)) {
+            best = elapsed;
+        }
+    }
+    printf("%-24s %9ld tokens    %8.1f MB/s    %6.1f ns/token\n",
+           name, num_tokens, length / best / (1024 * 1024), best * 1e9 / num_tokens);
+    free(input);
+}
+
+
+/**
+ * \brief Measures the throughput of the lexer on its own, on identifiers, keywords, strings, comments, and whitespace.
+ */
+void benchmark_lexer() {
+    printf("lexer (%d MB of each line repeated, best of %d):\n", LEXER_INPUT_LEN / (1024 * 1024), NUM_LEXER_REPEATS);
+    measure_lexer("identifiers", "total = count + offset * width - height // scale\n");
+    measure_lexer("keywords", "while not done and x is None or y in z: pass\n");
+    measure_lexer("long identifiers", "first_element_index = last_element_index + element_count\n");
+    measure_lexer("strings and comments", "label = 'a short label'    # and a comment to the end of the line\n");
+    measure_lexer("spaced out", "x     =     y                    +                    z\n");
+}
+
+
+/**
+ * \brief Compares running a loop as written with running it after its constant parts are folded, on the virtual machine.
+ * \param [in] name The label to print for this loop.
+ * \param [in] setup Python source run beforehand (untimed) to create the variables needed.
+ * \param [in] source Python source for the loop to time.
+ */
+void compare_folding(const char * name, const char * setup, const char * source) {
+    double unfolded = time_execution(setup, source, true, false);
+    double folded = time_execution(setup, source, true, true);
+    printf("%-24s unfolded %8.2f ms    folded %8.2f ms    speedup %5.2fx\n",
+           name, unfolded * 1000, folded * 1000, unfolded / folded);
+}
+
+
+/**
+ * \brief Times loops whose bodies compute values or take branches that are known before they run, with and without folding them.
+ */
+void benchmark_folding() {
+    printf("folding (execution time only):\n");
+    compare_folding("power and product", "i = 0", "while i < 300000: i += 1; t = 2 ** 10 * 3");
+    compare_folding("string repetition", "i = 0", "while i < 300000: i += 1; s = \"ab\" * 4");
+    compare_folding("partly constant", "i = 0", "while i < 300000: i += 1; t = (i + 60 * 60 * 24) % 7");
+    compare_folding("logical", "i = 0", "while i < 300000: i += 1; t = not True or 1 < 2 < 3");
+    compare_folding("dead branch", "i = 0", "while i < 300000: i += 1; pass; if 0: t = 1");
+}
+
+
+/**
+ * \brief Reports how long it takes to apply a binary operator to the same two operands.
+ * \param [in] name The label to print for this operation.
+ * \param [in] opcode The token representing the operation.
+ * \param [in] left The value of the first operand.
+ * \param [in] right The value of the second operand.
+ */
+void measure_operator(const char * name, lexemes opcode, literal_value left, literal_value right) {
+    literal_value result;
+    int failures = 0;
+    double start = now();
+    for (int i = 0; i < NUM_OPERATOR_CALLS; i++) {
+        failures += apply_binary(opcode, &left, &right, &result);
+        // a result that is a new object is dropped straight away, as the executors do once it is used
+        release(&result);
+    }
+    double elapsed = now() - start;
+    printf("%-24s %6.2f ns/operation%s\n", name, elapsed * 1e9 / NUM_OPERATOR_CALLS, failures ? "    (failed)" : "");
+}
+
+
+/**
+ * \brief Times applying binary operators to operands of various types, as both executors do for every operator run.
+ */
+void benchmark_operators() {
+    literal_value number = make_number(1234);
+    literal_value small = make_number(7);
+    literal_value truth = make_bool(true);
+    literal_value text;
+    if (make_string("abc", 3, &text)) {
+        return;
+    }
+    printf("operators (%d applications each):\n", NUM_OPERATOR_CALLS);
+    measure_operator("int + int", PLUS, number, small);
+    measure_operator("int < int", LESS, number, small);
+    measure_operator("int // int", D_SLASH, number, small);
+    measure_operator("int % int", PERCENT, number, small);
+    measure_operator("int == int", EQUAL, number, small);
+    measure_operator("bool + int", PLUS, truth, small);
+    measure_operator("str + str", PLUS, text, text);
+    measure_operator("str == str", EQUAL, text, text);
+    release(&text);
+}
+
+
+/**
+ * \brief Times loops that do little but copy values between variables and the stack under both executors.
+ */
+void benchmark_values() {
+    printf("values (execution time only, value is %d B, a variable takes %d B):\n",
+           (int) sizeof(literal_value), (int) (sizeof(literal_value) + sizeof(bool)));
+    compare_executors("copy ints", "i = 0; a = 1; b = 2; c = 3", "while i < 300000: i += 1; a = b; b = c; c = a");
+    compare_executors("copy strings", "i = 0; a = 'x'; b = 'yy'; c = 'zzz'", "while i < 300000: i += 1; a = b; b = c; c = a");
+    compare_executors("compare ints", "i = 0; t = 0", "while i < 300000: i += 1; t = i < 5 or i == 7");
+}
+
+
+/**
+ * \brief Times loops over strings far longer than a literal, and loops that build them, under both executors.
+ */
+void benchmark_strings() {
+    printf("strings (execution time only, 1000 characters each unless built):\n");
+    compare_executors("copy long strings", "i = 0; a = 'ab' * 500; b = 'cd' * 500", "while i < 300000: i += 1; c = a; a = b; b = c");
+    compare_executors("compare long strings", "i = 0; a = 'ab' * 500; b = 'ab' * 500; t = 0", "while i < 100000: i += 1; t = a == b");
+    compare_executors("concatenate long strings", "i = 0; a = 'ab' * 500; t = ''", "while i < 100000: i += 1; t = a + a");
+    compare_executors("for over long string", "s = 'ab' * 500; n = 0", "while n < 300: n += 1; for c in s: t = c");
+    compare_executors("append in loop", "i = 0; s = ''", "while i < 100000: i += 1; s = s + 'x'");
+    compare_executors("append characters", "s = ''; t = 'abcdefghijklmnopqrstuvwxyz'; n = 0",
+                      "while n < 2000: n += 1; for c in t: s += c");
+    compare_executors("large repetition", "i = 0", "while i < 200: i += 1; s = 'ab' * 100000");
+    compare_executors("compare equal literals", "i = 0; a = 'the same words'; b = 'the same words'; t = 0",
+                      "while i < 300000: i += 1; t = a == b");
+    compare_executors("match characters", "s = 'abracadabra' * 100; n = 0; k = 0", "while n < 200: n += 1; for c in s: if c == 'a': k += 1");
+}
+
+
+/**
+ * \brief Times arithmetic on ints that stay in the word, and on numbers that outgrow it, under both executors.
+ */
+void benchmark_numbers() {
+    printf("numbers (execution time only):\n");
+    compare_executors("small arithmetic", "i = 0; t = 0", "while i < 300000: i += 1; t = (i * 3 + 7) // 2 - (i << 2)");
+    compare_executors("small power", "i = 0; t = 0", "while i < 300000: i += 1; t = 3 ** 19");
+    compare_executors("just past an int", "i = 0; a = 2147483647; t = 0", "while i < 300000: i += 1; t = a + i");
+    compare_executors("fibonacci to 20000", "i = 0; a = 0; b = 1", "while i < 20000: i += 1; c = a + b; a = b; b = c");
+    compare_executors("factorial of 3000", "i = 0; f = 1", "while i < 3000: i += 1; f = f * i");
+    compare_executors("divide big numbers", "i = 0; a = 7 ** 300; b = 3 ** 100; t = 0", "while i < 30000: i += 1; t = a // b % b");
+    compare_executors("shift big numbers", "i = 0; a = 1 << 1000; t = 0", "while i < 30000: i += 1; t = (a << 37 | a) >> 500");
+}
+
+
+/**
+ * \brief Reports how long it takes to run the same few commands over and over, with a cache of a given size.
+ * \param [in] size The number of compiled commands the cache may hold (0 turns it off).
+ */
+void measure_cache(int size) {
+    const char * commands[] = {"x = 1\n", "y = x * 2 + 3\n", "x + y > 4 and not y == 5\n",
+                               "if x < y: z = \"small\"\n", "x = x + 1\n", "for c in \"abc\": w = c\n"};
+    int num_commands = sizeof(commands) / sizeof(commands[0]);
+    environment env;
+    syntax_tree tree;
+    command_cache cache;
+    set_cache_size(&cache, size);
+    Interpreter interpreter(&env, &tree, &cache);
+    output_text output;
+    double start = now();
+    for (int i = 0; i < NUM_CACHE_ROUNDS; i++) {
+        for (int j = 0; j < num_commands; j++) {
+            interpreter.interpret_command(commands[j], strlen(commands[j]), &output);
+        }
+    }
+    double elapsed = now() - start;
+    printf("cache size %-4d %9.1f ns/command    %8ld hits    %8ld misses\n",
+           size, elapsed * 1e9 / (NUM_CACHE_ROUNDS * num_commands), cache.hits, cache.misses);
+    free_environment(&env);
+    free_tree(&tree);
+    free_cache(&cache);
+    free_output(&output);
+}
+
+
+/**
+ * \brief Measures how much the command cache saves when the same commands are sent many times.
+ */
+void benchmark_cache() {
+    printf("cache (6 commands sent %d times each):\n", NUM_CACHE_ROUNDS);
+    measure_cache(0);
+    measure_cache(4);
+    measure_cache(COMMAND_CACHE_SIZE);
+}
+
+
+// the time at which the script benchmark's script ran its first statement (0 until it does)
+static double first_statement_time = 0;
+
+
+/**
+ * \brief Notes when the first statement of a script has run, standing in for printing its output.
+ * \param [in] output Pointer to where the text to be printed is stored (which is ignored).
+ * \return 0, so that the script keeps running.
+ */
+int note_statement([[maybe_unused]] output_text * output) {
+    if (!first_statement_time) {
+        first_statement_time = now();
+    }
+    return 0;
+}
+
+
+/**
+ * \brief Reports how long a script takes to run its first statement and all of them, the same way "main file.py" runs it.
+ * \param [in] megabytes The size of the script to generate.
+ */
+void measure_script(int megabytes) {
+    // generate a script of many short statements
+    char path[] = "/tmp/benchmark_XXXXXX";
+    int file = mkstemp(path);
+    FILE * script = (file < 0) ? NULL : fdopen(file, "w");
+    if (!script) {
+        printf("benchmark script could not be created\n");
+        return;
+    }
+    long length = megabytes * 1024L * 1024L;
+    fputs("x = 0\n", script);
+    for (long written = 6; written < length; written += strlen(SCRIPT_LINE)) {
+        fputs(SCRIPT_LINE, script);
+    }
+    fclose(script);
+    environment env;
+    syntax_tree tree;
+    command_cache cache;
+    Interpreter interpreter(&env, &tree, &cache);
+
+    // map the script, then lex, parse, optimize, and resolve all of it before running each statement in turn
+    first_statement_time = 0;
+    double start = now();
+    source_file source;
+    if (map_source(path, &source)) {
+        printf("benchmark script could not be mapped\n");
+        remove(path);
+        return;
+    }
+    if (interpreter.interpret_script(source.text, source.length, note_statement)) {
+        printf("benchmark script failed to run\n");
+    }
+    double finish = now();
+    unmap_source(&source);
+
+    // the whole script stays in the syntax tree until it finishes
+    double tree_size = tree.memory.bytes_allocated / (1024.0 * 1024.0);
+    printf("%4d MB script      first statement %8.1f ms    all statements %8.1f ms    tree %6.1f MB\n",
+           megabytes, (first_statement_time - start) * 1e3, (finish - start) * 1e3, tree_size);
+    free_environment(&env);
+    free_tree(&tree);
+    free_cache(&cache);
+    remove(path);
+}
+
+
+/**
+ * \brief Measures the latency from starting a script to running its first statement and its last, as scripts get larger.
+ */
+void benchmark_script() {
+    printf("script (startup to first and last statement, script is \"x = 0\" then \"%.*s\" repeated):\n",
+           (int) strlen(SCRIPT_LINE) - 1, SCRIPT_LINE);
+    measure_script(1);
+    measure_script(4);
+    measure_script(16);
+}
+
+
+/**
+ * \brief Runs the requested benchmarks (or all of them).
+ * \param [in] argc The number of command-line arguments.
+ * \param [in] argv The names of the benchmarks to run.
+ * \return 0 on success; a non-zero integer on failure.
+ */
+int main(int argc, char ** argv) {
+    // each benchmark is selected by its name on the command line
+    const char * names[] = {"loops", "control", "variables", "environment", "scopes", "copy-estimate", "layout", "lexer", "parser", "folding", "operators", "values", "strings", "numbers", "cache", "script"};
+    void (*benchmarks[])() = {benchmark_loops, benchmark_control, benchmark_variables, benchmark_environment, benchmark_scopes, benchmark_copy_estimate,
+                              benchmark_layout, benchmark_lexer, benchmark_parser, benchmark_folding, benchmark_operators, benchmark_values, benchmark_strings, benchmark_numbers, benchmark_cache, benchmark_script};
+    int num_benchmarks = sizeof(names) / sizeof(names[0]);
+    for (int i = 0; i < num_benchmarks; i++) {
+        bool selected = (argc < 2);
+        for (int j = 1; j < argc; j++) {
+            selected = selected || (strcmp(argv[j], names[i]) == 0);
+        }
+        if (selected) {
+            benchmarks[i]();
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,61 @@
+/*********************************************************************************
+* Description: An arena allocator (hands out memory that is all released at once)
+* Author(s): Isaac Joffe
+* Copyright: University of Alberta, 2024
+* License: CC-BY-4.0
+*********************************************************************************/
+
+
+#ifndef ARENA_H
+#define ARENA_H
+
+
+#include <cstddef>
+
+
+// the number of bytes in the first chunk of an arena (later chunks double in size)
+#ifndef MIN_CHUNK_SIZE
+#define MIN_CHUNK_SIZE 4096
+#endif
+
+// every allocation starts on a multiple of this many bytes
+#define ARENA_ALIGNMENT 8
+
+
+/**
+ * \brief One block of memory in an arena, which is handed out piece by piece.
+ */
+struct arena_chunk {
+    // the chunk made after this one (NULL if this is the last)
+    arena_chunk * next;
+    // the number of bytes of memory in this chunk, which immediately follows this header
+    size_t size;
+    // the number of those bytes that have been handed out
+    size_t used;
+};
+
+
+/**
+ * \brief The internal representation of an arena, a list of chunks that are reused once the arena is reset.
+ */
+struct arena {
+    // every chunk made so far, kept even when the arena is reset
+    arena_chunk * first = NULL;
+    // the chunk that memory is currently handed out from
+    arena_chunk * current = NULL;
+    // the number of bytes handed out since the arena was last reset
+    size_t bytes_allocated = 0;
+    // the number of bytes in all chunks together
+    size_t bytes_reserved = 0;
+};
+
+
+// hands out memory that stays at the same address until the arena is reset
+void * arena_allocate(arena * memory, size_t size);
+// makes all the memory handed out available again, without releasing it
+void reset_arena(arena * memory);
+// releases all the memory used by an arena
+void free_arena(arena * memory);
+
+
+#endif
@@ -0,0 +1,63 @@
+/*********************************************************************************
+* Description: Integers too big to fit in a machine word, held on the heap
+* Author(s): Isaac Joffe
+* Copyright: University of Alberta, 2024
+* License: CC-BY-4.0
+*********************************************************************************/
+
+
+#ifndef BIGINT_H
+#define BIGINT_H
+
+
+#include <cstdint>
+#include "lexer.h"
+#include "value.h"
+
+
+// the most limbs a number may have (a bigger one is treated as memory running out)
+#ifndef MAX_NUMBER_LIMBS
+#define MAX_NUMBER_LIMBS (1 << 20)
+#endif
+
+
+/**
+ * \brief The internal representation of an integer on the heap, which is always too big to fit in an int.
+ */
+struct number_object {
+    heap_object header;
+    // whether the number is below zero
+    bool negative;
+    // the number of limbs in the size of the number (the most significant one is never 0)
+    int count;
+    // the size of the number, 32 bits to a limb, the least significant limb first
+    uint32_t limbs[];
+};
+
+
+// to create the value of a number literal from its digits
+int parse_number(const char * text, int length, literal_value * value);
+// to apply a binary operator to numerical operands that do not fit in an int, or whose result does not
+int big_binary(lexemes opcode, const literal_value * left, const literal_value * right, literal_value * result);
+// to apply a unary operator to a numerical operand that does not fit in an int, or whose result does not
+int big_unary(lexemes opcode, const literal_value * right, literal_value * result);
+// to compare two numerical values of any size
+int compare_numbers(const literal_value * left, const literal_value * right);
+// to write out the digits of a number of any size
+char * number_text(const literal_value * value);
+
+
+/**
+ * \brief Determines whether the number held by a value is below zero.
+ * \param [in] value Pointer to a value holding a number.
+ * \return Whether the number is negative.
+ */
+inline bool is_negative(const literal_value * value) {
+    if (is_object(value)) {
+        return ((const number_object *) object_of(value)) -> negative;
+    }
+    return (number_of(value) < 0);
+}
+
+
+#endif
@@ -0,0 +1,79 @@
+/*********************************************************************************
+* Description: A cache of recently compiled commands (so repeated commands skip lexing, parsing, and compiling)
+* Author(s): Isaac Joffe
+* Copyright: University of Alberta, 2024
+* License: CC-BY-4.0
+*********************************************************************************/
+
+
+#ifndef CACHE_H
+#define CACHE_H
+
+
+#include "chunk.h"
+#include "tree.h"
+
+
+// the number of compiled commands kept by default before the least recently used is forgotten (0 turns caching off)
+#ifndef COMMAND_CACHE_SIZE
+#define COMMAND_CACHE_SIZE 64
+#endif
+
+// marks the end of a list of cached commands
+#define NO_COMMAND -1
+
+
+/**
+ * \brief The compiled form of a single command, kept along with the text it was compiled from.
+ */
+struct cached_command {
+    // the full hash of the text, to skip most text comparisons
+    unsigned int hash;
+    // a copy of the text itself, so that a match is certain
+    char * text;
+    int length;
+    // just the parts of the bytecode that were used, so that a small command takes little room
+    unsigned char * code;
+    int code_count;
+    literal_value * constants;
+    int constant_count;
+    // the next command whose hash falls in the same bucket
+    int next_in_bucket;
+    // the commands used just before and just after this one
+    int older;
+    int newer;
+};
+
+
+/**
+ * \brief The internal representation of a cache of compiled commands, forgetting the least recently used when full.
+ */
+struct command_cache {
+    // every command stored, in no particular order
+    cached_command * entries = NULL;
+    // the first command of each bucket, found by the hash of its text (the number of buckets is a power of 2)
+    int * buckets = NULL;
+    int num_buckets = 0;
+    // the number of commands stored, and the most that may be
+    int count = 0;
+    int capacity = COMMAND_CACHE_SIZE;
+    // the ends of the list of commands in order of use
+    int newest = NO_COMMAND;
+    int oldest = NO_COMMAND;
+    // the number of times a command was found in the cache, or had to be compiled
+    long hits = 0;
+    long misses = 0;
+};
+
+
+// fetches the compiled form of a command, if it is in the cache
+int cache_lookup(command_cache * cache, const char * text, int length, chunk * output);
+// stores the compiled form of a command, forgetting the least recently used one if full
+int cache_insert(command_cache * cache, const char * text, int length, const chunk * code);
+// changes the number of commands the cache may hold, forgetting every one stored
+int set_cache_size(command_cache * cache, int capacity);
+// releases the memory used by a cache
+void free_cache(command_cache * cache);
+
+
+#endif
@@ -0,0 +1,86 @@
+/*********************************************************************************
+* Description: Defines the bytecode format produced by the compiler
+* Author(s): Isaac Joffe
+* Copyright: University of Alberta, 2024
+* License: CC-BY-4.0
+*********************************************************************************/
+
+
+#ifndef CHUNK_H
+#define CHUNK_H
+
+
+#include "tree.h"
+
+
+// the number of bytes of bytecode there is room for at first (doubling whenever it runs out)
+#ifndef MIN_CODE_LEN
+#define MIN_CODE_LEN 256
+#endif
+
+// the number of constants there is room for at first (doubling whenever it runs out)
+#ifndef MIN_NUM_CONSTANTS
+#define MIN_NUM_CONSTANTS 16
+#endif
+
+
+/**
+ * \brief The list of all possible instructions for the virtual machine.
+ */
+enum opcodes {
+    // pushing values onto the stack (a constant past the first 256 takes a three-byte index)
+    OP_CONSTANT, OP_CONSTANT_LONG, OP_NONE, OP_TRUE, OP_FALSE,
+    // discarding values from the stack
+    OP_POP, OP_PRINT,
+    // accessing variables (by the scope depth and slot given to them by the resolver)
+    OP_GET_VARIABLE, OP_SET_VARIABLE,
+    // applying operators
+    OP_BINARY, OP_UNARY,
+    // moving around the bytecode
+    OP_JUMP, OP_JUMP_IF_FALSE, OP_JUMP_IF_TRUE, OP_POP_JUMP_IF_FALSE, OP_LOOP,
+    // iterating over values
+    OP_GET_ITER, OP_FOR_ITER,
+    // ending execution
+    OP_RETURN,
+};
+
+
+// for ease of printing
+const char * const opcode_names[] = {
+    "OP_CONSTANT", "OP_CONSTANT_LONG", "OP_NONE", "OP_TRUE", "OP_FALSE",
+    "OP_POP", "OP_PRINT",
+    "OP_GET_VARIABLE", "OP_SET_VARIABLE",
+    "OP_BINARY", "OP_UNARY",
+    "OP_JUMP", "OP_JUMP_IF_FALSE", "OP_JUMP_IF_TRUE", "OP_POP_JUMP_IF_FALSE", "OP_LOOP",
+    "OP_GET_ITER", "OP_FOR_ITER",
+    "OP_RETURN",
+};
+
+
+/**
+ * \brief A sequence of bytecode instructions along with the data they refer to.
+ */
+struct chunk {
+    // the instructions and their operands, in execution order
+    unsigned char * code = NULL;
+    // the literal values and names that instructions refer to by index (whose references belong to the syntax tree or the cache)
+    literal_value * constants = NULL;
+    // the number of non-null values of each type produced
+    int code_count = 0;
+    int constant_count = 0;
+    // the number of each there is room for (0 for a chunk whose memory belongs to the cache)
+    int code_capacity = 0;
+    int constant_capacity = 0;
+};
+
+
+// to add to the end of a chunk, making more room as needed
+int write_code(chunk * code, unsigned char byte);
+int write_constant(chunk * code, literal_value value);
+// to release the memory used by a chunk, leaving it empty
+void free_chunk(chunk * code);
+// to print a readable listing of the bytecode for debugging
+void print_chunk(chunk * code);
+
+
+#endif
@@ -0,0 +1,81 @@
+/*********************************************************************************
+* Description: The compiler (lowers a syntax tree into bytecode for the virtual machine)
+* Author(s): Isaac Joffe
+* Copyright: University of Alberta, 2024
+* License: CC-BY-4.0
+*********************************************************************************/
+
+
+#ifndef COMPILER_H
+#define COMPILER_H
+
+
+#include "chunk.h"
+#include "tree.h"
+
+
+// the number of break statements there is room for at first (doubling whenever it runs out)
+#ifndef MIN_NUM_BREAKS
+#define MIN_NUM_BREAKS 16
+#endif
+
+// the maximum number of values on the virtual machine's stack at once
+#ifndef MAX_STACK_SIZE
+#define MAX_STACK_SIZE 256
+#endif
+
+
+/**
+ * \brief The compiler of the interpreter; it takes a syntax tree as input and a bytecode chunk as output.
+ */
+class Compiler {
+    private:
+        // input and output information
+        syntax_tree * tree;
+        chunk * bytecode;
+        // for writing instructions and their operands
+        void emit_byte(unsigned char byte);
+        void emit_bytes(unsigned char first, unsigned char second);
+        void emit_variable(opcodes instruction, int depth, int slot);
+        void emit_long(int operand);
+        int emit_jump(opcodes instruction);
+        void patch_jump(int offset);
+        void emit_loop(int start);
+        int make_constant(literal_value value);
+        // for tracking loops so that break and continue know where to go (-1 outside of any loop)
+        int loop_start = -1;
+        int * breaks = NULL;
+        int num_breaks = 0;
+        int break_capacity = 0;
+        void push_break(int offset);
+        void patch_breaks(int first_break);
+        // for making sure the stack can never overflow at run time
+        int expression_depth = 0;
+        int iterator_depth = 0;
+        // for compiling each type of syntax tree node
+        void compile_statement(int index);
+        void compile_expression(int index);
+        void compile_assign(const assign_value * expr);
+        void compile_binary(const binary_value * expr);
+        void compile_block(const block_value * expr);
+        void compile_forloop(const forloop_value * expr);
+        void compile_ifelse(const ifelse_value * expr);
+        void compile_literal(const literal_value * expr);
+        void compile_logical(const logical_value * expr);
+        void compile_special(const special_value * expr);
+        void compile_unary(const unary_value * expr);
+        void compile_variable(const variable_value * expr);
+        void compile_whileloop(const whileloop_value * expr);
+        // for error handling
+        bool error_occurred = false;
+        bool has_error();
+
+    public:
+        // basic constructor for the class
+        Compiler(syntax_tree * input, chunk * output);
+        // converts the input syntax tree into bytecode
+        int compile_input();
+};
+
+
+#endif
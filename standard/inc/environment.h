@@ -10,17 +10,13 @@
 #define ENVIRONMENT_H
 
 
+#include "symbols.h"
 #include "tree.h"
 
 
-// the maximum number of variables that may exist in a given scope
-#ifndef MAX_NUM_VAR
-#define MAX_NUM_VAR 64
-#endif
-
-// the maximum number of characters in any identifier
-#ifndef MAX_IDENTIFIER_LEN
-#define MAX_IDENTIFIER_LEN 32
+// the number of variables an environment has room for once the first one is created
+#ifndef MIN_NUM_VAR
+#define MIN_NUM_VAR 8
 #endif
 
 
@@ -28,22 +24,31 @@
  * \brief The internal representation of the set of variables in existence.
  */
 struct environment {
-    // stores the names of each variable
-    char names[MAX_NUM_VAR][MAX_IDENTIFIER_LEN];
-    // stores the actual corresponding values of these variables
-    literal_value values[MAX_NUM_VAR];
+    // the scope that this one is nested inside (NULL for the global scope)
+    environment * enclosing = NULL;
+    // maps the symbol of each variable to its slot (only needed to resolve names, since execution uses slots)
+    int * slots = NULL;
+    // tracks the number of symbols there is currently room for in that map
+    int num_symbols = 0;
+    // stores the actual corresponding values of these variables, growing as needed
+    literal_value * values = NULL;
+    // tracks whether each variable has been assigned a value yet
+    bool * defined = NULL;
     // tracks the number of variables being used (where to insert a new one)
     int num_used = 0;
-    // TODO: store pointer to the parent scope for nested variable scopes
+    // tracks the number of variables there is currently room for
+    int capacity = 0;
 };
 
 
 // returns the index where the variable being searched for is stored
-int find_variable(environment * env, char name[]);
-// assigns a value to a variable (either existing or new)
-void write_variable(environment * env, char name[], literal_value value);
-// fetches the associated value from a variable
-int read_variable(environment * env, char name[], literal_value * value);
+int find_variable(environment * env, int symbol);
+// gives a variable (either existing or new) the index where its value is stored
+int declare_variable(environment * env, int symbol);
+// fetches the associated value from a variable by its name
+int read_variable(environment * env, const char name[], literal_value * value);
+// releases the memory used by an environment
+void free_environment(environment * env);
 
 
 #endif
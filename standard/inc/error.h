@@ -14,13 +14,13 @@
  * \brief The list of all possible error classes in Python.
  */
 enum error_types {
-    ASSERTION, INDEX, NAME, SYNTAX, INDENTATION, TYPE, RUNTIME, ZERODIVISION
+    ASSERTION, INDEX, NAME, SYNTAX, INDENTATION, TYPE, RUNTIME, MEMORY, OVERFLOW, VALUE, ZERODIVISION
 };
 
 
 // for ease of printing
 const char * const error_names[] = {
-    "AssertionError", "IndexError", "NameError", "SyntaxError", "IndentationError", "TypeError", "RuntimeError", "ZeroDivisionError"
+    "AssertionError", "IndexError", "NameError", "SyntaxError", "IndentationError", "TypeError", "RuntimeError", "MemoryError", "OverflowError", "ValueError", "ZeroDivisionError"
 };
 
 
@@ -14,12 +14,22 @@
 #include "tree.h"
 
 
-// the maximum number of characters in a line of output
-#ifndef MAX_OUTPUT_LEN
-#define MAX_OUTPUT_LEN 256
+// the deepest that nodes may be nested inside one another and still be evaluated (deeper ones would overflow the stack)
+#ifndef MAX_EVALUATION_DEPTH
+#define MAX_EVALUATION_DEPTH 1000
 #endif
 
 
+/**
+ * \brief The ways in which a statement can finish executing.
+ */
+enum completion_types {
+    NORMAL_COMPLETION,
+    BREAK_COMPLETION,
+    CONTINUE_COMPLETION,
+};
+
+
 /**
  * \brief The evaluator of the interpreter; it takes a syntax tree as input and executes it.
  */
@@ -27,38 +37,37 @@ class Evaluator {
     private:
         // for storing variables
         environment * env;
-        // for determining if data types are compatible
-        bool is_numerical(literal_types type);
-        int numerify(literal_value value);
-        bool is_boolean(literal_types type);
-        bool boolify(literal_value value);
-        bool is_iterable(literal_types type);
-        bool equals(literal_value left, literal_value right);
+        environment * scope_at(int depth);
+        // the syntax tree being evaluated, whose nodes refer to each other by index
+        const syntax_tree * tree;
         // for evaluating each type of syntax tree node
-        literal_value evaluate(node tree_node);
-        literal_value evaluate_assign(assign_value expr);
-        literal_value evaluate_binary(binary_value expr);
-        literal_value evaluate_block(block_value expr);
-        literal_value evaluate_forloop(forloop_value expr);
-        literal_value evaluate_grouping(grouping_value expr);
-        literal_value evaluate_ifelse(ifelse_value expr);
-        literal_value evaluate_literal(literal_value expr);
-        literal_value evaluate_logical(logical_value expr);
-        literal_value evaluate_special(special_value expr);
-        literal_value evaluate_unary(unary_value expr);
-        literal_value evaluate_variable(variable_value expr);
-        literal_value evaluate_whileloop(whileloop_value expr);
+        int evaluation_depth = 0;
+        void evaluate(const node * tree_node, literal_value * result);
+        void evaluate_assign(const assign_value * expr, literal_value * result);
+        void evaluate_binary(const binary_value * expr, literal_value * result);
+        void evaluate_block(const block_value * expr, literal_value * result);
+        void evaluate_forloop(const forloop_value * expr, literal_value * result);
+        void evaluate_grouping(const grouping_value * expr, literal_value * result);
+        void evaluate_ifelse(const ifelse_value * expr, literal_value * result);
+        void evaluate_literal(const literal_value * expr, literal_value * result);
+        void evaluate_logical(const logical_value * expr, literal_value * result);
+        void evaluate_special(const special_value * expr, literal_value * result);
+        void evaluate_unary(const unary_value * expr, literal_value * result);
+        void evaluate_variable(const variable_value * expr, literal_value * result);
+        void evaluate_whileloop(const whileloop_value * expr, literal_value * result);
+        // for signalling break and continue statements to the enclosing loop
+        completion_types completion = NORMAL_COMPLETION;
         // for error handling
         bool error_occurred = false;
         bool has_error();
         // for storing outputs
-        char * output_str;
+        output_text * printed;
 
     public:
         // constructor to svae pre-created environment
         Evaluator(environment * env);
         // converts a tree (or subtree, or node) into a single value
-        int evaluate_input(node * input, char ** output);
+        int evaluate_input(const syntax_tree * input, output_text * output);
 };
 
 
@@ -10,6 +10,24 @@
 #define INTERPRETER_H
 
 
+#include "cache.h"
+#include "chunk.h"
+#include "environment.h"
+#include "evaluator.h"
+#include "tree.h"
+#include "vm.h"
+
+
+// whether to execute commands with the bytecode virtual machine (1) or the tree-walk evaluator (0)
+#ifndef USE_BYTECODE_VM
+#define USE_BYTECODE_VM 1
+#endif
+
+// whether to replace the parts of each command known before it runs with their values (1) or not (0)
+#ifndef USE_OPTIMIZER
+#define USE_OPTIMIZER 1
+#endif
+
 // the maximum number of statements allowed on one line
 #ifndef MAX_NUM_STMTS
 #define MAX_NUM_STMTS 32
@@ -21,14 +39,27 @@
  */
 class Interpreter {
     private:
+        // the variables must persist between runs, so they are stored in one shared environment
+        environment * env;
+        // each command's syntax tree reuses the memory of the one before it
+        syntax_tree * tree;
+        // commands typed again are run from the bytecode they were compiled to the first time
+        command_cache * cache;
         // The evaluator must persist between runs to save variables and environment
         Evaluator evaluator;
+        // the virtual machine shares that same environment
+        VirtualMachine machine;
+        // runs the resolved syntax tree from its root
+        int execute_tree(output_text * output);
+        int compile_tree(chunk * bytecode);
 
     public:
         // basic constructor (needs dummy parameter to be callable) that calls evaluator constructor
-        Interpreter(environment * env): evaluator(env) {};
+        Interpreter(environment * env, syntax_tree * tree, command_cache * cache): env(env), tree(tree), cache(cache), evaluator(env), machine(env) {};
         // executes a single command from start to finish
-        int interpret_command(char ** input_ptr, char ** output_ptr);
+        int interpret_command(const char * input, int length, output_text * output);
+        // executes a whole script, which is parsed all at once, one top-level statement at a time
+        int interpret_script(const char * input, int length, int (*show_output)(output_text * output));
 };
 
 
@@ -10,35 +10,22 @@
 #define LEXER_H
 
 
-// the maximum number of characters in a line of input
-#ifndef MAX_INPUT_LEN
-#define MAX_INPUT_LEN 64
-#endif
+#include <cstddef>
 
-// the maximum number of tokens in a line of input
-#ifndef MAX_INPUT_TOKENS
-#define MAX_INPUT_TOKENS 64
-#endif
 
-// the maximum number of literals in a line of input
-#ifndef MAX_LITS
-#define MAX_LITS 16
-#endif
+// the number of characters in the longest keyword
+#define MAX_KEYWORD_LEN 8
 
-// the maximum number of characters in a literal
-#ifndef MAX_LIT_LEN
-#define MAX_LIT_LEN 32
-#endif
+// the number of slots in the table that keywords are hashed into (a power of two)
+#define KEYWORD_TABLE_SIZE 64
 
-// the maximum number of identifiers in a line of input
-#ifndef MAX_IDENTIFIERS
-#define MAX_IDENTIFIERS 16
+// the maximum number of blocks that may be indented inside one another
+#ifndef MAX_INDENT_DEPTH
+#define MAX_INDENT_DEPTH 100
 #endif
 
-// the maximum number of characters in any identifier
-#ifndef MAX_IDENTIFIER_LEN
-#define MAX_IDENTIFIER_LEN 32
-#endif
+// a tab indents a line to the next multiple of this many columns
+#define TAB_SIZE 8
 
 
 /**
@@ -71,7 +58,7 @@ enum lexemes {
     IMPORT, FROM, WITH, AS,                                 // linking
     GLOBAL, NONLOCAL, ASYNC, AWAIT, ASSERT, DEL,            // other
     // indentation
-    NEWLINE,
+    NEWLINE, INDENT, DEDENT,
 };
 
 
@@ -92,7 +79,7 @@ const char * const token_names[] = {
     "TRY", "FINALLY", "EXCEPT", "RAISE",
     "IMPORT", "FROM", "WITH", "AS",
     "GLOBAL", "NONLOCAL", "ASYNC", "AWAIT", "ASSERT", "DEL",
-    "NEWLINE",
+    "NEWLINE", "INDENT", "DEDENT",
 };
 // for ease of printing
 const char * const token_symbols[] = {
@@ -111,65 +98,90 @@ const char * const token_symbols[] = {
     "try", "finally", "except", "raise",
     "import", "from", "with", "as",
     "global", "nonlocal", "async", "await", "assert", "del",
-    "newline",
+    "newline", "indent", "dedent",
+};
+
+
+/**
+ * \brief Refers to the characters of a token where they appear in the input, rather than holding a copy of them.
+ */
+struct token_text {
+    // the index of the first character within the input
+    int start;
+    // the number of characters
+    int length;
 };
 
 
 /**
- * \brief Holds information about a command.
+ * \brief Holds a single token, along with the value it carries (if any).
  */
-struct lexed_command {
-    // the list of all tokens and other items in the order they appear in the input
-    lexemes tokens[MAX_INPUT_TOKENS];
-    char str_lits[MAX_LITS][MAX_LIT_LEN];
-    int num_lits[MAX_LITS];
-    char identifiers[MAX_IDENTIFIERS][MAX_IDENTIFIER_LEN];
-    // the number of non-null values of each type produced
-    int token_count = 0;
-    int str_lit_count = 0;
-    int num_lit_count = 0;
-    int identifier_count = 0;
+struct lexed_token {
+    // the kind of token
+    lexemes type = EMPTY;
+    // the value of a literal or identifier; which member is used depends on the type
+    union {
+        token_text text;
+        int symbol;
+    } value;
 };
 
 
 /**
- * \brief The lexer of the interpreter; it takes a string as input and a list of tokens as output.
+ * \brief The lexer of the interpreter; it takes a string as input and hands out its tokens one at a time.
  */
 class Lexer {
     private:
-        // stores the input line to be lexed
-        char line[MAX_INPUT_LEN] = "";
-        // information extracted about the input
-        lexed_command * command_info;
+        // the input being lexed, which is read in place rather than copied
+        const char * line;
+        // where the token currently being scanned is written to
+        lexed_token * scanned = NULL;
+        // a token read ahead to check for two-word operators, not yet handed out
+        lexed_token lookahead;
+        bool has_lookahead = false;
         // the current character index being read
         int current = 0;
         // the number of non-null input characters to decode
         int length = 0;
+        // the number of columns each open block is indented by, from the outermost in
+        int indents[MAX_INDENT_DEPTH];
+        int indent_depth = 0;
+        // the number of blocks that have ended but are yet to be handed out as DEDENT tokens
+        int pending_dedents = 0;
+        // whether the next character starts a new line, whose indentation must be measured
+        bool at_line_start = true;
+        // the number of brackets still open, inside which a line goes on past its newline
+        int bracket_depth = 0;
         // main logic of the lexer; maps charcters to tokens
         void scan_next_token();
-        // adds a value to the end of that value's list
+        void scan_indentation();
+        void scan_raw_token(lexed_token * output);
+        // sets the type or value of the token being scanned
         void add_token(lexemes token);
-        void add_str_lit(char * str_lit);
-        void add_num_lit(int num_lit);
-        void add_identifier(char * identifier);
+        void add_str_lit(int start, int str_length);
+        void add_num_lit(int start, int num_length);
+        void add_identifier(const char * identifier, int identifier_length);
         // checks if the next character in the input matches a certain value
         bool next_matches(char character);
         // parses a literal's value
-        void match_string(char terminator, char ** output_ptr);
-        void match_number(int * output_ptr);
-        void match_identifier(char ** output_ptr);
-        lexemes iskeyword(char ** input_ptr);
+        int match_string(char terminator);
+        int match_number();
+        int match_identifier();
+        lexemes iskeyword(const char * identifier, int identifier_length);
         // checks if there are any more characters to be read
         bool end_reached();
         // for error handling
         bool error_occurred = false;
-        bool has_error();
 
     public:
         // basic constructor for the class
-        Lexer(char ** input, lexed_command * output);
-        // converts the input line into a list of tokens
-        int scan_input();
+        Lexer(const char * input, int input_length);
+        // produces the next token of the input (an EMPTY one once the input is over)
+        int scan_token(lexed_token * output);
+        // tells if the input could not be lexed
+        bool has_error();
+        // finds the characters of a string or number literal token within the input
+        const char * text_of(const lexed_token * token);
 };
 
 
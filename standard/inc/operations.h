@@ -0,0 +1,77 @@
+/*********************************************************************************
+* Description: The semantics of Python's operators, shared by every executor
+* Author(s): Isaac Joffe and David Onchuru
+* Copyright: University of Alberta, 2024
+* License: CC-BY-4.0
+*********************************************************************************/
+
+
+#ifndef OPERATIONS_H
+#define OPERATIONS_H
+
+
+#include "lexer.h"
+#include "tree.h"
+
+
+// for determining if data types are compatible
+bool is_numerical(literal_types type);
+int numerify(const literal_value * value);
+bool is_boolean(literal_types type);
+bool boolify(const literal_value * value);
+bool is_iterable(literal_types type);
+bool equals(const literal_value * left, const literal_value * right);
+// for applying an operator to operands that have already been computed
+int apply_unary(lexemes opcode, const literal_value * right, literal_value * result);
+// for telling ahead of time whether applying an operator would succeed, without reporting anything
+bool can_apply_binary(lexemes opcode, const literal_value * left, const literal_value * right);
+bool can_apply_unary(lexemes opcode, const literal_value * right);
+
+
+// the number of binary operators, plus one row for any token that is not one
+#define NUM_BINARY_ROWS 24
+
+// the number of types a literal value can have
+#define NUM_LITERAL_TYPES 5
+
+
+// applies one binary operator to operands of one pair of types, returning non-zero on failure
+typedef int (*binary_kernel)(const literal_value * left, const literal_value * right, literal_value * result);
+
+
+/**
+ * \brief The internal representation of the table that finds the kernel for any binary operator and pair of operand types.
+ */
+struct binary_kernel_table {
+    // the row of each token (any byte of bytecode can be looked up, and those that are not binary operators get row 0)
+    unsigned char rows[256];
+    // the kernels of each row, by the type of the left operand and then of the right
+    binary_kernel kernels[NUM_BINARY_ROWS][NUM_LITERAL_TYPES][NUM_LITERAL_TYPES];
+    // the kernel of each row for two ints held in the word, which never checks for a number on the heap
+    binary_kernel small_kernels[NUM_BINARY_ROWS];
+};
+
+
+// the table itself, built while the interpreter is compiled
+extern const binary_kernel_table binary_kernels;
+
+
+/**
+ * \brief Applies a binary operator to two already-computed operands (defined here so that every executor can inline it).
+ * \param [in] opcode The token representing the operation to complete.
+ * \param [in] left Pointer to the value of the first operand.
+ * \param [in] right Pointer to the value of the second operand.
+ * \param [inout] result Pointer to where to store the computed value.
+ * \return 0 if the operation succeeded; non-zero value if an error occurred.
+ */
+inline int apply_binary(lexemes opcode, const literal_value * left, const literal_value * right, literal_value * result) {
+    int row = binary_kernels.rows[(unsigned char) opcode];
+    // two ints in the word are told apart by a single bit of each word, without looking up their types
+    if (left -> bits & right -> bits & NUMBER_TAG) {
+        return binary_kernels.small_kernels[row](left, right, result);
+    }
+    return binary_kernels.kernels[row][type_of(left)][type_of(right)](left, right, result);
+}
+
+
+#endif
@@ -0,0 +1,77 @@
+/*********************************************************************************
+* Description: The optimizer (simplifies a syntax tree before it is run)
+* Author(s): Isaac Joffe
+* Copyright: University of Alberta, 2024
+* License: CC-BY-4.0
+*********************************************************************************/
+
+
+#ifndef OPTIMIZER_H
+#define OPTIMIZER_H
+
+
+#include "tree.h"
+
+
+// the largest exponent, left shift, or string repetition folded ahead of time (bigger ones are left to run, in case they never do)
+#ifndef MAX_FOLD_COUNT
+#define MAX_FOLD_COUNT 64
+#endif
+
+// the most characters in a string made by folding a repetition (longer ones are left to be made when they run)
+#ifndef MAX_FOLD_LEN
+#define MAX_FOLD_LEN 4096
+#endif
+
+// the deepest a node may be nested and still be simplified (deeper ones are left to run as they are, rather than risk the stack)
+#ifndef MAX_FOLD_DEPTH
+#define MAX_FOLD_DEPTH 1000
+#endif
+
+// the number of operations in a chain (such as 1 + 2 + 3 + ...) there is room for at first, before growing
+#ifndef MIN_CHAIN_LEN
+#define MIN_CHAIN_LEN 64
+#endif
+
+
+/**
+ * \brief The optimizer of the interpreter; it replaces the parts of a syntax tree that are known before running with their values, and removes the parts that never run.
+ */
+class Optimizer {
+    private:
+        // input and output information
+        syntax_tree * tree;
+        // for simplifying each type of syntax tree node
+        int fold_depth = 0;
+        void fold(int index);
+        void fold_binary(int index);
+        void fold_operation(int index);
+        void fold_block(int index);
+        void fold_forloop(int index);
+        void fold_grouping(int index);
+        void fold_ifelse(int index);
+        void fold_logical(int index);
+        void fold_unary(int index);
+        void fold_whileloop(int index);
+        // for removing statements that do nothing or can never run
+        bool is_empty(int index);
+        bool leaves_block(int index);
+        int trim_block(const block_value * expr, int * kept);
+        // the operations of the chains still being simplified, kept here instead of on the stack
+        int * chain = NULL;
+        int chain_count = 0;
+        int chain_capacity = 0;
+        bool push_chain(int index);
+        // for rewriting a node in place, so that its parent need not change
+        void replace_with_literal(int index, literal_value value);
+        void replace_with_node(int index, int other);
+
+    public:
+        // basic constructor for the class
+        Optimizer(syntax_tree * input);
+        // simplifies the whole input syntax tree
+        int optimize_input();
+};
+
+
+#endif
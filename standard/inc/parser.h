@@ -14,25 +14,29 @@
 #include "tree.h"
 
 
-// the maximum number of characters in a literal
-#ifndef MAX_LIT_LEN
-#define MAX_LIT_LEN 32
+// the number of statements there is room for while parsing blocks, before growing
+#ifndef MIN_NUM_PENDING
+#define MIN_NUM_PENDING 32
 #endif
 
-// the maximum number of nodes in a syntax tree
-#ifndef MAX_NUM_NODES
-#define MAX_NUM_NODES 64
+// the maximum depth of nested expressions, so deeply nested input is refused rather than overflowing the stack
+#ifndef MAX_NESTING_DEPTH
+#define MAX_NESTING_DEPTH 1000
 #endif
 
-// the maximum number of statements allowed on one line
-#ifndef MAX_NUM_STMTS
-#define MAX_NUM_STMTS 32
+// the number of tokens kept on hand while parsing, enough to look back at the two before the current one (a power of two)
+#ifndef LOOKAHEAD_SIZE
+#define LOOKAHEAD_SIZE 4
 #endif
 
-// the maximum number of branches allowed on one if statement
-#ifndef MAX_NUM_BRANCHES
-#define MAX_NUM_BRANCHES 32
-#endif
+
+/**
+ * \brief The precedence levels of operators, from the loosest binding to the tightest.
+ */
+enum precedence {
+    PREC_NONE,
+    PREC_OR, PREC_AND, PREC_NOT, PREC_COMPARISON, PREC_BOR, PREC_BXOR, PREC_BAND, PREC_SHIFT, PREC_SUM, PREC_TERM, PREC_FACTOR, PREC_POWER,
+};
 
 
 /**
@@ -40,63 +44,72 @@
  */
 class Parser {
     private:
-        // input information
-        lexed_command command_info;
-        // the current indices of command information being read
+        // input information, pulled from the lexer one token at a time
+        Lexer * lexer;
+        // the most recently pulled tokens, stored by their position in the input
+        lexed_token lookahead[LOOKAHEAD_SIZE];
+        // the position of the token currently being read, and the number of tokens pulled so far
         int current = 0;
-        int current_str_lit = 0;
-        int current_num_lit = 0;
-        int current_identifier = 0;
+        int num_scanned = 0;
+        bool input_ended = false;
         // output tree information and operations
-        node tree_nodes[MAX_NUM_NODES];
-        int current_node = 0;
-        node ** syntax_trees;
-        node * write_new_node(node * value);
+        syntax_tree * tree;
+        int write_new_node(node * value);
+        literal_value write_new_string(const lexed_token * token);
+        literal_value write_new_number(const lexed_token * token);
+        // the statements of the blocks still being parsed
+        int * pending = NULL;
+        int num_pending = 0;
+        int pending_capacity = 0;
+        void push_pending(int statement);
         // for parsing blocks
-        node * block();
+        int block();
+        int simple_block();
+        int suite();
+        int finish_block(int base);
         // for parsing statements
-        node * statement();
-        node * special();
-        node * forloop();
-        node * whileloop();
-        node * ifelse();
-        node * assign();
-        // for parsing expressions recursively
-        node * expression();
-        node * disjunction();
-        node * conjunction();
-        node * inversion();
-        node * comparison();
-        node * bor();
-        node * bxor();
-        node * band();
-        node * shift();
-        node * sum();
-        node * term();
-        node * factor();
-        node * power();
-        node * primary();
+        int statement();
+        int special();
+        int forloop();
+        int whileloop();
+        int ifelse();
+        int assign();
+        // for parsing expressions by precedence climbing
+        int expression();
+        int parse_precedence(precedence level);
+        int comparison(int left_ptr);
+        int primary();
         // checks the current token and sees if it matches a desired value
         bool current_matches(lexemes token);
         // fetches tokens of interest
         lexemes current_token();
         lexemes previous_token();
+        const lexed_token * token_at(int position);
         // safe way of considering next token
         void advance_current();
+        void pull_token();
+        // checks if a compound statement has already consumed the end of its line
+        bool line_ended();
         // checks if there are any more characters to be read
         bool end_reached();
         // to track syntax errors
         int loop_depth = 0;
         bool not_in_loop();
+        int nesting_depth = 0;
         // for error handling
         bool error_occurred = false;
+        bool all_parsed = false;
+        void syntax_error(const char * message);
+        void indentation_error(const char * message);
         bool has_error();
 
     public:
         // basic constructor for the class
-        Parser(lexed_command input, node ** output);
+        Parser(Lexer * input, syntax_tree * output);
         // converts the input token list into a syntax tree
         int parse_input();
+        // tells if every token of the input made it into the syntax tree
+        bool parsed_all();
 };
 
 
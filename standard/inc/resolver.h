@@ -0,0 +1,46 @@
+/*********************************************************************************
+* Description: The resolver (gives each variable in a syntax tree its scope and storage slot)
+* Author(s): Isaac Joffe
+* Copyright: University of Alberta, 2024
+* License: CC-BY-4.0
+*********************************************************************************/
+
+
+#ifndef RESOLVER_H
+#define RESOLVER_H
+
+
+#include "environment.h"
+#include "tree.h"
+
+
+// the deepest that nodes may be nested inside one another and still be resolved (deeper ones would overflow the stack)
+#ifndef MAX_RESOLVE_DEPTH
+#define MAX_RESOLVE_DEPTH 1000
+#endif
+
+/**
+ * \brief The resolver of the interpreter; it fills in the scope and slot of every variable in a syntax tree.
+ */
+class Resolver {
+    private:
+        // input and output information
+        syntax_tree * tree;
+        environment * env;
+        // for resolving each type of syntax tree node
+        int resolve_depth = 0;
+        void resolve(int index);
+        void resolve_name(int name, bool assigning, int * depth, int * slot);
+        // for error handling
+        bool error_occurred = false;
+        bool has_error();
+
+    public:
+        // basic constructor for the class
+        Resolver(syntax_tree * input, environment * env);
+        // resolves every variable in the input syntax tree
+        int resolve_input();
+};
+
+
+#endif
@@ -0,0 +1,33 @@
+/*********************************************************************************
+* Description: Source files (gives access to the whole text of a script at once)
+* Author(s): Isaac Joffe
+* Copyright: University of Alberta, 2024
+* License: CC-BY-4.0
+*********************************************************************************/
+
+
+#ifndef SOURCE_H
+#define SOURCE_H
+
+
+#include <cstddef>
+
+
+/**
+ * \brief The internal representation of a script, mapped into memory rather than read into a buffer.
+ */
+struct source_file {
+    // the text of the whole script (not null-terminated, and read-only)
+    const char * text = NULL;
+    // the number of characters in the script
+    size_t length = 0;
+};
+
+
+// makes the whole text of a script available, only reading each part from disk once it is used
+int map_source(const char * path, source_file * source);
+// releases the text of a script
+void unmap_source(source_file * source);
+
+
+#endif
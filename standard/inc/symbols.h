@@ -0,0 +1,53 @@
+/*********************************************************************************
+* Description: The symbol table (gives every identifier a unique integer ID)
+* Author(s): Isaac Joffe
+* Copyright: University of Alberta, 2024
+* License: CC-BY-4.0
+*********************************************************************************/
+
+
+#ifndef SYMBOLS_H
+#define SYMBOLS_H
+
+
+#include "table.h"
+
+
+// the number of symbols the symbol table has room for once the first one is interned
+#ifndef MIN_NUM_SYMBOLS
+#define MIN_NUM_SYMBOLS 16
+#endif
+
+// marks an identifier that has no symbol
+#define NO_SYMBOL -1
+
+
+/**
+ * \brief The internal representation of the set of all identifiers ever seen.
+ */
+struct symbol_table {
+    // maps the name of each identifier to its symbol
+    table symbols;
+    // stores the name of each symbol (null-terminated, of any length), indexed by the symbol itself
+    char ** names = NULL;
+    // tracks the number of symbols in use (the next one to hand out)
+    int count = 0;
+    // tracks the number of names there is currently room for
+    int capacity = 0;
+};
+
+
+// gives an identifier its symbol, creating a new one if it has never been seen
+int intern_symbol(const char name[]);
+int intern_symbol(const char * text, int length);
+// finds the symbol of an identifier without creating one
+int find_symbol(const char name[]);
+// fetches the name of a symbol
+const char * symbol_name(int symbol);
+// returns the number of symbols in existence
+int num_symbols();
+// releases the memory used by the symbol table
+void free_symbols();
+
+
+#endif
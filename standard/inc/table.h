@@ -0,0 +1,61 @@
+/*********************************************************************************
+* Description: A hash table mapping names to integers (used to intern identifiers)
+* Author(s): Isaac Joffe
+* Copyright: University of Alberta, 2024
+* License: CC-BY-4.0
+*********************************************************************************/
+
+
+#ifndef TABLE_H
+#define TABLE_H
+
+
+// the number of entries a table starts with once something is stored in it (must be a power of 2)
+#ifndef TABLE_MIN_CAPACITY
+#define TABLE_MIN_CAPACITY 8
+#endif
+
+// the fraction of entries (out of 4) allowed to be used before the table grows
+#ifndef TABLE_MAX_LOAD
+#define TABLE_MAX_LOAD 3
+#endif
+
+
+/**
+ * \brief A single name and its value stored in a hash table.
+ */
+struct table_entry {
+    // the full hash of the name, to skip most name comparisons and avoid rehashing when growing
+    unsigned int hash;
+    // the integer associated with the name (negative if this entry is empty)
+    int value;
+    // the name itself, which belongs to whoever stored it, and its length
+    const char * key;
+    int length;
+};
+
+
+/**
+ * \brief The internal representation of a hash table, using open addressing with linear probing.
+ */
+struct table {
+    // the entries of the table, kept in one contiguous block
+    table_entry * entries = NULL;
+    // the number of entries in use
+    int count = 0;
+    // the total number of entries, in use or not (always a power of 2)
+    int capacity = 0;
+};
+
+
+// computes the hash of a name
+unsigned int hash_string(const char * key, int length);
+// finds the value associated with a name
+int table_get(table * map, const char * key, int length, int * value);
+// associates a value with a name (either existing or new)
+int table_set(table * map, const char * key, int length, int value);
+// releases the memory used by a table
+void free_table(table * map);
+
+
+#endif
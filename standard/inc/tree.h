@@ -10,37 +10,52 @@
 #define EXPR_H
 
 
+#include <cstddef>
+#include "arena.h"
 #include "lexer.h"
+#include "value.h"
 
 
-// the maximum number of characters in a literal
-#ifndef MAX_LIT_LEN
-#define MAX_LIT_LEN 32
+// the number of characters of output there is room for at first (doubling whenever it runs out)
+#ifndef MIN_OUTPUT_LEN
+#define MIN_OUTPUT_LEN 256
 #endif
 
-// the maximum number of characters in any identifier
-#ifndef MAX_IDENTIFIER_LEN
-#define MAX_IDENTIFIER_LEN 32
+
+// each page of a syntax tree's nodes holds 2 to the power of this many nodes
+#ifndef NODE_PAGE_SHIFT
+#define NODE_PAGE_SHIFT 6
 #endif
 
+// the number of pages a syntax tree's table of pages has room for once the first one is created
+#ifndef MIN_NUM_PAGES
+#define MIN_NUM_PAGES 8
+#endif
 
-// the maximum number of statements allowed on one line
-#ifndef MAX_NUM_STMTS
-#define MAX_NUM_STMTS 32
+// the number of statements a syntax tree's list of block statements has room for at first (doubling whenever it runs out)
+#ifndef MIN_NUM_STATEMENTS
+#define MIN_NUM_STATEMENTS 64
 #endif
 
 
-struct node;    // forward declaration
+// marks a variable that has not yet been given storage by the resolver
+#define UNRESOLVED_SLOT -1
+
+// marks a missing child node (index 0 of every syntax tree is reserved for it)
+#define NO_NODE 0
 
 
 /**
  * \brief The internal representation of an assignment operation.
  */
 struct assign_value {
-    // the identifier to assign into
-    char name[MAX_IDENTIFIER_LEN];
-    // the expression to assign the identifier to
-    node * value;
+    // the symbol of the identifier to assign into
+    int name;
+    // where the identifier's value is stored, filled in by the resolver
+    int depth;
+    int slot;
+    // the index of the expression to assign the identifier to
+    int value;
 };
 
 
@@ -48,12 +63,12 @@ struct assign_value {
  * \brief The internal representation of a binary arithmetic operation.
  */
 struct binary_value {
-    // the first operand of this operation
-    node * left;
+    // the index of the first operand of this operation
+    int left;
     // the actual operation to complete
     lexemes opcode;
-    // the second operand of this operation
-    node * right;
+    // the index of the second operand of this operation
+    int right;
 };
 
 
@@ -61,8 +76,10 @@ struct binary_value {
  * \brief The internal representation of a block of statements.
  */
 struct block_value {
-    // the statements to be executed at once
-    node * statements[MAX_NUM_STMTS];
+    // the position of the first of the statements to be executed at once, in the tree's list of statements
+    int first;
+    // how many statements there are, so that a block takes no more room than it needs
+    int count;
 };
 
 
@@ -70,14 +87,14 @@ struct block_value {
  * \brief The internal representation of a for loop.
  */
 struct forloop_value {
-    // the identifier to make the loop variable
-    char name[MAX_IDENTIFIER_LEN];
-    // the iterable expression to loop over
-    node * expression;
-    // the statements to execute at each iteration
-    node * statements;
-    // the statements to execute after normal execution
-    node * end;
+    // the index of the variable node of the loop variable, which the resolver fills in as a variable being assigned
+    int variable;
+    // the index of the iterable expression to loop over
+    int expression;
+    // the index of the statements to execute at each iteration
+    int statements;
+    // the index of the statements to execute after normal execution
+    int end;
 };
 
 
@@ -85,8 +102,8 @@ struct forloop_value {
  * \brief The internal representation of a parenthetical expression.
  */
 struct grouping_value {
-    // the expression inside the parentheses
-    node * expression;
+    // the index of the expression inside the parentheses
+    int expression;
 };
 
 
@@ -94,39 +111,11 @@ struct grouping_value {
  * \brief The internal representation of an if-else branch.
  */
 struct ifelse_value {
-    // the expression whose values determines what branch we select
-    node * condition;
-    // the statements to execute if the condiion is true or false
-    node * ifbranch;
-    node * elsebranch;
-};
-
-
-/**
- * \brief The list of all possible literal types in Python.
- */
-enum literal_types {
-    FALSE_VALUE, NONE_VALUE, NUMBER_VALUE, STRING_VALUE, TRUE_VALUE
-};
-
-
-// for ease of printing
-const char * const literal_names[] = {
-    "bool", "NoneType", "int", "str", "bool"
-};
-
-
-/**
- * \brief The internal representation of a literal value.
- */
-struct literal_value {
-    // the data type of the value being stored
-    literal_types type;
-    // the actual data being stored
-    union {
-        int number;
-        char string[MAX_LIT_LEN];
-    } data;
+    // the index of the expression whose values determines what branch we select
+    int condition;
+    // the indices of the statements to execute if the condiion is true or false
+    int ifbranch;
+    int elsebranch;
 };
 
 
@@ -134,12 +123,12 @@ struct literal_value {
  * \brief The internal representation of a binary logical operation.
  */
 struct logical_value {
-    // the first operand of this operation
-    node * left;
+    // the index of the first operand of this operation
+    int left;
     // the actual operation to complete
     lexemes opcode;
-    // the second operand of this operation
-    node * right;
+    // the index of the second operand of this operation
+    int right;
 };
 
 
@@ -158,8 +147,8 @@ struct special_value {
 struct unary_value {
     // the actual operation to complete
     lexemes opcode;
-    // the operand of this operation
-    node * right;
+    // the index of the operand of this operation
+    int right;
 };
 
 
@@ -167,8 +156,11 @@ struct unary_value {
  * \brief The internal representation of the operation of fetching a variable's value.
  */
 struct variable_value {
-    // the identifier to read from
-    char name[MAX_IDENTIFIER_LEN];
+    // the symbol of the identifier to read from
+    int name;
+    // where the identifier's value is stored, filled in by the resolver
+    int depth;
+    int slot;
 };
 
 
@@ -176,12 +168,12 @@ struct variable_value {
  * \brief The internal representation of a while loop.
  */
 struct whileloop_value {
-    // the expression to determine whether loop should continue
-    node * expression;
-    // the statements to execute at each iteration
-    node * statements;
-    // the statements to execute after normal execution
-    node * end;
+    // the index of the expression to determine whether loop should continue
+    int expression;
+    // the index of the statements to execute at each iteration
+    int statements;
+    // the index of the statements to execute after normal execution
+    int end;
 };
 
 
@@ -216,7 +208,8 @@ const char * const node_names[] = {
 struct node {
     // the type of node -- unary, binary, literal, etc.
     node_types type;
-    // the internal representation of that type of node, conserving memory
+    // the internal representation of that type of node, conserving memory (a literal is a single word, so it is stored in place)
+    // no member is bigger than four ints, so every node takes 24 bytes
     union {
         assign_value assign_val;
         binary_value binary_val;
@@ -234,23 +227,103 @@ struct node {
 };
 
 
+/**
+ * \brief A value whose reference is held by a syntax tree, kept in a list so that it is released along with the tree.
+ */
+struct owned_value {
+    literal_value value;
+    owned_value * next;
+};
+
+
+/**
+ * \brief The internal representation of a whole syntax tree, all of whose memory comes from one arena.
+ */
+struct syntax_tree {
+    // holds every node and list of statements of the tree, so they are all released at once
+    arena memory;
+    // the pages of nodes, which refer to each other by index (the page, then the position within it)
+    node ** pages = NULL;
+    int page_capacity = 0;
+    int num_nodes = 0;
+    // the statements of every block, each block's one run after another (this list outlives the arena, like the pages)
+    int * statements = NULL;
+    int num_statements = 0;
+    int statement_capacity = 0;
+    // the index of the node that the whole tree starts from
+    int root = NO_NODE;
+    // the objects referred to by the tree's literals, stored in the arena
+    owned_value * owned = NULL;
+};
+
+
+/**
+ * \brief The text a command prints, which grows to fit however much there is.
+ */
+struct output_text {
+    // the characters written so far (null-terminated once anything is written)
+    char * text = NULL;
+    // the number of characters written, and the number there is room for
+    size_t length = 0;
+    size_t capacity = 0;
+};
+
+
+/**
+ * \brief Finds a node of a syntax tree by its index (defined here so that every tree walk can inline it).
+ * \param [in] tree Pointer to the syntax tree containing the node.
+ * \param [in] index The index of the node.
+ * \return Pointer to the node, which stays valid until the tree is cleared.
+ */
+inline node * node_at(const syntax_tree * tree, int index) {
+    return &(tree -> pages[index >> NODE_PAGE_SHIFT][index & ((1 << NODE_PAGE_SHIFT) - 1)]);
+}
+
+
+/**
+ * \brief Finds one of the statements of a block, by its position within the block.
+ * \param [in] tree Pointer to the syntax tree containing the block.
+ * \param [in] block Pointer to the internal representation of the block.
+ * \param [in] position The position of the statement within the block.
+ * \return The index of the statement's node.
+ */
+inline int statement_at(const syntax_tree * tree, const block_value * block, int position) {
+    return tree -> statements[block -> first + position];
+}
+
+
 // constructor functions for these node structs
-node make_new_assign(char name[], node * value);
-node make_new_binary(node * left, lexemes opcode, node * right);
-node make_new_block(node ** statements);
-node make_new_forloop(char name[], node * expression, node * statements, node * end);
-node make_new_grouping(node * expression);
-node make_new_ifelse(node * condition, node * ifbranch, node * elsebranch);
+node make_new_assign(int name, int value);
+node make_new_binary(int left, lexemes opcode, int right);
+node make_new_block(int first, int count);
+node make_new_forloop(int variable, int expression, int statements, int end);
+node make_new_grouping(int expression);
+node make_new_ifelse(int condition, int ifbranch, int elsebranch);
 node make_new_literal(literal_value value);
-node make_new_logical(node * left, lexemes opcode, node * right);
+node make_new_logical(int left, lexemes opcode, int right);
 node make_new_special(lexemes keyword);
-node make_new_unary(lexemes opcode, node * right);
-node make_new_variable(char name[]);
-node make_new_whileloop(node * expression, node * statements, node * end);
-// to convert a literal value into a well-formatted string
-void stringify_value(literal_value value, char ** output_ptr);
+node make_new_unary(lexemes opcode, int right);
+node make_new_variable(int name);
+node make_new_whileloop(int expression, int statements, int end);
+// to store the parts of a syntax tree, each returning where it was stored
+int add_node(syntax_tree * tree, const node * value);
+int add_statements(syntax_tree * tree, const int * statements, int count);
+int keep_value(syntax_tree * tree, literal_value value);
+int add_string_literal(syntax_tree * tree, const char * text, int length, literal_value * value);
+int add_number_literal(syntax_tree * tree, const char * text, int length, literal_value * value);
+// to empty a syntax tree so that its memory can be reused by the next one
+void clear_tree(syntax_tree * tree);
+// to release the memory used by a syntax tree
+void free_tree(syntax_tree * tree);
+// to convert a literal value into a well-formatted string, added to the end of the output
+int stringify_value(const literal_value * value, output_text * output);
+// to empty the output so that its memory can be reused by the next command
+void clear_output(output_text * output);
+// to release the memory used by the output
+void free_output(output_text * output);
+// to print a representation of a literal value for debugging
+void print_value(const literal_value * value);
 // to print a representation of the syntax tree for debugging
-void print_tree(node tree);
-
+void print_tree(const syntax_tree * tree, int index);
 
 #endif
@@ -10,17 +10,65 @@
 #define UTILITY_H
 
 
-// for checking if a character is a number
-bool isdigit(char character);
-// for checking if a character is a letter
-bool isalpha(char character);
-// for checking if a character is a number or letter
-bool isalphanumeric(char character);
+// the kinds of character the lexer tells apart, as bits of each character's entry in the class table
+#define CHAR_DIGIT 0x01
+#define CHAR_ALPHA 0x02
+#define CHAR_SPACE 0x04
+
+// the kinds each of the 256 possible characters is
+extern const unsigned char char_classes[256];
+
+
+/**
+ * \brief Determines if a particular character is a numerical digit or not, like the standard isdigit().
+ * \param [in] character The character to test.
+ * \return True if the character is a digit; false otherwise.
+ */
+inline bool isdigit(char character) {
+    return char_classes[(unsigned char) character] & CHAR_DIGIT;
+}
+
+
+/**
+ * \brief Determines if a particular character is a letter or not, like the standard isalpha().
+ * \param [in] character The character to test.
+ * \return True if the character is a letter or underscore; false otherwise.
+ */
+inline bool isalpha(char character) {
+    return char_classes[(unsigned char) character] & CHAR_ALPHA;
+}
+
+
+/**
+ * \brief Determines if a particular character is a letter or digit not, like the standard isalphanumeric().
+ * \param [in] character The character to test.
+ * \return True if the character is a letter or digit; false otherwise.
+ */
+inline bool isalphanumeric(char character) {
+    return char_classes[(unsigned char) character] & (CHAR_ALPHA | CHAR_DIGIT);
+}
+
+
+/**
+ * \brief Determines if a particular character is whitespace within a line (a space, tab, or form feed).
+ * \param [in] character The character to test.
+ * \return True if the character is whitespace; false otherwise.
+ */
+inline bool isspace(char character) {
+    return char_classes[(unsigned char) character] & CHAR_SPACE;
+}
+
+
 // for checking if a string is made of only letters and/or numbers
 bool isalphanumeric(char * str);
 // for converting between numerical strings and integer values
 int stoi(char ** num_str, int str_len);
 void itos(char ** num_str, int num_value);
+// for finding where a run of characters of one kind ends, many characters at a time
+int skip_digits(const char * text, int start, int end);
+int skip_alphanumerics(const char * text, int start, int end);
+int skip_spaces(const char * text, int start, int end);
+int find_either(const char * text, int start, int end, char first, char second);
 
 
 #endif
@@ -0,0 +1,272 @@
+/*********************************************************************************
+* Description: Defines the tagged word that every value of the interpreter is held in
+* Author(s): Isaac Joffe
+* Copyright: University of Alberta, 2024
+* License: CC-BY-4.0
+*********************************************************************************/
+
+
+#ifndef VALUE_H
+#define VALUE_H
+
+
+#include <cstdint>
+
+
+// the most characters a string may hold (a longer one is treated as memory running out)
+#ifndef MAX_STRING_LEN
+#define MAX_STRING_LEN (1 << 30)
+#endif
+
+// the most characters a string literal may have to be interned (longer ones are rarely repeated)
+#ifndef MAX_INTERN_LEN
+#define MAX_INTERN_LEN 32
+#endif
+
+// the number of strings the intern table has room for once the first one is interned (must be a power of 2)
+#ifndef INTERN_MIN_CAPACITY
+#define INTERN_MIN_CAPACITY 64
+#endif
+
+
+/** A value is one 64-bit word, so that copying one is a single register move.
+    The lowest bits of the word tell what it holds:
+      * xxx1: a number that fits in an int, shifted up by one bit (so it is recovered with an arithmetic shift down)
+      * 0010, 0100, 0110: False, None, and True, which need no storage at all
+      * x000: a pointer to an object on the heap (objects are aligned to 8 bytes, so the bits are free)
+    A number too big for an int is an object instead, holding as many 32-bit limbs as it needs (see bigint.h).
+    Objects count the references to them, and are freed when the last one is released.
+    Whoever stores a value (a variable, the virtual machine's stack, a syntax tree, a cached command) owns a reference.
+    Strings are never changed once made, so copying one (by assignment, or into a loop variable) only adds a reference.
+    A string knows its length, so it may be as long as memory allows, and it keeps its hash once it has been found.
+    Concatenation gives its result spare room, and a string ending where that room starts is appended to by writing into it.
+    The result shares the characters of the string appended to (every string sharing them is a prefix of the longest),
+    so building a string one piece at a time copies each piece once, and reading one never needs to gather its pieces.
+    Since a longer string may follow on in the same memory, a string's characters do not end in a null character.
+    Short string literals are interned, so every literal with the same characters is one object, compared by its pointer.
+    The intern table does not hold references itself, so an interned string is forgotten when the last value using it is.
+    The 256 strings of a single character are made once and never freed, so iterating over a string allocates nothing.
+*/
+
+
+/**
+ * \brief The list of all possible literal types in Python.
+ */
+enum literal_types {
+    FALSE_VALUE, NONE_VALUE, NUMBER_VALUE, STRING_VALUE, TRUE_VALUE
+};
+
+
+// for ease of printing
+const char * const literal_names[] = {
+    "bool", "NoneType", "int", "str", "bool"
+};
+
+
+// the bits of a value's word that are checked to tell what it holds
+#define NUMBER_TAG 0x1
+#define OBJECT_MASK 0x7
+
+// the whole words of the values that are always the same
+#define FALSE_BITS 0x2
+#define NONE_BITS 0x4
+#define TRUE_BITS 0x6
+
+
+// the type held by a value, for each of the possible lowest 3 bits of its word (0 is an object, whose type is stored apart)
+const literal_types tag_types[] = {
+    NONE_VALUE, NUMBER_VALUE, FALSE_VALUE, NUMBER_VALUE, NONE_VALUE, NUMBER_VALUE, TRUE_VALUE, NUMBER_VALUE
+};
+
+
+/**
+ * \brief The internal representation of a literal value.
+ */
+struct literal_value {
+    // a number, an immediate, or a pointer to an object, told apart by the lowest bits
+    uint64_t bits;
+};
+
+
+/**
+ * \brief The start of every object on the heap.
+ */
+struct heap_object {
+    // the data type of the object
+    literal_types type;
+    // the number of values that refer to the object
+    int references;
+};
+
+
+/**
+ * \brief The internal representation of a string on the heap.
+ */
+struct string_object {
+    heap_object header;
+    // the number of characters
+    int length;
+    // the hash of the characters, found the first time it is needed (0 until then)
+    unsigned int hash;
+    // the characters of the string (not ending in a null character)
+    char * text;
+    // the string whose memory holds the characters (itself, unless it was made by appending to another string)
+    string_object * storage;
+    // for a string holding its own characters: the number it has room for, and the number used by the longest string sharing them
+    int capacity;
+    int used;
+    // whether this is the only string object with these characters that is interned
+    bool interned;
+    // the memory of a string holding its own characters
+    char characters[];
+};
+
+
+// to create a string object whose characters are then written by the caller
+char * new_string(int length, literal_value * value);
+// to create a string object holding a copy of some characters
+int make_string(const char * text, int length, literal_value * value);
+// to create a string object holding the characters of one string followed by another
+int append_string(const literal_value * left, const literal_value * right, literal_value * value);
+// to fetch the interned string object holding some characters, creating it if needed
+int intern_string(const char * text, int length, literal_value * value);
+// to fetch the string object holding a single character
+int make_character(char character, literal_value * value);
+// to find the hash of a string's characters, computing it only once
+unsigned int hash_of(const literal_value * value);
+// to release the memory used by an object once nothing refers to it
+void free_object(heap_object * object);
+
+
+/**
+ * \brief Creates a value holding a number.
+ * \param [in] number The number to hold.
+ * \return The value.
+ */
+inline literal_value make_number(int number) {
+    literal_value value;
+    value.bits = ((uint64_t) (int64_t) number << 1) | NUMBER_TAG;
+    return value;
+}
+
+
+/**
+ * \brief Creates a value holding True or False.
+ * \param [in] truth Whether the value should be True.
+ * \return The value.
+ */
+inline literal_value make_bool(bool truth) {
+    literal_value value;
+    value.bits = truth ? TRUE_BITS : FALSE_BITS;
+    return value;
+}
+
+
+/**
+ * \brief Creates a value holding None.
+ * \return The value.
+ */
+inline literal_value make_none() {
+    literal_value value;
+    value.bits = NONE_BITS;
+    return value;
+}
+
+
+/**
+ * \brief Determines whether a value refers to an object on the heap.
+ * \param [in] value Pointer to the value of interest.
+ * \return Whether the value is a pointer to an object.
+ */
+inline bool is_object(const literal_value * value) {
+    return !(value -> bits & OBJECT_MASK);
+}
+
+
+/**
+ * \brief Finds the object a value refers to.
+ * \param [in] value Pointer to a value that refers to an object.
+ * \return Pointer to the object.
+ */
+inline heap_object * object_of(const literal_value * value) {
+    return (heap_object *) (uintptr_t) (value -> bits);
+}
+
+
+/**
+ * \brief Determines the data type held by a value.
+ * \param [in] value Pointer to the value of interest.
+ * \return The type of the value.
+ */
+inline literal_types type_of(const literal_value * value) {
+    int tag = value -> bits & OBJECT_MASK;
+    return tag ? tag_types[tag] : object_of(value) -> type;
+}
+
+
+/**
+ * \brief Fetches the number held by a value.
+ * \param [in] value Pointer to a value holding a number.
+ * \return The number.
+ */
+inline int number_of(const literal_value * value) {
+    return (int) ((int64_t) (value -> bits) >> 1);
+}
+
+
+/**
+ * \brief Fetches the characters of the string held by a value.
+ * \param [in] value Pointer to a value holding a string.
+ * \return Pointer to the characters (of which there are length_of(value), with no null character after them).
+ */
+inline const char * string_of(const literal_value * value) {
+    return ((const string_object *) object_of(value)) -> text;
+}
+
+
+/**
+ * \brief Fetches the number of characters of the string held by a value.
+ * \param [in] value Pointer to a value holding a string.
+ * \return The number of characters.
+ */
+inline int length_of(const literal_value * value) {
+    return ((const string_object *) object_of(value)) -> length;
+}
+
+
+/**
+ * \brief Determines whether the string held by a value is the one interned string with its characters.
+ * \param [in] value Pointer to a value holding a string.
+ * \return Whether the string is interned.
+ */
+inline bool is_interned(const literal_value * value) {
+    return ((const string_object *) object_of(value)) -> interned;
+}
+
+
+/**
+ * \brief Adds a reference to whatever a value refers to, for a copy of it that is kept.
+ * \param [in] value Pointer to the value being copied.
+ */
+inline void retain(const literal_value * value) {
+    if (is_object(value)) {
+        object_of(value) -> references++;
+    }
+}
+
+
+/**
+ * \brief Drops a reference to whatever a value refers to, freeing it if nothing else refers to it.
+ * \param [in] value Pointer to the value being discarded.
+ */
+inline void release(const literal_value * value) {
+    if (is_object(value)) {
+        heap_object * object = object_of(value);
+        if (!(--(object -> references))) {
+            free_object(object);
+        }
+    }
+}
+
+
+#endif
@@ -0,0 +1,51 @@
+/*********************************************************************************
+* Description: The virtual machine (executes the bytecode produced by the compiler)
+* Author(s): Isaac Joffe
+* Copyright: University of Alberta, 2024
+* License: CC-BY-4.0
+*********************************************************************************/
+
+
+#ifndef VM_H
+#define VM_H
+
+
+#include "chunk.h"
+#include "environment.h"
+#include "tree.h"
+
+
+// the maximum number of values on the virtual machine's stack at once
+#ifndef MAX_STACK_SIZE
+#define MAX_STACK_SIZE 256
+#endif
+
+
+/**
+ * \brief The virtual machine of the interpreter; it takes bytecode as input and executes it.
+ */
+class VirtualMachine {
+    private:
+        // for storing variables
+        environment * env;
+        environment * scope_at(int depth);
+        // for holding intermediate values while executing
+        literal_value stack[MAX_STACK_SIZE];
+        // main logic of the virtual machine; decodes and executes each instruction
+        int run(chunk * code);
+        // for error handling
+        bool error_occurred = false;
+        int fail(literal_value * stack_top);
+        bool has_error();
+        // for storing outputs
+        output_text * printed;
+
+    public:
+        // constructor to save pre-created environment
+        VirtualMachine(environment * env);
+        // executes a compiled chunk of bytecode
+        int run_input(chunk * input, output_text * output);
+};
+
+
+#endif
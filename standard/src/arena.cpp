@@ -0,0 +1,96 @@
+/*********************************************************************************
+* Description: An arena allocator (hands out memory that is all released at once)
+* Author(s): Isaac Joffe
+* Copyright: University of Alberta, 2024
+* License: CC-BY-4.0
+*********************************************************************************/
+
+
+#include <cstdlib>
+#include "arena.h"
+
+
+/** Everything made while running one command (such as its syntax tree) is no longer needed once it is done.
+    So, rather than freeing each piece separately, the whole arena is reset between commands in constant time.
+    Memory is never moved once handed out, so pointers into an arena stay valid until it is reset.
+*/
+
+
+/**
+ * \brief Hands out a piece of memory from an arena, making a new chunk if none has enough room left.
+ * \param [inout] memory Pointer to the arena to allocate from.
+ * \param [in] size The number of bytes needed.
+ * \return Pointer to the memory handed out; NULL if memory ran out.
+ */
+void * arena_allocate(arena * memory, size_t size) {
+    // keep every allocation aligned for any type stored in it
+    size = (size + ARENA_ALIGNMENT - 1) & ~((size_t) ARENA_ALIGNMENT - 1);
+    // find a chunk with room, noting that chunks after the current one are left over from before a reset
+    arena_chunk * previous = NULL;
+    arena_chunk * chunk = memory -> current;
+    while (chunk && (((chunk -> used) + size) > (chunk -> size))) {
+        previous = chunk;
+        chunk = chunk -> next;
+        if (chunk) {
+            chunk -> used = 0;
+        }
+    }
+    // make a new chunk at the end, twice as big as the last one so that few are ever needed
+    if (!chunk) {
+        size_t chunk_size = previous ? (2 * (previous -> size)) : MIN_CHUNK_SIZE;
+        while (chunk_size < size) {
+            chunk_size *= 2;
+        }
+        chunk = (arena_chunk *) malloc(sizeof(arena_chunk) + chunk_size);
+        if (!chunk) {
+            return NULL;
+        }
+        chunk -> next = NULL;
+        chunk -> size = chunk_size;
+        chunk -> used = 0;
+        if (previous) {
+            previous -> next = chunk;
+        } else {
+            memory -> first = chunk;
+        }
+        memory -> bytes_reserved += chunk_size;
+    }
+    // hand out the next unused bytes of the chunk (which start right after its header)
+    memory -> current = chunk;
+    void * result = ((unsigned char *) (chunk + 1)) + (chunk -> used);
+    chunk -> used += size;
+    memory -> bytes_allocated += size;
+    return result;
+}
+
+
+/**
+ * \brief Makes all the memory of an arena available again in constant time, keeping its chunks for reuse.
+ * \param [inout] memory Pointer to the arena to reset.
+ */
+void reset_arena(arena * memory) {
+    // later chunks are emptied only once allocation reaches them again
+    memory -> current = memory -> first;
+    if (memory -> first) {
+        memory -> first -> used = 0;
+    }
+    memory -> bytes_allocated = 0;
+}
+
+
+/**
+ * \brief Releases all the memory used by an arena, leaving it with no chunks.
+ * \param [inout] memory Pointer to the arena to free.
+ */
+void free_arena(arena * memory) {
+    arena_chunk * chunk = memory -> first;
+    while (chunk) {
+        arena_chunk * next = chunk -> next;
+        free(chunk);
+        chunk = next;
+    }
+    memory -> first = NULL;
+    memory -> current = NULL;
+    memory -> bytes_allocated = 0;
+    memory -> bytes_reserved = 0;
+}
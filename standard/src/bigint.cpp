@@ -0,0 +1,888 @@
+/*********************************************************************************
+* Description: Integers too big to fit in a machine word, held on the heap
+* Author(s): Isaac Joffe
+* Copyright: University of Alberta, 2024
+* License: CC-BY-4.0
+*********************************************************************************/
+
+
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include "bigint.h"
+#include "error.h"
+
+
+/** Python's integers have no limit, but almost every integer a program uses fits in an int.
+    So an int is held right in the value's word, and the operators check for overflow with the compiler's builtins.
+    Only a result that overflows comes here, and is held on the heap as a sign and a size made of 32-bit limbs.
+    A number on the heap never fits in an int (any that would is put back in the word), so each number has one form.
+    The arithmetic is done on the sizes, one limb at a time, the way it is done by hand (division follows Knuth's algorithm D).
+    Bitwise operators and shifts act as though negative numbers were in two's complement with infinitely many bits.
+*/
+
+
+// the number of distinct values of one limb
+#define LIMB_BASE ((uint64_t) 1 << 32)
+
+// the largest power of 10 that fits in a limb, and its number of digits
+#define DIGITS_BASE 1000000000u
+#define DIGITS_PER_LIMB 9
+
+// the ways working on a number can fail, so that the right error is reported
+#define NUMBER_TOO_BIG 1
+#define NUMBER_NO_MEMORY 2
+
+
+/**
+ * \brief A number while it is worked on, whose limbs are either borrowed from a value or owned by the number.
+ */
+struct big_number {
+    // whether the number is below zero
+    bool negative;
+    // the number of limbs in use (the most significant one is never 0, once normalized)
+    int count;
+    // the size of the number, the least significant limb first
+    uint32_t * limbs;
+};
+
+
+/**
+ * \brief Views any numerical value as a number made of limbs, without copying a number on the heap.
+ * \param [in] value Pointer to a numerical value (an int, a bool, or a number on the heap).
+ * \param [inout] scratch Pointer to a limb to hold the size of a value that is not on the heap.
+ * \param [inout] view Pointer to where to store the view of the number.
+ */
+static void view_number(const literal_value * value, uint32_t * scratch, big_number * view) {
+    if (is_object(value)) {
+        number_object * number = (number_object *) object_of(value);
+        view -> negative = number -> negative;
+        view -> count = number -> count;
+        view -> limbs = number -> limbs;
+        return;
+    }
+    int64_t number = (type_of(value) == NUMBER_VALUE) ? number_of(value) : (type_of(value) == TRUE_VALUE);
+    uint64_t size = (number < 0) ? -number : number;
+    *scratch = (uint32_t) size;
+    view -> negative = (number < 0);
+    view -> count = size ? 1 : 0;
+    view -> limbs = scratch;
+}
+
+
+/**
+ * \brief Gives a number working memory of its own for some limbs, all of them 0.
+ * \param [in] count The number of limbs to make room for.
+ * \param [inout] number Pointer to the number to give the memory to.
+ * \return 0 if the memory was found; NUMBER_TOO_BIG or NUMBER_NO_MEMORY if it was not.
+ */
+static int new_number(long long count, big_number * number) {
+    // working numbers may grow a little past the limit before they are cut back down
+    if (count > MAX_NUMBER_LIMBS + 2) {
+        return NUMBER_TOO_BIG;
+    }
+    number -> negative = false;
+    number -> count = count;
+    number -> limbs = (uint32_t *) calloc(count + 1, sizeof(uint32_t));
+    return number -> limbs ? 0 : NUMBER_NO_MEMORY;
+}
+
+
+/**
+ * \brief Reports why a number could not be made, as an error the program can see.
+ * \param [in] code The reason the number could not be made (NUMBER_TOO_BIG or NUMBER_NO_MEMORY).
+ * \return 1, so that the failure can be passed straight on.
+ */
+static int number_error(int code) {
+    if (code == NUMBER_TOO_BIG) {
+        report_error(OVERFLOW, "integer is too large");
+    } else {
+        report_error(MEMORY, "out of memory for number");
+    }
+    return 1;
+}
+
+
+/**
+ * \brief Drops any limbs at the top of a number that are 0, so that its most significant limb is not.
+ * \param [inout] number Pointer to the number to normalize.
+ */
+static void normalize(big_number * number) {
+    while ((number -> count > 0) && !(number -> limbs[number -> count - 1])) {
+        number -> count--;
+    }
+    // there is no negative 0
+    if (!(number -> count)) {
+        number -> negative = false;
+    }
+}
+
+
+/**
+ * \brief Stores a number worked on as the result of an operation, in the word if it fits, and releases its memory.
+ * \param [inout] number Pointer to the number, whose memory is released.
+ * \param [inout] result Pointer to where to store the computed value.
+ * \return 0 if the result was stored; 1 if it would be too big or memory ran out (which has been reported).
+ */
+static int give_result(big_number * number, literal_value * result) {
+    normalize(number);
+    uint32_t top = number -> count ? number -> limbs[0] : 0;
+    // a number that fits in an int always goes in the word
+    if ((number -> count <= 1) && (top <= (number -> negative ? (uint32_t) INT_MAX + 1 : (uint32_t) INT_MAX))) {
+        *result = make_number(number -> negative ? (int) -(int64_t) top : (int) top);
+        free(number -> limbs);
+        return 0;
+    }
+    // malloc gives memory aligned to at least 8 bytes, leaving the lowest bits of the pointer free for the tag
+    number_object * object = NULL;
+    if (number -> count <= MAX_NUMBER_LIMBS) {
+        object = (number_object *) malloc(sizeof(number_object) + number -> count * sizeof(uint32_t));
+    }
+    if (!object) {
+        free(number -> limbs);
+        *result = make_none();
+        return number_error((number -> count > MAX_NUMBER_LIMBS) ? NUMBER_TOO_BIG : NUMBER_NO_MEMORY);
+    }
+    object -> header.type = NUMBER_VALUE;
+    object -> header.references = 1;
+    object -> negative = number -> negative;
+    object -> count = number -> count;
+    memcpy(object -> limbs, number -> limbs, number -> count * sizeof(uint32_t));
+    free(number -> limbs);
+    result -> bits = (uint64_t) (uintptr_t) object;
+    return 0;
+}
+
+
+/**
+ * \brief Compares the sizes of two numbers, ignoring their signs.
+ * \param [in] left Pointer to the first number (normalized).
+ * \param [in] right Pointer to the second number (normalized).
+ * \return A negative value, 0, or a positive value if the first is smaller, the same size, or bigger.
+ */
+static int compare_sizes(const big_number * left, const big_number * right) {
+    if (left -> count != right -> count) {
+        return (left -> count < right -> count) ? -1 : 1;
+    }
+    for (int i = left -> count - 1; i >= 0; i--) {
+        if (left -> limbs[i] != right -> limbs[i]) {
+            return (left -> limbs[i] < right -> limbs[i]) ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+
+/**
+ * \brief Adds two numbers of any signs.
+ * \param [in] left Pointer to the first number.
+ * \param [in] right Pointer to the second number.
+ * \param [inout] sum Pointer to where to store the sum, in memory of its own.
+ * \return 0 if the sum was found; NUMBER_TOO_BIG or NUMBER_NO_MEMORY if it could not be.
+ */
+static int add_numbers(const big_number * left, const big_number * right, big_number * sum) {
+    // numbers of the same sign have their sizes added
+    if (left -> negative == right -> negative) {
+        const big_number * longer = (left -> count >= right -> count) ? left : right;
+        const big_number * shorter = (longer == left) ? right : left;
+        int code = new_number(longer -> count + 1, sum);
+        if (code) {
+            return code;
+        }
+        uint64_t carry = 0;
+        for (int i = 0; i < longer -> count; i++) {
+            carry += (uint64_t) longer -> limbs[i] + ((i < shorter -> count) ? shorter -> limbs[i] : 0);
+            sum -> limbs[i] = (uint32_t) carry;
+            carry >>= 32;
+        }
+        sum -> limbs[longer -> count] = (uint32_t) carry;
+        sum -> negative = left -> negative;
+    // numbers of opposite signs have the smaller size taken from the bigger, whose sign wins
+    } else {
+        const big_number * bigger = (compare_sizes(left, right) >= 0) ? left : right;
+        const big_number * smaller = (bigger == left) ? right : left;
+        int code = new_number(bigger -> count, sum);
+        if (code) {
+            return code;
+        }
+        int64_t borrow = 0;
+        for (int i = 0; i < bigger -> count; i++) {
+            int64_t difference = (int64_t) bigger -> limbs[i] - ((i < smaller -> count) ? smaller -> limbs[i] : 0) - borrow;
+            borrow = (difference < 0);
+            sum -> limbs[i] = (uint32_t) (difference + (borrow ? (int64_t) LIMB_BASE : 0));
+        }
+        sum -> negative = bigger -> negative;
+    }
+    normalize(sum);
+    return 0;
+}
+
+
+/**
+ * \brief Multiplies two numbers of any signs.
+ * \param [in] left Pointer to the first number.
+ * \param [in] right Pointer to the second number.
+ * \param [inout] product Pointer to where to store the product, in memory of its own.
+ * \return 0 if the product was found; NUMBER_TOO_BIG or NUMBER_NO_MEMORY if it could not be.
+ */
+static int multiply_numbers(const big_number * left, const big_number * right, big_number * product) {
+    int code = new_number((long long) left -> count + right -> count, product);
+    if (code) {
+        return code;
+    }
+    for (int i = 0; i < left -> count; i++) {
+        uint64_t carry = 0;
+        for (int j = 0; j < right -> count; j++) {
+            carry += (uint64_t) left -> limbs[i] * right -> limbs[j] + product -> limbs[i + j];
+            product -> limbs[i + j] = (uint32_t) carry;
+            carry >>= 32;
+        }
+        product -> limbs[i + right -> count] = (uint32_t) carry;
+    }
+    product -> negative = (left -> negative != right -> negative);
+    normalize(product);
+    return 0;
+}
+
+
+/**
+ * \brief Divides one number by another, rounding the quotient toward zero (so the remainder has the sign of the dividend).
+ * \param [in] left Pointer to the dividend.
+ * \param [in] right Pointer to the divisor (which must not be 0).
+ * \param [inout] quotient Pointer to where to store the quotient, in memory of its own.
+ * \param [inout] remainder Pointer to where to store the remainder, in memory of its own.
+ * \return 0 if the division was done; NUMBER_TOO_BIG or NUMBER_NO_MEMORY if it could not be.
+ */
+static int divide_numbers(const big_number * left, const big_number * right, big_number * quotient, big_number * remainder) {
+    int m = left -> count;
+    int n = right -> count;
+    int code = new_number((m >= n) ? (m - n + 1) : 1, quotient);
+    if (code) {
+        return code;
+    }
+    code = new_number(n, remainder);
+    if (code) {
+        free(quotient -> limbs);
+        return code;
+    }
+    const uint32_t * u = left -> limbs;
+    const uint32_t * v = right -> limbs;
+    // a dividend smaller than the divisor is all remainder
+    if (compare_sizes(left, right) < 0) {
+        memcpy(remainder -> limbs, u, m * sizeof(uint32_t));
+        quotient -> count = 0;
+        remainder -> count = m;
+    // a divisor of one limb is divided into the dividend one limb at a time, as in short division
+    } else if (n == 1) {
+        uint64_t rest = 0;
+        for (int i = m - 1; i >= 0; i--) {
+            rest = (rest << 32) | u[i];
+            quotient -> limbs[i] = (uint32_t) (rest / v[0]);
+            rest %= v[0];
+        }
+        remainder -> limbs[0] = (uint32_t) rest;
+    // otherwise each limb of the quotient is estimated from the top limbs, and corrected (Knuth's algorithm D)
+    } else {
+        uint32_t * vn = (uint32_t *) malloc(n * sizeof(uint32_t));
+        uint32_t * un = (uint32_t *) malloc((m + 1) * sizeof(uint32_t));
+        if (!vn || !un) {
+            free(vn);
+            free(un);
+            free(quotient -> limbs);
+            free(remainder -> limbs);
+            return NUMBER_NO_MEMORY;
+        }
+        // shift both numbers so that the top bit of the divisor is set, which keeps the estimates close
+        int shift = __builtin_clz(v[n - 1]);
+        for (int i = n - 1; i > 0; i--) {
+            vn[i] = (v[i] << shift) | (uint32_t) ((uint64_t) v[i - 1] >> (32 - shift));
+        }
+        vn[0] = v[0] << shift;
+        un[m] = (uint32_t) ((uint64_t) u[m - 1] >> (32 - shift));
+        for (int i = m - 1; i > 0; i--) {
+            un[i] = (u[i] << shift) | (uint32_t) ((uint64_t) u[i - 1] >> (32 - shift));
+        }
+        un[0] = u[0] << shift;
+        for (int j = m - n; j >= 0; j--) {
+            // estimate the next limb from the top two limbs of what is left, which is at most 2 too big
+            uint64_t top = ((uint64_t) un[j + n] << 32) | un[j + n - 1];
+            uint64_t estimate = top / vn[n - 1];
+            uint64_t rest = top % vn[n - 1];
+            while ((estimate >= LIMB_BASE) || (estimate * vn[n - 2] > ((rest << 32) | un[j + n - 2]))) {
+                estimate--;
+                rest += vn[n - 1];
+                if (rest >= LIMB_BASE) {
+                    break;
+                }
+            }
+            // take the divisor times the estimate away from what is left
+            int64_t borrow = 0;
+            int64_t difference = 0;
+            for (int i = 0; i < n; i++) {
+                uint64_t product = estimate * vn[i];
+                difference = (int64_t) un[i + j] - borrow - (int64_t) (product & 0xFFFFFFFF);
+                un[i + j] = (uint32_t) difference;
+                borrow = (int64_t) (product >> 32) - (difference >> 32);
+            }
+            difference = (int64_t) un[j + n] - borrow;
+            un[j + n] = (uint32_t) difference;
+            quotient -> limbs[j] = (uint32_t) estimate;
+            // the estimate was one too big, so add the divisor back
+            if (difference < 0) {
+                quotient -> limbs[j]--;
+                uint64_t carry = 0;
+                for (int i = 0; i < n; i++) {
+                    carry += (uint64_t) un[i + j] + vn[i];
+                    un[i + j] = (uint32_t) carry;
+                    carry >>= 32;
+                }
+                un[j + n] += (uint32_t) carry;
+            }
+        }
+        // what is left is the remainder, shifted back down
+        for (int i = 0; i < n - 1; i++) {
+            remainder -> limbs[i] = (un[i] >> shift) | (uint32_t) ((uint64_t) un[i + 1] << (32 - shift));
+        }
+        remainder -> limbs[n - 1] = un[n - 1] >> shift;
+        free(vn);
+        free(un);
+    }
+    quotient -> negative = (left -> negative != right -> negative);
+    remainder -> negative = left -> negative;
+    normalize(quotient);
+    normalize(remainder);
+    return 0;
+}
+
+
+/**
+ * \brief Makes a copy of a number in memory of its own, optionally negating it.
+ * \param [in] number Pointer to the number to copy.
+ * \param [in] negate Whether to flip the sign of the copy.
+ * \param [inout] copy Pointer to where to store the copy.
+ * \return 0 if the copy was made; NUMBER_TOO_BIG or NUMBER_NO_MEMORY if it could not be.
+ */
+static int copy_number(const big_number * number, bool negate, big_number * copy) {
+    int code = new_number(number -> count, copy);
+    if (code) {
+        return code;
+    }
+    memcpy(copy -> limbs, number -> limbs, number -> count * sizeof(uint32_t));
+    copy -> negative = (number -> negative != negate);
+    normalize(copy);
+    return 0;
+}
+
+
+/**
+ * \brief Adds a small amount to a number.
+ * \param [in] number Pointer to the number.
+ * \param [in] amount The amount to add.
+ * \param [inout] sum Pointer to where to store the sum, in memory of its own.
+ * \return 0 if the sum was found; NUMBER_TOO_BIG or NUMBER_NO_MEMORY if it could not be.
+ */
+static int add_small(const big_number * number, int amount, big_number * sum) {
+    uint32_t scratch;
+    big_number other;
+    literal_value value = make_number(amount);
+    view_number(&value, &scratch, &other);
+    return add_numbers(number, &other, sum);
+}
+
+
+/**
+ * \brief Raises a number to a power, by repeatedly squaring it.
+ * \param [in] base Pointer to the number to raise.
+ * \param [in] exponent The power to raise it to (not negative).
+ * \param [inout] power Pointer to where to store the result, in memory of its own.
+ * \return 0 if the power was found; NUMBER_TOO_BIG or NUMBER_NO_MEMORY if it could not be.
+ */
+static int raise_number(const big_number * base, int exponent, big_number * power) {
+    // check the size of the result first, so that a hopelessly big one is not worked on at all
+    if (base -> count) {
+        long long bits = 32LL * (base -> count - 1) + (32 - __builtin_clz(base -> limbs[base -> count - 1]));
+        if ((bits - 1) * (long long) exponent > 32LL * MAX_NUMBER_LIMBS) {
+            return NUMBER_TOO_BIG;
+        }
+    }
+    big_number square;
+    int code = add_small(base, 0, &square);
+    if (code) {
+        return code;
+    }
+    code = new_number(1, power);
+    if (code) {
+        free(square.limbs);
+        return code;
+    }
+    power -> limbs[0] = 1;
+    while (true) {
+        big_number next;
+        if (exponent & 1) {
+            code = multiply_numbers(power, &square, &next);
+            if (code) {
+                break;
+            }
+            free(power -> limbs);
+            *power = next;
+        }
+        exponent >>= 1;
+        if (!exponent) {
+            free(square.limbs);
+            return 0;
+        }
+        code = multiply_numbers(&square, &square, &next);
+        if (code) {
+            break;
+        }
+        free(square.limbs);
+        square = next;
+    }
+    free(square.limbs);
+    free(power -> limbs);
+    return code;
+}
+
+
+/**
+ * \brief Shifts the size of a number toward its most significant limb, multiplying it by a power of 2.
+ * \param [in] number Pointer to the number to shift.
+ * \param [in] bits The number of bits to shift by (not negative).
+ * \param [inout] shifted Pointer to where to store the result, in memory of its own.
+ * \return 0 if the shift was done; NUMBER_TOO_BIG or NUMBER_NO_MEMORY if it could not be.
+ */
+static int shift_up(const big_number * number, long long bits, big_number * shifted) {
+    if (!(number -> count)) {
+        return new_number(0, shifted);
+    }
+    long long limbs = bits / 32;
+    int rest = bits % 32;
+    int code = new_number(number -> count + limbs + 1, shifted);
+    if (code) {
+        return code;
+    }
+    for (int i = 0; i < number -> count; i++) {
+        uint64_t moved = (uint64_t) number -> limbs[i] << rest;
+        shifted -> limbs[i + limbs] |= (uint32_t) moved;
+        shifted -> limbs[i + limbs + 1] |= (uint32_t) (moved >> 32);
+    }
+    shifted -> negative = number -> negative;
+    normalize(shifted);
+    return 0;
+}
+
+
+/**
+ * \brief Shifts the size of a number toward its least significant limb, dividing it by a power of 2 and rounding down.
+ * \param [in] number Pointer to the number to shift.
+ * \param [in] bits The number of bits to shift by (not negative).
+ * \param [inout] shifted Pointer to where to store the result, in memory of its own.
+ * \return 0 if the shift was done; NUMBER_TOO_BIG or NUMBER_NO_MEMORY if it could not be.
+ */
+static int shift_down(const big_number * number, long long bits, big_number * shifted) {
+    // a negative number rounds toward negative infinity, so -n >> k is -((n - 1) >> k) - 1
+    big_number size;
+    big_number positive = *number;
+    positive.negative = false;
+    int code = add_small(&positive, number -> negative ? -1 : 0, &size);
+    if (code) {
+        return code;
+    }
+    long long limbs = bits / 32;
+    int rest = bits % 32;
+    int count = (size.count > limbs) ? (size.count - limbs) : 0;
+    code = new_number(count, shifted);
+    if (code) {
+        free(size.limbs);
+        return code;
+    }
+    for (int i = 0; i < count; i++) {
+        uint64_t pair = size.limbs[i + limbs] | ((i + limbs + 1 < size.count) ? (uint64_t) size.limbs[i + limbs + 1] << 32 : 0);
+        shifted -> limbs[i] = (uint32_t) (pair >> rest);
+    }
+    free(size.limbs);
+    normalize(shifted);
+    if (number -> negative) {
+        big_number rounded;
+        code = add_small(shifted, 1, &rounded);
+        if (code) {
+            free(shifted -> limbs);
+            return code;
+        }
+        free(shifted -> limbs);
+        *shifted = rounded;
+        shifted -> negative = true;
+    }
+    return 0;
+}
+
+
+/**
+ * \brief Writes a number in two's complement, over a given number of limbs.
+ * \param [in] number Pointer to the number.
+ * \param [inout] bits Pointer to where to store the limbs (count of them).
+ * \param [in] count The number of limbs to write, which must leave room for the sign bit.
+ */
+static void twos_complement(const big_number * number, uint32_t * bits, int count) {
+    // a negative number is written as its size inverted, plus 1
+    uint64_t carry = 1;
+    for (int i = 0; i < count; i++) {
+        uint32_t limb = (i < number -> count) ? number -> limbs[i] : 0;
+        if (number -> negative) {
+            carry += (uint32_t) ~limb;
+            bits[i] = (uint32_t) carry;
+            carry >>= 32;
+        } else {
+            bits[i] = limb;
+        }
+    }
+}
+
+
+/**
+ * \brief Applies a bitwise operator to two numbers, as though both were in two's complement.
+ * \param [in] opcode The token representing the operation (B_AND, B_OR, or B_XOR).
+ * \param [in] left Pointer to the first number.
+ * \param [in] right Pointer to the second number.
+ * \param [inout] combined Pointer to where to store the result, in memory of its own.
+ * \return 0 if the operation was done; NUMBER_TOO_BIG or NUMBER_NO_MEMORY if it could not be.
+ */
+static int combine_bits(lexemes opcode, const big_number * left, const big_number * right, big_number * combined) {
+    int count = ((left -> count > right -> count) ? left -> count : right -> count) + 1;
+    uint32_t * other = (uint32_t *) malloc(count * sizeof(uint32_t));
+    if (!other) {
+        return NUMBER_NO_MEMORY;
+    }
+    int code = new_number(count, combined);
+    if (code) {
+        free(other);
+        return code;
+    }
+    twos_complement(left, combined -> limbs, count);
+    twos_complement(right, other, count);
+    for (int i = 0; i < count; i++) {
+        if (opcode == B_AND) {
+            combined -> limbs[i] &= other[i];
+        } else if (opcode == B_OR) {
+            combined -> limbs[i] |= other[i];
+        } else {
+            combined -> limbs[i] ^= other[i];
+        }
+    }
+    free(other);
+    // the top bit gives the sign of the result, and negating a negative result gives back its size
+    combined -> negative = (combined -> limbs[count - 1] >> 31);
+    twos_complement(combined, combined -> limbs, count);
+    normalize(combined);
+    return 0;
+}
+
+
+/**
+ * \brief Fetches a numerical value that is used as a count (an exponent or a shift), if it fits in an int.
+ * \param [in] value Pointer to the numerical value.
+ * \param [inout] count Pointer to where to store the count.
+ * \return True if the value fits in an int; false otherwise.
+ */
+static bool count_of(const literal_value * value, int * count) {
+    if (is_object(value)) {
+        return false;
+    }
+    *count = (type_of(value) == NUMBER_VALUE) ? number_of(value) : (type_of(value) == TRUE_VALUE);
+    return true;
+}
+
+
+/**
+ * \brief Creates the value of a number literal from its digits, in the word if it fits in an int.
+ * \param [in] text The digits of the number (which need not be null-terminated).
+ * \param [in] length The number of digits.
+ * \param [inout] value Pointer to where to store the number's value.
+ * \return 0 if the number was created; 1 if it is too big or memory ran out (which has been reported).
+ */
+int parse_number(const char * text, int length, literal_value * value) {
+    // most literals are short enough that they cannot overflow an int
+    if (length <= DIGITS_PER_LIMB) {
+        int number = 0;
+        for (int i = 0; i < length; i++) {
+            // multiply current number by 10, then add the latest digit into the ones column
+            number = (10 * number) + (text[i] - '0');
+        }
+        *value = make_number(number);
+        return 0;
+    }
+    // otherwise the digits are taken 9 at a time, multiplying what is there by 10^9 and adding them in
+    big_number number;
+    int code = new_number(length / DIGITS_PER_LIMB + 2, &number);
+    if (code) {
+        return number_error(code);
+    }
+    number.count = 0;
+    for (int start = 0; start < length; start += DIGITS_PER_LIMB) {
+        int end = (start + DIGITS_PER_LIMB < length) ? (start + DIGITS_PER_LIMB) : length;
+        uint32_t scale = 1;
+        uint32_t chunk = 0;
+        for (int i = start; i < end; i++) {
+            scale *= 10;
+            chunk = (10 * chunk) + (text[i] - '0');
+        }
+        uint64_t carry = chunk;
+        for (int i = 0; i < number.count; i++) {
+            carry += (uint64_t) number.limbs[i] * scale;
+            number.limbs[i] = (uint32_t) carry;
+            carry >>= 32;
+        }
+        if (carry) {
+            number.limbs[number.count++] = (uint32_t) carry;
+        }
+    }
+    return give_result(&number, value);
+}
+
+
+/**
+ * \brief Compares two numerical values of any size.
+ * \param [in] left Pointer to the first value.
+ * \param [in] right Pointer to the second value.
+ * \return A negative value, 0, or a positive value if the first is smaller, equal, or bigger.
+ */
+int compare_numbers(const literal_value * left, const literal_value * right) {
+    uint32_t left_scratch;
+    uint32_t right_scratch;
+    big_number a;
+    big_number b;
+    view_number(left, &left_scratch, &a);
+    view_number(right, &right_scratch, &b);
+    int left_sign = a.count ? (a.negative ? -1 : 1) : 0;
+    int right_sign = b.count ? (b.negative ? -1 : 1) : 0;
+    if (left_sign != right_sign) {
+        return (left_sign < right_sign) ? -1 : 1;
+    }
+    return a.negative ? -compare_sizes(&a, &b) : compare_sizes(&a, &b);
+}
+
+
+/**
+ * \brief Applies a binary operator to numerical operands of any size, for when an int is not enough.
+ * \param [in] opcode The token representing the operation to complete.
+ * \param [in] left Pointer to the value of the first operand.
+ * \param [in] right Pointer to the value of the second operand.
+ * \param [inout] result Pointer to where to store the computed value.
+ * \return 0 if the operation succeeded; non-zero value if an error occurred.
+ */
+int big_binary(lexemes opcode, const literal_value * left, const literal_value * right, literal_value * result) {
+    // a failed operation still leaves a value behind, which holds nothing that needs releasing
+    *result = make_none();
+    uint32_t left_scratch;
+    uint32_t right_scratch;
+    big_number a;
+    big_number b;
+    view_number(left, &left_scratch, &a);
+    view_number(right, &right_scratch, &b);
+    big_number answer;
+    int count = 0;
+    int return_code = 0;
+
+    switch (opcode) {
+        case PLUS:
+            return_code = add_numbers(&a, &b, &answer);
+            break;
+
+        case MINUS:
+            b.negative = !b.negative;
+            return_code = add_numbers(&a, &b, &answer);
+            break;
+
+        case STAR:
+            return_code = multiply_numbers(&a, &b, &answer);
+            break;
+
+        // / rounds toward zero, // rounds down, and % adds the divisor to a remainder left when the signs differ
+        case SLASH:
+        case D_SLASH:
+        case PERCENT: {
+            if (!b.count) {
+                report_error(ZERODIVISION, (opcode == SLASH) ? "division by zero" : "integer division or modulo by zero");
+                return 1;
+            }
+            big_number remainder;
+            return_code = divide_numbers(&a, &b, &answer, &remainder);
+            if (return_code) {
+                break;
+            }
+            bool opposite = a.count && (a.negative != b.negative);
+            big_number adjusted;
+            if ((opcode == D_SLASH) && opposite && remainder.count) {
+                return_code = add_small(&answer, -1, &adjusted);
+                free(answer.limbs);
+                answer = adjusted;
+            } else if (opcode == PERCENT) {
+                free(answer.limbs);
+                if (opposite && remainder.count) {
+                    return_code = add_numbers(&remainder, &b, &adjusted);
+                    answer = adjusted;
+                } else {
+                    return_code = add_small(&remainder, 0, &answer);
+                }
+            }
+            free(remainder.limbs);
+            break;
+        }
+
+        case D_STAR:
+            // negative exponents produce fractions, which round to 0 here (no floating point numbers)
+            if (is_negative(right)) {
+                if (!a.count) {
+                    report_error(ZERODIVISION, "0 cannot be raised to a negative power");
+                    return 1;
+                }
+                *result = make_number(0);
+                return 0;
+            }
+            // only 0, 1, and -1 can be raised to a power that does not fit in an int
+            if (!count_of(right, &count)) {
+                if ((a.count > 1) || ((a.count == 1) && (a.limbs[0] > 1))) {
+                    return_code = NUMBER_TOO_BIG;
+                    break;
+                }
+                count = 2 + (((number_object *) object_of(right)) -> limbs[0] & 1);
+            }
+            return_code = raise_number(&a, count, &answer);
+            break;
+
+        case B_SLL:
+        case B_SAR:
+            if (is_negative(right)) {
+                report_error(VALUE, "negative shift count");
+                return 1;
+            }
+            // a shift by more than an int's worth of bits leaves nothing, or is far too big
+            if (!count_of(right, &count)) {
+                if (opcode == B_SLL) {
+                    return_code = a.count ? NUMBER_TOO_BIG : new_number(0, &answer);
+                } else {
+                    *result = make_number(a.negative ? -1 : 0);
+                    return 0;
+                }
+            } else {
+                return_code = (opcode == B_SLL) ? shift_up(&a, count, &answer) : shift_down(&a, count, &answer);
+            }
+            break;
+
+        case B_AND:
+        case B_OR:
+        case B_XOR:
+            return_code = combine_bits(opcode, &a, &b, &answer);
+            break;
+
+        // an int is never the same object as a bool, even if they are equal
+        case EQUAL:
+        case IS:
+            *result = make_bool((compare_numbers(left, right) == 0) && ((opcode == EQUAL) || (type_of(left) == type_of(right))));
+            return 0;
+        case N_EQUAL:
+        case ISNOT:
+            *result = make_bool((compare_numbers(left, right) != 0) || ((opcode == ISNOT) && (type_of(left) != type_of(right))));
+            return 0;
+        case GREATER:
+            *result = make_bool(compare_numbers(left, right) > 0);
+            return 0;
+        case G_EQUAL:
+            *result = make_bool(compare_numbers(left, right) >= 0);
+            return 0;
+        case LESS:
+            *result = make_bool(compare_numbers(left, right) < 0);
+            return 0;
+        case L_EQUAL:
+            *result = make_bool(compare_numbers(left, right) <= 0);
+            return 0;
+
+        // theoretically unreachable
+        default:
+            report_failure("no such binary operator exists");
+            return 1;
+    }
+    if (return_code) {
+        return number_error(return_code);
+    }
+    return give_result(&answer, result);
+}
+
+
+/**
+ * \brief Applies a unary operator to a numerical operand of any size, for when an int is not enough.
+ * \param [in] opcode The token representing the operation to complete.
+ * \param [in] right Pointer to the value of the operand.
+ * \param [inout] result Pointer to where to store the computed value.
+ * \return 0 if the operation succeeded; non-zero value if an error occurred.
+ */
+int big_unary(lexemes opcode, const literal_value * right, literal_value * result) {
+    // a failed operation still leaves a value behind, which holds nothing that needs releasing
+    *result = make_none();
+    uint32_t scratch;
+    big_number number;
+    view_number(right, &scratch, &number);
+    big_number answer;
+    int return_code = 0;
+    switch (opcode) {
+        // ~n is -n - 1
+        case B_NOT:
+            number.negative = !number.negative;
+            return_code = add_small(&number, -1, &answer);
+            break;
+        case MINUS:
+            return_code = copy_number(&number, true, &answer);
+            break;
+        // theoretically unreachable
+        default:
+            report_failure("no such unary operator exists");
+            return 1;
+    }
+    if (return_code) {
+        return number_error(return_code);
+    }
+    return give_result(&answer, result);
+}
+
+
+/**
+ * \brief Writes out the digits of a number of any size, in base 10.
+ * \param [in] value Pointer to a numerical value.
+ * \return Pointer to the digits (with a leading '-' if negative, null-terminated, to be freed by the caller); NULL if memory ran out.
+ */
+char * number_text(const literal_value * value) {
+    uint32_t scratch;
+    big_number number;
+    view_number(value, &scratch, &number);
+    // each limb gives fewer than 10 digits, so this is always enough room
+    char * text = (char *) malloc(10 * (size_t) number.count + 3);
+    big_number rest;
+    if (!text || copy_number(&number, false, &rest)) {
+        free(text);
+        return NULL;
+    }
+    // the digits come out 9 at a time from the least significant, so they are written from the back
+    size_t end = 10 * (size_t) number.count + 2;
+    size_t start = end;
+    text[end] = '\0';
+    do {
+        uint64_t remainder = 0;
+        for (int i = rest.count - 1; i >= 0; i--) {
+            remainder = (remainder << 32) | rest.limbs[i];
+            rest.limbs[i] = (uint32_t) (remainder / DIGITS_BASE);
+            remainder %= DIGITS_BASE;
+        }
+        normalize(&rest);
+        // every group but the most significant keeps its leading zeros
+        for (int i = 0; (i < DIGITS_PER_LIMB) && (rest.count || remainder || (i == 0)); i++) {
+            text[--start] = '0' + (remainder % 10);
+            remainder /= 10;
+        }
+    } while (rest.count);
+    if (number.negative) {
+        text[--start] = '-';
+    }
+    memmove(text, text + start, end - start + 1);
+    free(rest.limbs);
+    return text;
+}
@@ -0,0 +1,268 @@
+/*********************************************************************************
+* Description: A cache of recently compiled commands (so repeated commands skip lexing, parsing, and compiling)
+* Author(s): Isaac Joffe
+* Copyright: University of Alberta, 2024
+* License: CC-BY-4.0
+*********************************************************************************/
+
+
+#include <cstdlib>
+#include <cstring>
+#include "cache.h"
+#include "chunk.h"
+#include "table.h"
+
+
+/** Commands are found by the hash of their text, and then compared in full so that a different command is never run.
+    Compiled bytecode refers to variables only by the slots the resolver gave them, and slots are never reused.
+    So bytecode stays correct for as long as the interpreter runs, and a command never needs to be compiled twice.
+    The commands are also kept in a list from most to least recently used, and the last one is forgotten when the cache is full.
+    A cached command holds a reference to each of its constants, since the syntax tree they came from is soon cleared.
+*/
+
+
+/**
+ * \brief Finds the bucket that a hash belongs to.
+ * \param [in] cache Pointer to the cache of interest.
+ * \param [in] hash The hash of some text.
+ * \return The index of the bucket.
+ */
+static int bucket_of(const command_cache * cache, unsigned int hash) {
+    // the number of buckets is a power of 2, so masking is the same as taking the remainder
+    return hash & (cache -> num_buckets - 1);
+}
+
+
+/**
+ * \brief Finds the command compiled from some text.
+ * \param [in] cache Pointer to the cache to search.
+ * \param [in] text The text of the command.
+ * \param [in] length The number of characters in the text.
+ * \param [in] hash The hash of the text.
+ * \return The index of the command; NO_COMMAND if it is not in the cache.
+ */
+static int find_command(const command_cache * cache, const char * text, int length, unsigned int hash) {
+    int index = cache -> buckets[bucket_of(cache, hash)];
+    while (index != NO_COMMAND) {
+        const cached_command * entry = &(cache -> entries[index]);
+        if ((entry -> hash == hash) && (entry -> length == length) && (memcmp(entry -> text, text, length) == 0)) {
+            return index;
+        }
+        index = entry -> next_in_bucket;
+    }
+    return NO_COMMAND;
+}
+
+
+/**
+ * \brief Takes a command out of the list of commands in order of use.
+ * \param [inout] cache Pointer to the cache holding the command.
+ * \param [in] index The index of the command.
+ */
+static void unlink_use(command_cache * cache, int index) {
+    cached_command * entry = &(cache -> entries[index]);
+    if (entry -> older != NO_COMMAND) {
+        cache -> entries[entry -> older].newer = entry -> newer;
+    } else {
+        cache -> oldest = entry -> newer;
+    }
+    if (entry -> newer != NO_COMMAND) {
+        cache -> entries[entry -> newer].older = entry -> older;
+    } else {
+        cache -> newest = entry -> older;
+    }
+}
+
+
+/**
+ * \brief Puts a command at the front of the list of commands in order of use.
+ * \param [inout] cache Pointer to the cache holding the command.
+ * \param [in] index The index of the command.
+ */
+static void mark_newest(command_cache * cache, int index) {
+    cached_command * entry = &(cache -> entries[index]);
+    entry -> older = cache -> newest;
+    entry -> newer = NO_COMMAND;
+    if (cache -> newest != NO_COMMAND) {
+        cache -> entries[cache -> newest].newer = index;
+    } else {
+        cache -> oldest = index;
+    }
+    cache -> newest = index;
+}
+
+
+/**
+ * \brief Takes a command out of the bucket it was found in.
+ * \param [inout] cache Pointer to the cache holding the command.
+ * \param [in] index The index of the command.
+ */
+static void unlink_bucket(command_cache * cache, int index) {
+    int * link = &(cache -> buckets[bucket_of(cache, cache -> entries[index].hash)]);
+    while (*link != index) {
+        link = &(cache -> entries[*link].next_in_bucket);
+    }
+    *link = cache -> entries[index].next_in_bucket;
+}
+
+
+/**
+ * \brief Drops the references a cached command holds to its constants, and releases the block it was stored in.
+ * \param [inout] entry Pointer to the command to forget.
+ */
+static void forget_command(cached_command * entry) {
+    for (int i = 0; i < (entry -> constant_count); i++) {
+        release(&(entry -> constants[i]));
+    }
+    // each command's constants start the one block it was stored in
+    free(entry -> constants);
+}
+
+
+/**
+ * \brief Fetches the compiled form of a command, if it is in the cache, marking it as the most recently used.
+ * \param [inout] cache Pointer to the cache to search.
+ * \param [in] text The text of the command (which need not be null-terminated).
+ * \param [in] length The number of characters in the text.
+ * \param [inout] output Pointer to where to store the command's bytecode.
+ * \return 0 if the command was found; 1 otherwise.
+ */
+int cache_lookup(command_cache * cache, const char * text, int length, chunk * output) {
+    int index = NO_COMMAND;
+    if (cache -> count > 0) {
+        index = find_command(cache, text, length, hash_string(text, length));
+    }
+    if (index == NO_COMMAND) {
+        cache -> misses++;
+        return 1;
+    }
+    cache -> hits++;
+    unlink_use(cache, index);
+    mark_newest(cache, index);
+    // the bytecode is run straight from the cache, borrowed rather than copied (so it is never freed by the caller)
+    const cached_command * entry = &(cache -> entries[index]);
+    output -> code = entry -> code;
+    output -> constants = entry -> constants;
+    output -> code_count = entry -> code_count;
+    output -> constant_count = entry -> constant_count;
+    output -> code_capacity = 0;
+    output -> constant_capacity = 0;
+    return 0;
+}
+
+
+/**
+ * \brief Stores the compiled form of a command, forgetting the least recently used one if the cache is full.
+ * \param [inout] cache Pointer to the cache to store into.
+ * \param [in] text The text of the command (which need not be null-terminated).
+ * \param [in] length The number of characters in the text.
+ * \param [in] code Pointer to the command's bytecode.
+ * \return 0 if the command was stored (or caching is turned off); 1 if memory ran out.
+ */
+int cache_insert(command_cache * cache, const char * text, int length, const chunk * code) {
+    if (cache -> capacity <= 0) {
+        return 0;
+    }
+    // make room for every command there may be, the first time one is stored
+    if (!(cache -> entries)) {
+        int num_buckets = 1;
+        while (num_buckets < (cache -> capacity)) {
+            num_buckets *= 2;
+        }
+        cache -> entries = (cached_command *) malloc(cache -> capacity * sizeof(cached_command));
+        cache -> buckets = (int *) malloc(num_buckets * sizeof(int));
+        if (!(cache -> entries) || !(cache -> buckets)) {
+            free(cache -> entries);
+            free(cache -> buckets);
+            cache -> entries = NULL;
+            cache -> buckets = NULL;
+            return 1;
+        }
+        for (int i = 0; i < num_buckets; i++) {
+            cache -> buckets[i] = NO_COMMAND;
+        }
+        cache -> num_buckets = num_buckets;
+    }
+    // the constants, code, and text share one block, with the constants first so that they are aligned
+    size_t constants_size = code -> constant_count * sizeof(literal_value);
+    char * block = (char *) malloc(constants_size + code -> code_count + length);
+    if (!block) {
+        return 1;
+    }
+    // a full cache forgets the command that has gone unused the longest, and reuses its entry
+    int index = cache -> count;
+    if (cache -> count >= cache -> capacity) {
+        index = cache -> oldest;
+        unlink_use(cache, index);
+        unlink_bucket(cache, index);
+        forget_command(&(cache -> entries[index]));
+    } else {
+        cache -> count++;
+    }
+    cached_command * entry = &(cache -> entries[index]);
+    entry -> constants = (literal_value *) block;
+    entry -> code = (unsigned char *) (block + constants_size);
+    entry -> text = block + constants_size + code -> code_count;
+    for (int i = 0; i < (code -> constant_count); i++) {
+        entry -> constants[i] = code -> constants[i];
+        retain(&(entry -> constants[i]));
+    }
+    memcpy(entry -> code, code -> code, code -> code_count);
+    memcpy(entry -> text, text, length);
+    entry -> constant_count = code -> constant_count;
+    entry -> code_count = code -> code_count;
+    entry -> length = length;
+    entry -> hash = hash_string(text, length);
+    // the command goes at the front of its bucket, and of the order of use
+    int bucket = bucket_of(cache, entry -> hash);
+    entry -> next_in_bucket = cache -> buckets[bucket];
+    cache -> buckets[bucket] = index;
+    mark_newest(cache, index);
+    return 0;
+}
+
+
+/**
+ * \brief Forgets every command stored and releases the memory used by a cache, keeping its size and counts.
+ * \param [inout] cache Pointer to the cache to empty.
+ */
+static void empty_cache(command_cache * cache) {
+    for (int i = 0; i < (cache -> count); i++) {
+        forget_command(&(cache -> entries[i]));
+    }
+    free(cache -> entries);
+    free(cache -> buckets);
+    cache -> entries = NULL;
+    cache -> buckets = NULL;
+    cache -> num_buckets = 0;
+    cache -> count = 0;
+    cache -> newest = NO_COMMAND;
+    cache -> oldest = NO_COMMAND;
+}
+
+
+/**
+ * \brief Changes the number of commands the cache may hold, forgetting every one stored.
+ * \param [inout] cache Pointer to the cache to resize.
+ * \param [in] capacity The most commands to keep (0 turns caching off).
+ * \return 0 if the size was changed; 1 if it is negative.
+ */
+int set_cache_size(command_cache * cache, int capacity) {
+    if (capacity < 0) {
+        return 1;
+    }
+    empty_cache(cache);
+    cache -> capacity = capacity;
+    return 0;
+}
+
+
+/**
+ * \brief Releases the memory used by a cache, leaving it empty with its counts reset.
+ * \param [inout] cache Pointer to the cache to free.
+ */
+void free_cache(command_cache * cache) {
+    empty_cache(cache);
+    cache -> hits = 0;
+    cache -> misses = 0;
+}
@@ -0,0 +1,155 @@
+/*********************************************************************************
+* Description: Defines the bytecode format produced by the compiler
+* Author(s): Isaac Joffe
+* Copyright: University of Alberta, 2024
+* License: CC-BY-4.0
+*********************************************************************************/
+
+
+#include <cstdio>
+#include <cstdlib>
+#include "chunk.h"
+#include "lexer.h"
+#include "tree.h"
+
+
+/** Much of this code is based on Crafting Interpreters by Robert Nystrom.
+    Specifically, this file takes inspiration mostly from these chapters:
+      * Chapter 14 (https://craftinginterpreters.com/chunks-of-bytecode.html)
+    A chunk grows as it is written, doubling its room each time it runs out, so no command is too long to compile.
+    A chunk fetched from the cache refers to the cache's own memory instead, and is never written to or freed.
+*/
+
+
+/**
+ * \brief Adds a byte of bytecode to the end of a chunk, making more room if it is full.
+ * \param [inout] code Pointer to the chunk to write to.
+ * \param [in] byte The instruction or operand to add.
+ * \return 0 if the byte was added; 1 if memory ran out.
+ */
+int write_code(chunk * code, unsigned char byte) {
+    if (code -> code_count >= code -> code_capacity) {
+        int capacity = code -> code_capacity ? (2 * code -> code_capacity) : MIN_CODE_LEN;
+        unsigned char * resized = (unsigned char *) realloc(code -> code, capacity);
+        if (!resized) {
+            return 1;
+        }
+        code -> code = resized;
+        code -> code_capacity = capacity;
+    }
+    code -> code[code -> code_count] = byte;
+    code -> code_count++;
+    return 0;
+}
+
+
+/**
+ * \brief Adds a value to the end of a chunk's list of constants, making more room if it is full.
+ * \param [inout] code Pointer to the chunk to write to.
+ * \param [in] value The value to add (whose reference is not taken).
+ * \return 0 if the value was added; 1 if memory ran out.
+ */
+int write_constant(chunk * code, literal_value value) {
+    if (code -> constant_count >= code -> constant_capacity) {
+        int capacity = code -> constant_capacity ? (2 * code -> constant_capacity) : MIN_NUM_CONSTANTS;
+        literal_value * resized = (literal_value *) realloc(code -> constants, capacity * sizeof(literal_value));
+        if (!resized) {
+            return 1;
+        }
+        code -> constants = resized;
+        code -> constant_capacity = capacity;
+    }
+    code -> constants[code -> constant_count] = value;
+    code -> constant_count++;
+    return 0;
+}
+
+
+/**
+ * \brief Releases the memory used by a chunk, leaving it empty (a chunk fetched from the cache owns none).
+ * \param [inout] code Pointer to the chunk to free.
+ */
+void free_chunk(chunk * code) {
+    if (code -> code_capacity) {
+        free(code -> code);
+    }
+    if (code -> constant_capacity) {
+        free(code -> constants);
+    }
+    code -> code = NULL;
+    code -> constants = NULL;
+    code -> code_count = 0;
+    code -> constant_count = 0;
+    code -> code_capacity = 0;
+    code -> constant_capacity = 0;
+}
+
+
+/**
+ * \brief Prints a readable listing of the bytecode for debugging.
+ * \param [in] code Pointer to the bytecode to print.
+ */
+void print_chunk(chunk * code) {
+    int offset = 0;
+    while (offset < (code -> code_count)) {
+        unsigned char instruction = code -> code[offset];
+        printf("%04d %s", offset, opcode_names[instruction]);
+        switch (instruction) {
+            // instructions that refer to a constant
+            case OP_CONSTANT:
+                printf(" ");
+                print_value(&(code -> constants[code -> code[offset + 1]]));
+                offset += 2;
+                break;
+            case OP_CONSTANT_LONG:
+                printf(" ");
+                print_value(&(code -> constants[(code -> code[offset + 1] << 16) | (code -> code[offset + 2] << 8) | code -> code[offset + 3]]));
+                offset += 4;
+                break;
+
+            // instructions that refer to a variable's scope and slot
+            case OP_GET_VARIABLE:
+            case OP_SET_VARIABLE:
+                printf(" depth %d slot %d", code -> code[offset + 1],
+                       (code -> code[offset + 2] << 16) | (code -> code[offset + 3] << 8) | code -> code[offset + 4]);
+                offset += 5;
+                break;
+
+            // instructions that refer to an operator
+            case OP_BINARY:
+            case OP_UNARY:
+                printf(" %s", token_names[code -> code[offset + 1]]);
+                offset += 2;
+                break;
+
+            // instructions that jump forwards
+            case OP_JUMP:
+            case OP_JUMP_IF_FALSE:
+            case OP_JUMP_IF_TRUE:
+            case OP_POP_JUMP_IF_FALSE:
+                printf(" -> %04d", offset + 4 + ((code -> code[offset + 1] << 16) | (code -> code[offset + 2] << 8) | code -> code[offset + 3]));
+                offset += 4;
+                break;
+
+            // instructions that jump backwards
+            case OP_LOOP:
+                printf(" -> %04d", offset + 4 - ((code -> code[offset + 1] << 16) | (code -> code[offset + 2] << 8) | code -> code[offset + 3]));
+                offset += 4;
+                break;
+
+            // instructions that refer to a variable's scope and slot and jump forwards
+            case OP_FOR_ITER:
+                printf(" depth %d slot %d", code -> code[offset + 1],
+                       (code -> code[offset + 2] << 16) | (code -> code[offset + 3] << 8) | code -> code[offset + 4]);
+                printf(" -> %04d", offset + 8 + ((code -> code[offset + 5] << 16) | (code -> code[offset + 6] << 8) | code -> code[offset + 7]));
+                offset += 8;
+                break;
+
+            // instructions with no operands
+            default:
+                offset++;
+                break;
+        }
+        printf("\n");
+    }
+}
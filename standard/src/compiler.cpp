@@ -0,0 +1,587 @@
+/*********************************************************************************
+* Description: The compiler (lowers a syntax tree into bytecode for the virtual machine)
+* Author(s): Isaac Joffe
+* Copyright: University of Alberta, 2024
+* License: CC-BY-4.0
+*********************************************************************************/
+
+
+#include <cstdio>
+#include <cstdlib>
+#include "chunk.h"
+#include "compiler.h"
+#include "error.h"
+#include "operations.h"
+#include "tree.h"
+
+
+/** Much of this code is based on Crafting Interpreters by Robert Nystrom.
+    Specifically, this file takes inspiration mostly from these chapters:
+      * Chapter 14 (https://craftinginterpreters.com/chunks-of-bytecode.html)
+      * Chapter 17 (https://craftinginterpreters.com/compiling-expressions.html)
+      * Chapter 23 (https://craftinginterpreters.com/jumping-back-and-forth.html)
+    Unlike clox, this compiler does not parse; it walks the tree the parser already built.
+    Every expression leaves exactly one value on the stack, and every statement leaves none.
+    The bytecode grows as it is written, and jumps and constant indices take three bytes, so any command can be compiled.
+    Each loop keeps where it starts in a local while its statements compile, so loops may nest as deeply as blocks can.
+*/
+
+
+/**
+ * \brief Basic constructor for the compiler.
+ * \param [in] input Pointer to the syntax tree returned by the parser.
+ * \param [inout] output Pointer to where to store the produced bytecode.
+ */
+Compiler::Compiler(syntax_tree * input, chunk * output) {
+    tree = input;
+    bytecode = output;
+}
+
+
+/**
+ * \brief Appends a single byte to the end of the bytecode.
+ * \param [in] byte The instruction or operand to append.
+ */
+void Compiler::emit_byte(unsigned char byte) {
+    if (write_code(bytecode, byte)) {
+        // only report the problem once, no matter how much more is emitted
+        if (!error_occurred) {
+            report_failure("out of memory for bytecode");
+            error_occurred = true;
+        }
+    }
+}
+
+
+/**
+ * \brief Appends two bytes (usually an instruction and its operand) to the end of the bytecode.
+ * \param [in] first The first byte to append.
+ * \param [in] second The second byte to append.
+ */
+void Compiler::emit_bytes(unsigned char first, unsigned char second) {
+    emit_byte(first);
+    emit_byte(second);
+}
+
+
+/**
+ * \brief Appends an instruction that accesses a variable, followed by its one-byte depth and three-byte slot.
+ * \param [in] instruction The kind of variable access to append.
+ * \param [in] depth The number of scopes out that the resolver found the variable in.
+ * \param [in] slot The slot given to the variable by the resolver.
+ */
+void Compiler::emit_variable(opcodes instruction, int depth, int slot) {
+    if ((depth > 0xff) || (slot > 0xffffff)) {
+        if (!error_occurred) {
+            report_error(RUNTIME, "too many variables");
+            error_occurred = true;
+        }
+        return;
+    }
+    emit_bytes(instruction, depth);
+    emit_byte((slot >> 16) & 0xff);
+    emit_bytes((slot >> 8) & 0xff, slot & 0xff);
+}
+
+
+/**
+ * \brief Appends a three-byte operand (a jump distance or the index of a constant).
+ * \param [in] operand The operand to append (which must fit in three bytes).
+ */
+void Compiler::emit_long(int operand) {
+    if (operand > 0xffffff) {
+        if (!error_occurred) {
+            report_error(RUNTIME, "command is too long to compile");
+            error_occurred = true;
+        }
+        return;
+    }
+    emit_byte((operand >> 16) & 0xff);
+    emit_bytes((operand >> 8) & 0xff, operand & 0xff);
+}
+
+
+/**
+ * \brief Appends a jump instruction whose destination is not known yet.
+ * \param [in] instruction The kind of jump to append.
+ * \return The location of the jump's operand, to be filled in later by patch_jump().
+ */
+int Compiler::emit_jump(opcodes instruction) {
+    emit_byte(instruction);
+    // placeholder offset until the destination is compiled
+    emit_long(0);
+    return bytecode -> code_count - 3;
+}
+
+
+/**
+ * \brief Fills in the operand of an earlier jump so that it lands at the current end of the bytecode.
+ * \param [in] offset The location of the jump's operand.
+ */
+void Compiler::patch_jump(int offset) {
+    // jump is measured from just after the operand
+    int jump = bytecode -> code_count - offset - 3;
+    // nothing was written if memory ran out, in which case the bytecode is never run anyway
+    if ((jump > 0xffffff) || (offset < 0) || error_occurred) {
+        if (!error_occurred) {
+            report_error(RUNTIME, "command is too long to compile");
+            error_occurred = true;
+        }
+        return;
+    }
+    bytecode -> code[offset] = (jump >> 16) & 0xff;
+    bytecode -> code[offset + 1] = (jump >> 8) & 0xff;
+    bytecode -> code[offset + 2] = jump & 0xff;
+}
+
+
+/**
+ * \brief Appends a backwards jump to an earlier point in the bytecode.
+ * \param [in] start The location to jump back to.
+ */
+void Compiler::emit_loop(int start) {
+    emit_byte(OP_LOOP);
+    // jump is measured from just after the operand
+    emit_long(bytecode -> code_count - start + 3);
+}
+
+
+/**
+ * \brief Adds a value to the chunk's list of constants.
+ * \param [in] value The value to store.
+ * \return The index of the value in the list of constants.
+ */
+int Compiler::make_constant(literal_value value) {
+    if (write_constant(bytecode, value)) {
+        if (!error_occurred) {
+            report_failure("out of memory for bytecode");
+            error_occurred = true;
+        }
+        return 0;
+    }
+    return bytecode -> constant_count - 1;
+}
+
+
+/**
+ * \brief Remembers a break statement's jump, to be filled in once the end of its loop is known.
+ * \param [in] offset The location of the jump's operand.
+ */
+void Compiler::push_break(int offset) {
+    // make room for more break statements by doubling the space for them
+    if (num_breaks >= break_capacity) {
+        int capacity = break_capacity ? (2 * break_capacity) : MIN_NUM_BREAKS;
+        int * resized = (int *) realloc(breaks, capacity * sizeof(int));
+        if (!resized) {
+            if (!error_occurred) {
+                report_failure("out of memory for bytecode");
+                error_occurred = true;
+            }
+            return;
+        }
+        breaks = resized;
+        break_capacity = capacity;
+    }
+    breaks[num_breaks] = offset;
+    num_breaks++;
+}
+
+
+/**
+ * \brief Lands every break statement of the loop just compiled at the current end of the bytecode.
+ * \param [in] first_break The number of break statements that were already pending when the loop started.
+ */
+void Compiler::patch_breaks(int first_break) {
+    for (int i = first_break; i < num_breaks; i++) {
+        patch_jump(breaks[i]);
+    }
+    num_breaks = first_break;
+}
+
+
+/**
+ * \brief Compiles a node used as a statement, leaving nothing on the stack.
+ * \param [in] index The index of the syntax tree node to compile.
+ */
+void Compiler::compile_statement(int index) {
+    // empty statements do nothing
+    if (index == NO_NODE) {
+        return;
+    }
+    const node * tree_node = node_at(tree, index);
+    // statements produce None, which is never printed, so they need no value at all
+    switch (tree_node -> type) {
+        case ASSIGN_NODE:
+            compile_assign(&(tree_node -> entry.assign_val));
+            break;
+        case BLOCK_NODE:
+            compile_block(&(tree_node -> entry.block_val));
+            break;
+        case FORLOOP_NODE:
+            compile_forloop(&(tree_node -> entry.forloop_val));
+            break;
+        case IFELSE_NODE:
+            compile_ifelse(&(tree_node -> entry.ifelse_val));
+            break;
+        case SPECIAL_NODE:
+            compile_special(&(tree_node -> entry.special_val));
+            break;
+        case WHILELOOP_NODE:
+            compile_whileloop(&(tree_node -> entry.whileloop_val));
+            break;
+        // expressions are evaluated and then printed, like in the evaluator's blocks
+        default:
+            // a bare None (such as a missing else-branch) would print nothing anyway
+            if ((tree_node -> type == LITERAL_NODE) && (type_of(&(tree_node -> entry.literal_val)) == NONE_VALUE)) {
+                break;
+            }
+            compile_expression(index);
+            emit_byte(OP_PRINT);
+            break;
+    }
+}
+
+
+/**
+ * \brief Compiles a node used as an expression, leaving exactly one value on the stack.
+ * \param [in] index The index of the syntax tree node to compile.
+ */
+void Compiler::compile_expression(int index) {
+    // an operand is missing, so the command cannot be run
+    if (index == NO_NODE) {
+        if (!error_occurred) {
+            report_error(SYNTAX, "invalid syntax");
+            error_occurred = true;
+        }
+        return;
+    }
+    // each level of nesting can hold one value on the stack, as can each for loop's iterator
+    expression_depth++;
+    if (expression_depth + (2 * iterator_depth) >= MAX_STACK_SIZE) {
+        if (!error_occurred) {
+            report_error(RUNTIME, "expression is too deeply nested");
+            error_occurred = true;
+        }
+        expression_depth--;
+        return;
+    }
+    // call appropriate function based on the operation needed (polymorphism not possible)
+    const node * tree_node = node_at(tree, index);
+    switch (tree_node -> type) {
+        case ASSIGN_NODE:
+            // chained assignments assign None, like in the evaluator
+            compile_assign(&(tree_node -> entry.assign_val));
+            emit_byte(OP_NONE);
+            break;
+        case BINARY_NODE:
+            compile_binary(&(tree_node -> entry.binary_val));
+            break;
+        case GROUPING_NODE:
+            // just pass along result of nested expression
+            compile_expression(tree_node -> entry.grouping_val.expression);
+            break;
+        case LITERAL_NODE:
+            compile_literal(&(tree_node -> entry.literal_val));
+            break;
+        case LOGICAL_NODE:
+            compile_logical(&(tree_node -> entry.logical_val));
+            break;
+        case UNARY_NODE:
+            compile_unary(&(tree_node -> entry.unary_val));
+            break;
+        case VARIABLE_NODE:
+            compile_variable(&(tree_node -> entry.variable_val));
+            break;
+        // any other statement used as a value produces None
+        default:
+            compile_statement(index);
+            emit_byte(OP_NONE);
+            break;
+    }
+    expression_depth--;
+}
+
+
+/**
+ * \brief Compiles an assignment operation represented by a syntax tree node.
+ * \param [in] expr The internal representation of the assignment operation.
+ */
+void Compiler::compile_assign(const assign_value * expr) {
+    compile_expression(expr -> value);
+    emit_variable(OP_SET_VARIABLE, expr -> depth, expr -> slot);
+}
+
+
+/**
+ * \brief Compiles a binary arithmetic operation represented by a syntax tree node.
+ * \param [in] expr The internal representation of the binary arithmetic operation.
+ */
+void Compiler::compile_binary(const binary_value * expr) {
+    // evaluate each operand left-to-right before evaluating combination
+    compile_expression(expr -> left);
+    compile_expression(expr -> right);
+    emit_bytes(OP_BINARY, expr -> opcode);
+}
+
+
+/**
+ * \brief Compiles a block of statements represented by a syntax tree node.
+ * \param [in] expr The internal representation of the block of statements.
+ */
+void Compiler::compile_block(const block_value * expr) {
+    // compile each statement of the block in order
+    for (int i = 0; i < (expr -> count); i++) {
+        compile_statement(statement_at(tree, expr, i));
+    }
+}
+
+
+/**
+ * \brief Compiles a for loop represented by a syntax tree node.
+ * \param [in] expr The internal representation of the for loop.
+ */
+void Compiler::compile_forloop(const forloop_value * expr) {
+    // the iterable and the current position in it stay on the stack for the whole loop
+    compile_expression(expr -> expression);
+    emit_byte(OP_GET_ITER);
+    iterator_depth++;
+
+    // each iteration either moves the loop variable along or leaves the loop
+    int start = bytecode -> code_count;
+    const variable_value * variable = &(node_at(tree, expr -> variable) -> entry.variable_val);
+    emit_variable(OP_FOR_ITER, variable -> depth, variable -> slot);
+    int exit_jump = bytecode -> code_count;
+    emit_long(0);
+
+    // run the statements, then go back for the next iteration
+    int outer_start = loop_start;
+    int first_break = num_breaks;
+    loop_start = start;
+    compile_statement(expr -> statements);
+    emit_loop(start);
+    loop_start = outer_start;
+
+    // break statements land here, discard the iterator, and skip the else-block
+    int end_jump = -1;
+    if (num_breaks > first_break) {
+        patch_breaks(first_break);
+        emit_bytes(OP_POP, OP_POP);
+        end_jump = emit_jump(OP_JUMP);
+    }
+    iterator_depth--;
+
+    // execute the else-block once the iterable runs out
+    patch_jump(exit_jump);
+    compile_statement(expr -> end);
+    if (end_jump >= 0) {
+        patch_jump(end_jump);
+    }
+}
+
+
+/**
+ * \brief Compiles an if-else block represented by a syntax tree node.
+ * \param [in] expr The internal representation of the if-else block.
+ */
+void Compiler::compile_ifelse(const ifelse_value * expr) {
+    // skip to the else-branch if the condition is false
+    compile_expression(expr -> condition);
+    int else_jump = emit_jump(OP_POP_JUMP_IF_FALSE);
+    compile_statement(expr -> ifbranch);
+    // without an else-branch, there is nothing for the if-branch to skip
+    if (expr -> elsebranch == NO_NODE) {
+        patch_jump(else_jump);
+        return;
+    }
+    // the if-branch must then skip over the else-branch
+    int end_jump = emit_jump(OP_JUMP);
+    patch_jump(else_jump);
+    compile_statement(expr -> elsebranch);
+    patch_jump(end_jump);
+}
+
+
+/**
+ * \brief Compiles a literal value represented by a syntax tree node.
+ * \param [in] expr The internal representation of the literal value.
+ */
+void Compiler::compile_literal(const literal_value * expr) {
+    // sentinel values have their own instructions, so no constant is needed
+    switch (type_of(expr)) {
+        case FALSE_VALUE:
+            emit_byte(OP_FALSE);
+            break;
+        case NONE_VALUE:
+            emit_byte(OP_NONE);
+            break;
+        case TRUE_VALUE:
+            emit_byte(OP_TRUE);
+            break;
+        default: {
+            // most commands have few constants, which each take a single byte to find
+            int constant = make_constant(*expr);
+            if (constant <= 0xff) {
+                emit_bytes(OP_CONSTANT, constant);
+            } else {
+                emit_byte(OP_CONSTANT_LONG);
+                emit_long(constant);
+            }
+            break;
+        }
+    }
+}
+
+
+/**
+ * \brief Compiles a binary logical operation represented by a syntax tree node.
+ * \param [in] expr The internal representation of the binary logical operation.
+ */
+void Compiler::compile_logical(const logical_value * expr) {
+    // the left operand is the result if it decides the outcome (short-circuiting)
+    compile_expression(expr -> left);
+    int jump = 0;
+    switch (expr -> opcode) {
+        // logical and operation (and)
+        case AND:
+            jump = emit_jump(OP_JUMP_IF_FALSE);
+            break;
+        // logical or operation (or)
+        case OR:
+            jump = emit_jump(OP_JUMP_IF_TRUE);
+            break;
+        // theoretically unreachable
+        default:
+            report_failure("no such binary logical operator exists");
+            error_occurred = true;
+            return;
+    }
+    // otherwise, the result is just the right operand
+    emit_byte(OP_POP);
+    compile_expression(expr -> right);
+    patch_jump(jump);
+}
+
+
+/**
+ * \brief Compiles a special keyword represented by a syntax tree node.
+ * \param [in] expr The internal representation of the special keyword.
+ */
+void Compiler::compile_special(const special_value * expr) {
+    // the parser has already made sure break and continue only appear inside loops
+    switch (expr -> keyword) {
+        // break operation
+        case BREAK:
+            if (loop_start < 0) {
+                report_failure("break outside of loop");
+                error_occurred = true;
+                break;
+            }
+            // jump to the end of the loop once it is known
+            push_break(emit_jump(OP_JUMP));
+            break;
+
+        // continue operation
+        case CONTINUE:
+            if (loop_start < 0) {
+                report_failure("continue outside of loop");
+                error_occurred = true;
+                break;
+            }
+            // jump straight back to the loop's condition or next iteration
+            emit_loop(loop_start);
+            break;
+
+        // pass operation
+        case PASS:
+            // do nothing, as desired
+            break;
+
+        // theoretically unreachable
+        default:
+            report_failure("no such sepcial keyword exists");
+            error_occurred = true;
+            break;
+    }
+}
+
+
+/**
+ * \brief Compiles a unary operation represented by a syntax tree node.
+ * \param [in] expr The internal representation of the unary operation.
+ */
+void Compiler::compile_unary(const unary_value * expr) {
+    compile_expression(expr -> right);
+    emit_bytes(OP_UNARY, expr -> opcode);
+}
+
+
+/**
+ * \brief Compiles the reading of a variable represented by a syntax tree node.
+ * \param [in] expr The internal representation of the variable.
+ */
+void Compiler::compile_variable(const variable_value * expr) {
+    emit_variable(OP_GET_VARIABLE, expr -> depth, expr -> slot);
+}
+
+
+/**
+ * \brief Compiles a while loop represented by a syntax tree node.
+ * \param [in] expr The internal representation of the while loop.
+ */
+void Compiler::compile_whileloop(const whileloop_value * expr) {
+    // leave the loop as soon as the entry condition is false (a condition that is always true need not be checked)
+    int start = bytecode -> code_count;
+    const node * condition = node_at(tree, expr -> expression);
+    bool forever = (condition -> type == LITERAL_NODE) && boolify(&(condition -> entry.literal_val));
+    int exit_jump = -1;
+    if (!forever) {
+        compile_expression(expr -> expression);
+        exit_jump = emit_jump(OP_POP_JUMP_IF_FALSE);
+    }
+
+    // run the statements, then go back to check the condition again
+    int outer_start = loop_start;
+    int first_break = num_breaks;
+    loop_start = start;
+    compile_statement(expr -> statements);
+    emit_loop(start);
+    loop_start = outer_start;
+
+    // execute the else-block once the condition is false
+    if (exit_jump >= 0) {
+        patch_jump(exit_jump);
+        compile_statement(expr -> end);
+    }
+
+    // break statements skip the else-block entirely
+    patch_breaks(first_break);
+}
+
+
+/**
+ * \brief Tells if an error has occurred while compiling a syntax tree.
+ * \return True if an error has occurred; false otherwise.
+ */
+bool Compiler::has_error() {
+    return error_occurred;
+}
+
+
+/**
+ * \brief Compiles the input syntax tree into bytecode.
+ * \return 0 if execution succeeded; non-zero value if an error occurred.
+ */
+int Compiler::compile_input() {
+    // the whole command is a block of statements
+    compile_statement(tree -> root);
+    emit_byte(OP_RETURN);
+    // every loop has been compiled, so the space for holding their break statements is no longer needed
+    free(breaks);
+    breaks = NULL;
+    break_capacity = 0;
+    // an error at any time should stop all operations
+    if (has_error()) {
+        return 1;
+    }
+    return 0;
+}
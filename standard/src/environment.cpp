@@ -6,26 +6,22 @@
 *********************************************************************************/
 
 
-#include <cstring>
+#include <cstdlib>
 #include "environment.h"
-#include "utility.h"
+#include "symbols.h"
 
 
 /**
- * \brief Looks up the desired variable in the stored table.
+ * \brief Looks up the desired variable in the stored table of a single scope.
  * \param [inout] env Pointer to the environment to find the variable in.
- * \param [in] name The name of the variable to find.
+ * \param [in] symbol The symbol of the variable to find.
  * \return The index of the variable in the table if found; the next empty slot otherwise.
  */
-int find_variable(environment * env, char name[]) {
-    // TODO: support nested environments with recursive search
-    // check each variable being stored for a name match
-    for (int i = 0; i < (env -> num_used); i++) {
-        // check for a match of the current variable to a stored one
-        if (strcmp(env -> names[i], name) == 0) {
-            // return the index of the variable with this name
-            return i;
-        }
+int find_variable(environment * env, int symbol) {
+    // enclosing scopes are searched by the resolver, so run-time accesses never search at all
+    // symbols are small integers, so the slot is found by indexing directly
+    if ((symbol >= 0) && (symbol < (env -> num_symbols)) && (env -> slots[symbol] >= 0)) {
+        return env -> slots[symbol];
     }
     // this return value means the variable not found
     return (env -> num_used);
@@ -33,43 +29,68 @@ int find_variable(environment * env, char name[]) {
 
 
 /**
- * \brief Assigns a particular value to a variable (old or new) in the environment.
+ * \brief Gives a variable (old or new) a permanent slot in the environment.
  * \param [inout] env Pointer to the environment to store the variable in.
- * \param [in] name The name of the variable to save into.
- * \param [in] value The value to store in this variable.
+ * \param [in] symbol The symbol of the variable to find a slot for.
+ * \return The index of the variable's slot; UNRESOLVED_SLOT if memory ran out.
  */
-void write_variable(environment * env, char name[], literal_value value) {
+int declare_variable(environment * env, int symbol) {
     // determine if the variable exists and where to store it
-    int index = find_variable(env, name);
+    int index = find_variable(env, symbol);
 
-    // if variable does not yet exist, make a new one
+    // if variable does not yet exist, make a new one that holds no value yet
     if (index == (env -> num_used)) {
-        // if variable does not yet exist, make a new one
-        for (int i = 0; i < MAX_IDENTIFIER_LEN; i++) {
-            env -> names[index][i] = name[i];
+        // make room for more variables by doubling the space for them
+        if (index >= (env -> capacity)) {
+            int capacity = (env -> capacity) ? (2 * (env -> capacity)) : MIN_NUM_VAR;
+            literal_value * values = (literal_value *) realloc(env -> values, capacity * sizeof(literal_value));
+            if (!values) {
+                return UNRESOLVED_SLOT;
+            }
+            env -> values = values;
+            bool * defined = (bool *) realloc(env -> defined, capacity * sizeof(bool));
+            if (!defined) {
+                return UNRESOLVED_SLOT;
+            }
+            env -> defined = defined;
+            env -> capacity = capacity;
+        }
+        // make room in the map for every symbol handed out so far
+        if (symbol >= (env -> num_symbols)) {
+            int size = (symbol < num_symbols()) ? num_symbols() : (symbol + 1);
+            int * slots = (int *) realloc(env -> slots, size * sizeof(int));
+            if (!slots) {
+                return UNRESOLVED_SLOT;
+            }
+            for (int i = (env -> num_symbols); i < size; i++) {
+                slots[i] = UNRESOLVED_SLOT;
+            }
+            env -> slots = slots;
+            env -> num_symbols = size;
         }
-        env -> values[index] = value;
+        env -> slots[symbol] = index;
+        // the slot holds None until assigned, so that assigning can always release the old value
+        env -> values[index] = make_none();
+        env -> defined[index] = false;
         (env -> num_used)++;
-    // if the variable already exists, just update its value
-    } else {
-        env -> values[index] = value;
     }
+    return index;
 }
 
 
 /**
- * \brief Fetches the value of a particular variable in an environment.
+ * \brief Fetches the value of a particular variable in an environment by its name.
  * \param [inout] env Pointer to the environment to read the variable from.
  * \param [in] name The name of the variable to read from.
- * \param [inout] value Pointer to where to store the value held by this variable.
+ * \param [inout] value Pointer to where to store the value held by this variable (which still belongs to the variable).
  * \return 0 if the operation was successful (the variable existed); 1 otherwise.
  */
-int read_variable(environment * env, char name[], literal_value * value) {
+int read_variable(environment * env, const char name[], literal_value * value) {
     // determine if the variable exists and where it is stored
-    int index = find_variable(env, name);
+    int index = find_variable(env, find_symbol(name));
 
-    // if variable does not yet exist, return sentinel error value
-    if (index == (env -> num_used)) {
+    // if variable does not yet exist or has never been assigned, return sentinel error value
+    if ((index == (env -> num_used)) || !(env -> defined[index])) {
         return 1;
     // if the variable already exists, just fetch its value and return sentinel success value
     } else {
@@ -78,3 +99,23 @@ int read_variable(environment * env, char name[], literal_value * value) {
     }
     return 0;
 }
+
+
+/**
+ * \brief Releases the memory used by an environment, leaving it with no variables.
+ * \param [inout] env Pointer to the environment to free.
+ */
+void free_environment(environment * env) {
+    for (int i = 0; i < (env -> num_used); i++) {
+        release(&(env -> values[i]));
+    }
+    free(env -> slots);
+    free(env -> values);
+    free(env -> defined);
+    env -> slots = NULL;
+    env -> values = NULL;
+    env -> defined = NULL;
+    env -> num_symbols = 0;
+    env -> num_used = 0;
+    env -> capacity = 0;
+}
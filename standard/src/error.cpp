@@ -20,6 +20,9 @@
         IndentationError (raised when some problem occurs with improper indentation)
         TypeError (raised when an operand of an invalid type is used)
         RuntimeError (raised when some other error occurs)
+        MemoryError (raised when a value is too big to make)
+        OverflowError (raised when a number is too big to count with)
+        ValueError (raised when an operand has the right type but an invalid value)
         ZeroDivisionError (raised when there is a division by 0)
 */
 
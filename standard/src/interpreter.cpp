@@ -8,76 +8,186 @@
 
 #include <cstdio>
 #include <cstring>
+#include "cache.h"
+#include "chunk.h"
+#include "compiler.h"
+#include "error.h"
 #include "evaluator.h"
 #include "interpreter.h"
 #include "lexer.h"
+#include "optimizer.h"
 #include "parser.h"
+#include "resolver.h"
+#include "symbols.h"
 #include "utility.h"
+#include "vm.h"
 
 
 /**
  * \brief Executes a single command from start to finish.
- * \param [inout] input_ptr Pointer to where the input received is stored.
- * \param [inout] output_ptr Pointer to where to store the text to be printed.
+ * \param [in] input The text of the command (a line typed at the prompt, or part of a script).
+ * \param [in] length The number of characters in the command.
+ * \param [inout] output Pointer to where to store the text to be printed.
  * \return 0 on success; a non-zero error number on failure.
  */
-int Interpreter::interpret_command(char ** input_ptr, char ** output_ptr) {
+int Interpreter::interpret_command(const char * input, int length, output_text * output) {
     int return_code = 0;
 
-    // lex command, convert raw string into a sequence of tokens
-    lexed_command token_sequence;
-    Lexer lexer(input_ptr, &token_sequence);
-    if ((return_code = lexer.scan_input())) {
-        return 1;
+#if USE_BYTECODE_VM
+    // a command run before is run from its bytecode again, without being lexed, parsed, resolved, or compiled
+    chunk bytecode;
+    if (!cache_lookup(cache, input, length, &bytecode)) {
+        return machine.run_input(&bytecode, output) ? 1 : 0;
     }
-    // ------------------------------------------------------------------------
-    // // FOR DEBUGGING; print each token to see that lexer works
-    // printf("LEXED INFO:\n");
-    // printf("Tokens: ");
-    // for (int i = 0; i < token_sequence.token_count; i++) {
-    //     printf("%d",token_sequence.tokens[i]);
-    //     printf(" ");
-    //     printf(token_names[token_sequence.tokens[i]]);
-    //     printf(", ");
-    // }
-    // printf("\n");
-    // printf("Strings: ");
-    // for (int i = 0; i < token_sequence.str_lit_count; i++) {
-    //     printf(token_sequence.str_lits[i]);
-    //     printf(", ");
-    // }
-    // printf("\n");
-    // printf("Numbers: ");
-    // for (int i = 0; i < token_sequence.num_lit_count; i++) {
-    //     printf("%d",token_sequence.num_lits[i]);
-    //     printf(", ");
-    // }
-    // printf("\n");
-    // printf("Identifiers: ");
-    // for (int i = 0; i < token_sequence.identifier_count; i++) {
-    //     printf(token_sequence.identifiers[i]);
-    //     printf(", ");
-    // }
-    // printf("\n");
-    // ------------------------------------------------------------------------
+#endif
 
-    // parse command, convert sequence of tokens into a syntax tree
-    node * tree;
-    Parser parser(token_sequence, &tree);
+    // lex and parse command together, the parser pulling each token from the lexer only once it needs it
+    Lexer lexer(input, length);
+    // convert the sequence of tokens into a syntax tree (reusing the last one's memory)
+    clear_tree(tree);
+    Parser parser(&lexer, tree);
     if ((return_code = parser.parse_input())) {
         return 1;
     }
+#if USE_OPTIMIZER
+    // simplify command, compute whatever is known before it runs just once
+    Optimizer optimizer(tree);
+    if ((return_code = optimizer.optimize_input())) {
+        return 1;
+    }
+#endif
     // ------------------------------------------------------------------------
     // // FOR DEBUGGING; print tree to see that parser works
     // printf("PARSED INFO:\n");
-    // print_tree(*tree);
+    // print_tree(tree, tree -> root);
     // printf("\n");
+    // printf("%d nodes, %zu bytes allocated, %zu bytes reserved\n", tree -> num_nodes, tree -> memory.bytes_allocated, tree -> memory.bytes_reserved);
     // ------------------------------------------------------------------------
 
+    // resolve command, give every variable in the syntax tree the slot where it is stored
+    Resolver resolver(tree, env);
+    if ((return_code = resolver.resolve_input())) {
+        return 1;
+    }
+
+#if USE_BYTECODE_VM
+    // compile command, keeping the bytecode for the next time it is run (which is skipped if memory runs out)
+    if ((return_code = compile_tree(&bytecode))) {
+        free_chunk(&bytecode);
+        return 1;
+    }
+    cache_insert(cache, input, length, &bytecode);
+    return_code = machine.run_input(&bytecode, output);
+    // the cache keeps its own copy, so this one is no longer needed
+    free_chunk(&bytecode);
+    return return_code ? 1 : 0;
+#else
+    // run the whole command at once
+    return execute_tree(output);
+#endif
+}
+
+
+/**
+ * \brief Executes a whole script, parsing it all at once but running one top-level statement at a time.
+ * \param [in] input The text of the script (which need not be null-terminated).
+ * \param [in] length The number of characters in the script.
+ * \param [in] show_output Function to display the text each statement produces, returning non-zero on failure.
+ * \return 0 on success; a non-zero error number on failure.
+ */
+int Interpreter::interpret_script(const char * input, int length, int (*show_output)(output_text * output)) {
+    int return_code = 0;
+
+    // lex, parse, and resolve the script as one unit, so that an error anywhere stops any of it from running
+    Lexer lexer(input, length);
+    clear_tree(tree);
+    Parser parser(&lexer, tree);
+    if ((return_code = parser.parse_input())) {
+        return 1;
+    }
+    if (!(parser.parsed_all())) {
+        // error detected, a script cannot simply stop partway through
+        report_error(SYNTAX, "invalid syntax");
+        return 1;
+    }
+#if USE_OPTIMIZER
+    Optimizer optimizer(tree);
+    if ((return_code = optimizer.optimize_input())) {
+        return 1;
+    }
+#endif
+    Resolver resolver(tree, env);
+    if ((return_code = resolver.resolve_input())) {
+        return 1;
+    }
+
+    // each top-level statement runs and shows its output before the next, just as if it were typed at the prompt
+    const block_value * program = &(node_at(tree, tree -> root) -> entry.block_val);
+    // stores the output to be printed, reusing the same memory for every statement
+    output_text output;
+    for (int i = 0; (i < (program -> count)) && !return_code; i++) {
+        // run the statement as a block of its own, which is what a single command would be
+        node statement = make_new_block(program -> first + i, 1);
+        if ((tree -> root = add_node(tree, &statement)) == NO_NODE) {
+            report_failure("out of memory for syntax tree");
+            return_code = 1;
+        } else if (!(return_code = execute_tree(&output))) {
+            return_code = show_output(&output);
+        }
+    }
+    free_output(&output);
+    return return_code ? 1 : 0;
+}
+
+
+/**
+ * \brief Executes the part of the syntax tree at its root, which has already been resolved.
+ * \param [inout] output Pointer to where to store the text to be printed.
+ * \return 0 on success; a non-zero error number on failure.
+ */
+int Interpreter::execute_tree(output_text * output) {
+    int return_code = 0;
+
+#if USE_BYTECODE_VM
+    // compile command, convert syntax tree into a flat sequence of instructions
+    chunk bytecode;
+    if ((return_code = compile_tree(&bytecode))) {
+        free_chunk(&bytecode);
+        return 1;
+    }
+
+    // execute command, run the instructions to produce a result
+    return_code = machine.run_input(&bytecode, output);
+    free_chunk(&bytecode);
+    if (return_code) {
+        return 1;
+    }
+#else
     // evaluate command, convert syntax tree into a result
-    if ((return_code = evaluator.evaluate_input(tree, output_ptr))) {
+    if ((return_code = evaluator.evaluate_input(tree, output))) {
         return 1;
     }
+#endif
+
+    return 0;
+}
+
 
+/**
+ * \brief Compiles the part of the syntax tree at its root, which has already been resolved.
+ * \param [inout] bytecode Pointer to where to store the produced bytecode.
+ * \return 0 on success; a non-zero error number on failure.
+ */
+int Interpreter::compile_tree(chunk * bytecode) {
+    // convert syntax tree into a flat sequence of instructions
+    Compiler compiler(tree, bytecode);
+    if (compiler.compile_input()) {
+        return 1;
+    }
+    // ------------------------------------------------------------------------
+    // // FOR DEBUGGING; print bytecode to see that compiler works
+    // printf("COMPILED INFO:\n");
+    // print_chunk(bytecode);
+    // ------------------------------------------------------------------------
     return 0;
 }
@@ -10,6 +10,7 @@
 #include <cstring>
 #include "error.h"
 #include "lexer.h"
+#include "symbols.h"
 #include "utility.h"
 
 
@@ -20,22 +21,87 @@
 */
 
 
+/** Keywords are recognized with a perfect hash, which sends every keyword to a slot of its own in a small table.
+    The hash only looks at an identifier's length and its first, second, and last characters, so it never loops.
+    (A one-character identifier has no second character, so its first is used again rather than reading past it.)
+    The table is built from the list below at compile time, and the build fails if two keywords ever share a slot.
+*/
+
+
+// a keyword padded with null characters, so that where it ends can be checked without knowing its length
+struct keyword_entry {
+    char name[MAX_KEYWORD_LEN + 1];
+    lexemes type;
+};
+
+// every reserved keyword of the language
+static constexpr keyword_entry keywords[] = {
+    {"and", AND}, {"as", AS}, {"assert", ASSERT}, {"async", ASYNC}, {"await", AWAIT}, {"break", BREAK},
+    {"class", CLASS}, {"continue", CONTINUE}, {"def", DEF}, {"del", DEL}, {"elif", ELIF}, {"else", ELSE},
+    {"except", EXCEPT}, {"False", FALSE}, {"finally", FINALLY}, {"for", FOR}, {"from", FROM}, {"global", GLOBAL},
+    {"if", IF}, {"import", IMPORT}, {"in", IN}, {"is", IS}, {"lambda", LAMBDA}, {"None", NONE},
+    {"nonlocal", NONLOCAL}, {"not", NOT}, {"or", OR}, {"pass", PASS}, {"raise", RAISE}, {"return", RETURN},
+    {"True", TRUE}, {"try", TRY}, {"while", WHILE}, {"with", WITH}, {"yield", YIELD},
+};
+
+// every keyword stored in the slot its hash gives
+struct keyword_table {
+    keyword_entry slots[KEYWORD_TABLE_SIZE];
+    bool perfect;
+};
+
+
 /**
- * \brief Basic constructor for the lexer.
- * \param [inout] input Pointer to the input string entered by the user.
- * \param [inout] output Pointer to the location to store information about the lexed command.
+ * \brief Hashes a possible keyword into a slot of the keyword table.
+ * \param [in] name The characters of the word, which are only read up to its end.
+ * \param [in] length The number of characters in the word (at least one).
+ * \return The index of the slot for the word.
  */
-Lexer::Lexer(char ** input, lexed_command * output) {
-    // transfer input string into object
-    for (int i = 0; i < MAX_INPUT_LEN; i++) {
-        line[i] = *(*input + i);
-    }
-    // get the number of non-null characters in the command
-    while (*(*input + length) != '\0') {
-        length++;
+static constexpr int hash_keyword(const char * name, int length) {
+    return ((4 * (unsigned char) name[0]) + (11 * (unsigned char) name[length > 1]) + (9 * (unsigned char) name[length - 1]) + (2 * length)) &
+           (KEYWORD_TABLE_SIZE - 1);
+}
+
+
+/**
+ * \brief Places each keyword in the slot its hash gives, noting whether any two of them collide.
+ * \return The filled keyword table.
+ */
+static constexpr keyword_table build_keyword_table() {
+    keyword_table table = {};
+    table.perfect = true;
+    for (const keyword_entry & keyword : keywords) {
+        int length = 0;
+        while (keyword.name[length]) {
+            length++;
+        }
+        int slot = hash_keyword(keyword.name, length);
+        if (table.slots[slot].type != EMPTY) {
+            table.perfect = false;
+        }
+        table.slots[slot] = keyword;
     }
-    // store where to save the final output to
-    command_info = output;
+    return table;
+}
+
+
+// the keyword table, filled in entirely by the compiler
+static constexpr keyword_table keyword_slots = build_keyword_table();
+static_assert(keyword_slots.perfect, "two keywords hash to the same slot, so the keyword hash must be changed");
+
+
+/**
+ * \brief Basic constructor for the lexer.
+ * \param [in] input The input string to lex (which need not be null-terminated), and must outlive the lexer.
+ * \param [in] input_length The number of characters in the input.
+ */
+Lexer::Lexer(const char * input, int input_length) {
+    // tokens are scanned straight from the input string, only as the parser asks for them
+    line = input;
+    // never read past the end of the command, since the input may go on to hold others
+    length = input_length;
+    // the outermost level of the input is not indented at all
+    indents[0] = 0;
 }
 
 
@@ -43,13 +109,6 @@ Lexer::Lexer(char ** input, lexed_command * output) {
  * \brief Reads the next character in the input and creates a corresponding token.
  */
 void Lexer::scan_next_token() {
-    // to store string and number literals as well as identifiers
-    char str_lit[MAX_LIT_LEN] = "";
-    char * str_lit_ptr = (char *) str_lit;
-    int num_lit = 0;
-    char identifier[MAX_IDENTIFIER_LEN] = "";
-    char * identifier_ptr = (char *) identifier;
-
     // look at the current character in the string
     char current_char = line[current];
     // printf("Character: \'%c\'\n", current_char);
@@ -59,21 +118,27 @@ void Lexer::scan_next_token() {
         case '(':
             // approach: just add token no matter what
             add_token(L_PAREN);
+            bracket_depth++;
             break;
         case ')':
             add_token(R_PAREN);
+            bracket_depth -= (bracket_depth > 0);
             break;
         case '{':
             add_token(L_BRACE);
+            bracket_depth++;
             break;
         case '}':
             add_token(R_BRACE);
+            bracket_depth -= (bracket_depth > 0);
             break;
         case '[':
             add_token(L_BRACKET);
+            bracket_depth++;
             break;
         case ']':
             add_token(R_BRACKET);
+            bracket_depth -= (bracket_depth > 0);
             break;
         case ',':
             add_token(COMMA);
@@ -176,22 +241,32 @@ void Lexer::scan_next_token() {
             break;
         // string literals
         case '\"':
-            match_string('\"', &str_lit_ptr);
-            add_token(STRING);
-            add_str_lit(str_lit);
-            break;
-        case '\'':
-            match_string('\'', &str_lit_ptr);
+        case '\'': {
+            int start = current + 1;
+            int str_length = match_string(current_char);
             add_token(STRING);
-            add_str_lit(str_lit);
+            add_str_lit(start, str_length);
             break;
+        }
         // deal with statement spread out over multiple lines
         case '\\':
-            // TODO: allow multi-line statements to be read
+            // a backslash at the very end of a line joins it to the next one
+            if (!(next_matches('\n'))) {
+                report_error(SYNTAX, "unexpected character after line continuation character");
+                error_occurred = true;
+                return;
+            }
             break;
         // comment symbol means rest of line is discarded
         case '#':
-            return;
+            current = find_either(line, current + 1, length, '\n', '\n') - 1;
+            break;
+        // whitespace between tokens makes no token, however long it goes on for
+        case ' ':
+        case '\t':
+        case '\f':
+            current = skip_spaces(line, current + 1, length) - 1;
+            break;
         // illegal characters that can never occur in a program
         case '$':
             report_error(SYNTAX, "invalid syntax");
@@ -205,54 +280,32 @@ void Lexer::scan_next_token() {
             report_error(SYNTAX, "invalid syntax");
             error_occurred = true;
             return;
-        // testing
+        // newlines are significant, except inside brackets where the line simply goes on
         case '\n':
-            // newlines are significant, so always track them
-            add_token(NEWLINE);
-            // an if statement means we expect more input
-            if ((command_info -> tokens[0] == IF) ||
-                (command_info -> tokens[0] == FOR) ||
-                (command_info -> tokens[0] == WHILE)) {
-                // get another line of input
-                memset(line, 0, sizeof(line));
-                printf("... ");
-                gets((char *) line);
-                // if this line is blank, then it is the end of the statement
-                if (!line[0]) {
-                    add_token(NEWLINE);
-                    return;
-                }
-                // set up inpit to be parsed again
-                current = -1;
-                length = 0;
-                while (line[length] != '\0') {
-                    length++;
-                }
-                line[length] = '\n';
-                length++;
-                line[length] = '\0';
+            if (bracket_depth == 0) {
+                add_token(NEWLINE);
+                at_line_start = true;
             }
-            // printf("------------------------------\n");
-            // printf("%s", line);
-            // printf("------------------------------\n");
             break;
         // default case handles the rest (number literals, identifiers, keywords, whitespace)
         default:
             // number literal case
             if (isdigit(current_char)) {
-                match_number(&num_lit);
+                int start = current;
+                int num_length = match_number();
                 add_token(NUMBER);
-                add_num_lit(num_lit);
+                add_num_lit(start, num_length);
             // identifier and keyword case
             } else if (isalpha(current_char)) {
-                match_identifier(&identifier_ptr);
+                const char * identifier = line + current;
+                int identifier_length = match_identifier();
                 // map string read to a keyword for keyword case
-                if (lexemes keyword = iskeyword(&identifier_ptr)) {
+                if (lexemes keyword = iskeyword(identifier, identifier_length)) {
                     add_token(keyword);
                 // leave raw string for identifier case
                 } else {
                     add_token(IDENTIFIER);
-                    add_identifier(identifier);
+                    add_identifier(identifier, identifier_length);
                 }
             // all other cases
             } else {
@@ -265,46 +318,49 @@ void Lexer::scan_next_token() {
 
 
 /**
- * \brief Adds a token to the list that represents the instruction.
- * \param [in] token The lexeme to be added to the list.
+ * \brief Sets the type of the token being scanned.
+ * \param [in] token The lexeme that was found.
  */
 void Lexer::add_token(lexemes token) {
-    command_info -> tokens[command_info -> token_count] = token;
-    command_info -> token_count++;
+    scanned -> type = token;
 }
 
 
 /**
- * \brief Adds a string literal to the list for the instruction.
- * \param [in] str_lit The string literal to be added to the list.
+ * \brief Sets the value of the string literal token being scanned, as where its characters are in the input.
+ * \param [in] start The index of the literal's first character.
+ * \param [in] str_length The number of characters in the literal.
  */
-void Lexer::add_str_lit(char * str_lit) {
-    for (int i = 0; i < MAX_LIT_LEN; i++) {
-        command_info -> str_lits[command_info -> str_lit_count][i] = *(str_lit + i);
-    }
-    command_info -> str_lit_count++;
+void Lexer::add_str_lit(int start, int str_length) {
+    scanned -> value.text.start = start;
+    scanned -> value.text.length = str_length;
 }
 
 
 /**
- * \brief Adds a number literal to the list for the instruction.
- * \param [in] num_lit The number literal to be added to the list.
+ * \brief Sets the value of the number literal token being scanned, as where its digits are in the input.
+ * \param [in] start The index of the literal's first digit.
+ * \param [in] num_length The number of digits in the literal.
  */
-void Lexer::add_num_lit(int num_lit) {
-    command_info -> num_lits[command_info -> num_lit_count] = num_lit;
-    command_info -> num_lit_count++;
+void Lexer::add_num_lit(int start, int num_length) {
+    scanned -> value.text.start = start;
+    scanned -> value.text.length = num_length;
 }
 
 
 /**
- * \brief Adds an identifier to the list for the instruction.
- * \param [in] identifier The identifier to be added to the list.
+ * \brief Sets the value of the identifier token being scanned, as its symbol.
+ * \param [in] identifier The identifier that was found, within the input.
+ * \param [in] identifier_length The number of characters in the identifier.
  */
-void Lexer::add_identifier(char * identifier) {
-    for (int i = 0; i < MAX_LIT_LEN; i++) {
-        command_info -> identifiers[command_info -> identifier_count][i] = *(identifier + i);
+void Lexer::add_identifier(const char * identifier, int identifier_length) {
+    // intern the name once here so that later stages only ever handle its symbol
+    int symbol = intern_symbol(identifier, identifier_length);
+    if (symbol == NO_SYMBOL) {
+        report_failure("out of memory for identifiers");
+        error_occurred = true;
     }
-    command_info -> identifier_count++;
+    scanned -> value.symbol = symbol;
 }
 
 
@@ -335,359 +391,70 @@ bool Lexer::next_matches(char character) {
 
 
 /**
- * \brief Recovers the string literal in the instruction.
+ * \brief Finds the end of the string literal in the instruction, which is left in place.
  * \param [in] terminator The string terminator (either '"' or "'").
- * \param [inout] output_ptr Pointer to where to store the literal value.
+ * \return The number of characters in the literal, not counting its delimiters.
  */
-void Lexer::match_string(char terminator, char ** output_ptr) {
-    // make an index to track the literal's value string
-    int i = 0;
+int Lexer::match_string(char terminator) {
     // start at character after the leading delimiter
     current++;
-    // add each character to the literla that is not its terminator
-    while ((line[current] != terminator) && (i < MAX_LIT_LEN)) {
-        *(*output_ptr + i) = line[current];
-        // consider next character
-        i++;
-        current++;
-    }
+    int start = current;
+    // the literal is every character up to its terminator, never going past the end of the line (strings have no length limit)
+    current = find_either(line, current, length, terminator, '\n');
     // if we never close the string, this is an error
-    if (line[current] != terminator) {
+    if (end_reached() || (line[current] != terminator)) {
         report_error(SYNTAX, "EOL while scanning string literal");
         error_occurred = true;
     }
+    return current - start;
 }
 
 
 /**
- * \brief Recovers the number literal in the instruction.
- * \param [inout] output_ptr Pointer to where to store the literal value.
+ * \brief Finds the end of the number literal in the instruction, which is left in place.
+ * \return The number of digits in the literal.
  */
-void Lexer::match_number(int * output_ptr) {
-    // track the number string to be parsed
-    char num_str[MAX_LIT_LEN] = "";
-    char * num_str_ptr = (char *) num_str;
-    // add all numerical characters to a cumulative string
-    int i = 0;
-    while (isdigit(line[current]) && (i < MAX_LIT_LEN)) {
-        *(num_str_ptr + i) = line[current];
-        i++;
-        current++;
-    }
-    // retreat since we looked at one more than we needed to
-    current--;
-    // convert string to integer and save into output parameter
-    *output_ptr = stoi(&num_str_ptr, MAX_LIT_LEN);
+int Lexer::match_number() {
+    // find every numerical character of the number (numbers have no size limit, so neither do their literals)
+    int end = skip_digits(line, current, length);
+    int num_length = end - current;
+    // stop on the last digit, since the caller moves past it
+    current = end - 1;
+    return num_length;
 }
 
 
 /**
- * \brief Recovers the name of an identifier used in the instruction.
- * \param [inout] output_ptr Pointer to where to store the identifier name.
+ * \brief Finds the end of an identifier used in the instruction, which is left in place.
+ * \return The number of characters in the identifier.
  */
-void Lexer::match_identifier(char ** output_ptr) {
-    int i = 0;
-    // add each character to the identifier until no more eligible characters
-    while (isalphanumeric(line[current]) && (i < MAX_IDENTIFIER_LEN)) {
-        *(*output_ptr + i) = line[current];
-        // consider next character
-        i++;
-        current++;
-    }
-    // retreat since we looked at one more than we needed to
-    current--;
+int Lexer::match_identifier() {
+    // the identifier goes on until no more eligible characters (identifiers have no length limit)
+    int end = skip_alphanumerics(line, current, length);
+    int identifier_length = end - current;
+    // stop on the last character, since the caller moves past it
+    current = end - 1;
+    return identifier_length;
 }
 
 
 /**
- * \brief Determines if a string of characters is a reserved keyword.
- * \param [in] input_ptr Pointer to where the string of characters to be tested is stored.
+ * \brief Determines if an identifier is a reserved keyword, with one hash and one comparison.
+ * \param [in] identifier The identifier to be tested, where it appears in the input.
+ * \param [in] identifier_length The number of characters in the identifier.
  * \return The lexeme for the keyword of interest; EMPTY (0) otherwise.
  */
-lexemes Lexer::iskeyword(char ** input_ptr) {
-    // attempt to map the identifier to a reserved keyword
-    // initial switch statement offers considerable speedup (trie structure)
-    if (**input_ptr) {
-        switch (**input_ptr) {
-            case 'a':
-                // approach: check character-by-character for a match, ensuring the value has no extra characters
-                if (       (*(*input_ptr + 1)) && (*(*input_ptr + 1) == 'n') &&
-                           (*(*input_ptr + 2)) && (*(*input_ptr + 2) == 'd') &&
-                           !(*(*input_ptr + 3))) {
-                    return AND;
-                } else if ((*(*input_ptr + 1)) && (*(*input_ptr + 1) == 's') &&
-                           !(*(*input_ptr + 2))) {
-                    return AS;
-                } else if ((*(*input_ptr + 1)) && (*(*input_ptr + 1) == 's') &&
-                           (*(*input_ptr + 2)) && (*(*input_ptr + 2) == 'y') &&
-                           (*(*input_ptr + 3)) && (*(*input_ptr + 3) == 'n') &&
-                           (*(*input_ptr + 4)) && (*(*input_ptr + 4) == 'c') &&
-                           !(*(*input_ptr + 5))) {
-                    return ASYNC;
-                } else if ((*(*input_ptr + 1)) && (*(*input_ptr + 1) == 'w') &&
-                           (*(*input_ptr + 2)) && (*(*input_ptr + 2) == 'a') &&
-                           (*(*input_ptr + 3)) && (*(*input_ptr + 3) == 'i') &&
-                           (*(*input_ptr + 4)) && (*(*input_ptr + 4) == 't') &&
-                           !(*(*input_ptr + 5))) {
-                    return AWAIT;
-                } else if ((*(*input_ptr + 1)) && (*(*input_ptr + 1) == 's') &&
-                           (*(*input_ptr + 2)) && (*(*input_ptr + 2) == 's') &&
-                           (*(*input_ptr + 3)) && (*(*input_ptr + 3) == 'e') &&
-                           (*(*input_ptr + 4)) && (*(*input_ptr + 4) == 'r') &&
-                           (*(*input_ptr + 5)) && (*(*input_ptr + 5) == 't') &&
-                           !(*(*input_ptr + 6))) {
-                    return ASSERT;
-                }
-                break;
-
-            case 'b':
-                if (       (*(*input_ptr + 1)) && (*(*input_ptr + 1) == 'r') &&
-                           (*(*input_ptr + 2)) && (*(*input_ptr + 2) == 'e') &&
-                           (*(*input_ptr + 3)) && (*(*input_ptr + 3) == 'a') &&
-                           (*(*input_ptr + 4)) && (*(*input_ptr + 4) == 'k') &&
-                           !(*(*input_ptr + 5))) {
-                    return BREAK;
-                }
-                break;
-
-            case 'c':
-                if (       (*(*input_ptr + 1)) && (*(*input_ptr + 1) == 'o') &&
-                           (*(*input_ptr + 2)) && (*(*input_ptr + 2) == 'n') &&
-                           (*(*input_ptr + 3)) && (*(*input_ptr + 3) == 't') &&
-                           (*(*input_ptr + 4)) && (*(*input_ptr + 4) == 'i') &&
-                           (*(*input_ptr + 5)) && (*(*input_ptr + 5) == 'n') &&
-                           (*(*input_ptr + 6)) && (*(*input_ptr + 6) == 'u') &&
-                           (*(*input_ptr + 7)) && (*(*input_ptr + 7) == 'e') &&
-                           !(*(*input_ptr + 8))) {
-                    return CONTINUE;
-                } else if ((*(*input_ptr + 1)) && (*(*input_ptr + 1) == 'l') &&
-                           (*(*input_ptr + 2)) && (*(*input_ptr + 2) == 'a') &&
-                           (*(*input_ptr + 3)) && (*(*input_ptr + 3) == 's') &&
-                           (*(*input_ptr + 4)) && (*(*input_ptr + 4) == 's') &&
-                           !(*(*input_ptr + 5))) {
-                    return CLASS;
-                }
-                break;
-
-            case 'd':
-                if (       (*(*input_ptr + 1)) && (*(*input_ptr + 1) == 'e') &&
-                           (*(*input_ptr + 2)) && (*(*input_ptr + 2) == 'f') &&
-                           !(*(*input_ptr + 3))) {
-                    return DEF;
-                } else if ((*(*input_ptr + 1)) && (*(*input_ptr + 1) == 'e') &&
-                           (*(*input_ptr + 2)) && (*(*input_ptr + 2) == 'l') &&
-                           !(*(*input_ptr + 3))) {
-                    return DEL;
-                }
-                break;
-
-            case 'e':
-                if (       (*(*input_ptr + 1)) && (*(*input_ptr + 1) == 'l') &&
-                           (*(*input_ptr + 2)) && (*(*input_ptr + 2) == 'i') &&
-                           (*(*input_ptr + 3)) && (*(*input_ptr + 3) == 'f') &&
-                           !(*(*input_ptr + 4))) {
-                    return ELIF;
-                } else if ((*(*input_ptr + 1)) && (*(*input_ptr + 1) == 'l') &&
-                           (*(*input_ptr + 2)) && (*(*input_ptr + 2) == 's') &&
-                           (*(*input_ptr + 3)) && (*(*input_ptr + 3) == 'e') &&
-                           !(*(*input_ptr + 4))) {
-                    return ELSE;
-                } else if ((*(*input_ptr + 1)) && (*(*input_ptr + 1) == 'x') &&
-                           (*(*input_ptr + 2)) && (*(*input_ptr + 2) == 'c') &&
-                           (*(*input_ptr + 3)) && (*(*input_ptr + 3) == 'e') &&
-                           (*(*input_ptr + 4)) && (*(*input_ptr + 4) == 'p') &&
-                           (*(*input_ptr + 5)) && (*(*input_ptr + 5) == 't') &&
-                           !(*(*input_ptr + 6))) {
-                    return EXCEPT;
-                }
-                break;
-
-            case 'f':
-                if (       (*(*input_ptr + 1)) && (*(*input_ptr + 1) == 'o') &&
-                           (*(*input_ptr + 2)) && (*(*input_ptr + 2) == 'r') &&
-                           !(*(*input_ptr + 3))) {
-                    return FOR;
-                } else if ((*(*input_ptr + 1)) && (*(*input_ptr + 1) == 'i') &&
-                           (*(*input_ptr + 2)) && (*(*input_ptr + 2) == 'n') &&
-                           (*(*input_ptr + 3)) && (*(*input_ptr + 3) == 'a') &&
-                           (*(*input_ptr + 4)) && (*(*input_ptr + 4) == 'l') &&
-                           (*(*input_ptr + 5)) && (*(*input_ptr + 5) == 'l') &&
-                           (*(*input_ptr + 6)) && (*(*input_ptr + 6) == 'y') &&
-                           !(*(*input_ptr + 7))) {
-                    return FINALLY;
-                } else if ((*(*input_ptr + 1)) && (*(*input_ptr + 1) == 'r') &&
-                           (*(*input_ptr + 2)) && (*(*input_ptr + 2) == 'o') &&
-                           (*(*input_ptr + 3)) && (*(*input_ptr + 3) == 'm') &&
-                           !(*(*input_ptr + 4))) {
-                    return FROM;
-                }
-                break;
-
-            case 'g':
-                if (       (*(*input_ptr + 1)) && (*(*input_ptr + 1) == 'l') &&
-                           (*(*input_ptr + 2)) && (*(*input_ptr + 2) == 'o') &&
-                           (*(*input_ptr + 3)) && (*(*input_ptr + 3) == 'b') &&
-                           (*(*input_ptr + 4)) && (*(*input_ptr + 4) == 'a') &&
-                           (*(*input_ptr + 5)) && (*(*input_ptr + 5) == 'l') &&
-                           !(*(*input_ptr + 6))) {
-                    return GLOBAL;
-                }
-                break;
-
-            case 'i':
-                if (       (*(*input_ptr + 1)) && (*(*input_ptr + 1) == 's') &&
-                           !(*(*input_ptr + 2))) {
-                    return IS;
-                } else if ((*(*input_ptr + 1)) && (*(*input_ptr + 1) == 'f') &&
-                           !(*(*input_ptr + 2))) {
-                    return IF;
-                } else if ((*(*input_ptr + 1)) && (*(*input_ptr + 1) == 'n') &&
-                           !(*(*input_ptr + 2))) {
-                    if (command_info -> tokens[command_info -> token_count - 1] == NOT) {
-                        (command_info -> token_count)--;
-                        return NOTIN;
-                    } else {
-                        return IN;
-                    }
-                } else if ((*(*input_ptr + 1)) && (*(*input_ptr + 1) == 'm') &&
-                           (*(*input_ptr + 2)) && (*(*input_ptr + 2) == 'p') &&
-                           (*(*input_ptr + 3)) && (*(*input_ptr + 3) == 'o') &&
-                           (*(*input_ptr + 4)) && (*(*input_ptr + 4) == 'r') &&
-                           (*(*input_ptr + 5)) && (*(*input_ptr + 5) == 't') &&
-                           !(*(*input_ptr + 6))) {
-                    return IMPORT;
-                }
-                break;
-
-            case 'l':
-                if (       (*(*input_ptr + 1)) && (*(*input_ptr + 1) == 'a') &&
-                           (*(*input_ptr + 2)) && (*(*input_ptr + 2) == 'm') &&
-                           (*(*input_ptr + 3)) && (*(*input_ptr + 3) == 'b') &&
-                           (*(*input_ptr + 4)) && (*(*input_ptr + 4) == 'd') &&
-                           (*(*input_ptr + 5)) && (*(*input_ptr + 5) == 'a') &&
-                           !(*(*input_ptr + 6))) {
-                    return LAMBDA;
-                }
-                break;
-
-            case 'n':
-                if (       (*(*input_ptr + 1)) && (*(*input_ptr + 1) == 'o') &&
-                           (*(*input_ptr + 2)) && (*(*input_ptr + 2) == 't') &&
-                           !(*(*input_ptr + 3))) {
-                    if (command_info -> tokens[command_info -> token_count - 1] == IS) {
-                        (command_info -> token_count)--;
-                        return ISNOT;
-                    } else {
-                        return NOT;
-                    }
-                } else if ((*(*input_ptr + 1)) && (*(*input_ptr + 1) == 'o') &&
-                           (*(*input_ptr + 2)) && (*(*input_ptr + 2) == 'n') &&
-                           (*(*input_ptr + 3)) && (*(*input_ptr + 3) == 'l') &&
-                           (*(*input_ptr + 4)) && (*(*input_ptr + 4) == 'o') &&
-                           (*(*input_ptr + 5)) && (*(*input_ptr + 5) == 'c') &&
-                           (*(*input_ptr + 6)) && (*(*input_ptr + 6) == 'a') &&
-                           (*(*input_ptr + 7)) && (*(*input_ptr + 7) == 'l') &&
-                           !(*(*input_ptr + 8))) {
-                    return NONLOCAL;
-                }
-                break;
-
-            case 'o':
-                if (       (*(*input_ptr + 1)) && (*(*input_ptr + 1) == 'r') &&
-                           !(*(*input_ptr + 2))) {
-                    return OR;
-                }
-                break;
-
-            case 'p':
-                if (       (*(*input_ptr + 1)) && (*(*input_ptr + 1) == 'a') &&
-                           (*(*input_ptr + 2)) && (*(*input_ptr + 2) == 's') &&
-                           (*(*input_ptr + 3)) && (*(*input_ptr + 3) == 's') &&
-                           !(*(*input_ptr + 4))) {
-                    return PASS;
-                }
-                break;
-
-            case 'r':
-                if (       (*(*input_ptr + 1)) && (*(*input_ptr + 1) == 'e') &&
-                           (*(*input_ptr + 2)) && (*(*input_ptr + 2) == 't') &&
-                           (*(*input_ptr + 3)) && (*(*input_ptr + 3) == 'u') &&
-                           (*(*input_ptr + 4)) && (*(*input_ptr + 4) == 'r') &&
-                           (*(*input_ptr + 5)) && (*(*input_ptr + 5) == 'n') &&
-                           !(*(*input_ptr + 6))) {
-                    return RETURN;
-                } else if ((*(*input_ptr + 1)) && (*(*input_ptr + 1) == 'a') &&
-                           (*(*input_ptr + 2)) && (*(*input_ptr + 2) == 'i') &&
-                           (*(*input_ptr + 3)) && (*(*input_ptr + 3) == 's') &&
-                           (*(*input_ptr + 4)) && (*(*input_ptr + 4) == 'e') &&
-                           !(*(*input_ptr + 5))) {
-                    return RAISE;
-                }
-                break;
-
-            case 't':
-                if (       (*(*input_ptr + 1)) && (*(*input_ptr + 1) == 'r') &&
-                           (*(*input_ptr + 2)) && (*(*input_ptr + 2) == 'y') &&
-                           !(*(*input_ptr + 3))) {
-                    return TRY;
-                }
-                break;
-
-            case 'w':
-                if (       (*(*input_ptr + 1)) && (*(*input_ptr + 1) == 'h') &&
-                           (*(*input_ptr + 2)) && (*(*input_ptr + 2) == 'i') &&
-                           (*(*input_ptr + 3)) && (*(*input_ptr + 3) == 'l') &&
-                           (*(*input_ptr + 4)) && (*(*input_ptr + 4) == 'e') &&
-                           !(*(*input_ptr + 5))) {
-                    return WHILE;
-                } else if ((*(*input_ptr + 1)) && (*(*input_ptr + 1) == 'i') &&
-                           (*(*input_ptr + 2)) && (*(*input_ptr + 2) == 't') &&
-                           (*(*input_ptr + 3)) && (*(*input_ptr + 3) == 'h') &&
-                           !(*(*input_ptr + 4))) {
-                    return WITH;
-                }
-                break;
-
-            case 'y':
-                if (       (*(*input_ptr + 1)) && (*(*input_ptr + 1) == 'i') &&
-                           (*(*input_ptr + 2)) && (*(*input_ptr + 2) == 'e') &&
-                           (*(*input_ptr + 3)) && (*(*input_ptr + 3) == 'l') &&
-                           (*(*input_ptr + 4)) && (*(*input_ptr + 4) == 'd') &&
-                           !(*(*input_ptr + 5))) {
-                    return YIELD;
-                }
-                break;
-
-            case 'F':
-                if (       (*(*input_ptr + 1)) && (*(*input_ptr + 1) == 'a') &&
-                           (*(*input_ptr + 2)) && (*(*input_ptr + 2) == 'l') &&
-                           (*(*input_ptr + 3)) && (*(*input_ptr + 3) == 's') &&
-                           (*(*input_ptr + 4)) && (*(*input_ptr + 4) == 'e') &&
-                           !(*(*input_ptr + 5))) {
-                    return FALSE;
-                }
-                break;
-
-            case 'N':
-                if (       (*(*input_ptr + 1)) && (*(*input_ptr + 1) == 'o') &&
-                           (*(*input_ptr + 2)) && (*(*input_ptr + 2) == 'n') &&
-                           (*(*input_ptr + 3)) && (*(*input_ptr + 3) == 'e') &&
-                           !(*(*input_ptr + 4))) {
-                    return NONE;
-                }
-                break;
-                
-            case 'T':
-                if (       (*(*input_ptr + 1)) && (*(*input_ptr + 1) == 'r') &&
-                           (*(*input_ptr + 2)) && (*(*input_ptr + 2) == 'u') &&
-                           (*(*input_ptr + 3)) && (*(*input_ptr + 3) == 'e') &&
-                           !(*(*input_ptr + 4))) {
-                    return TRUE;
-                }
-                break;
-        }
+lexemes Lexer::iskeyword(const char * identifier, int identifier_length) {
+    // no keyword is any longer, which also keeps the hash within the identifier
+    if (identifier_length > MAX_KEYWORD_LEN) {
+        return EMPTY;
+    }
+    // the only keyword the identifier could be is the one in its slot
+    const keyword_entry * candidate = &(keyword_slots.slots[hash_keyword(identifier, identifier_length)]);
+    // the keyword is padded with null characters, so it must also end exactly where the identifier does
+    if ((memcmp(identifier, candidate -> name, identifier_length) == 0) && !(candidate -> name[identifier_length])) {
+        return candidate -> type;
     }
-    // not a keyword, like returning false
     return EMPTY;
 }
 
@@ -711,17 +478,142 @@ bool Lexer::has_error() {
 
 
 /**
- * \brief Scans the input string and returns a list of its tokens.
- * \return 0 if execution succeeded; non-zero value if an error occurred.
+ * \brief Finds the characters of a string or number literal token, which are left in the input rather than copied.
+ * \param [in] token Pointer to the token, which must have come from this lexer.
+ * \return Pointer to the first character of the literal (which is not null-terminated).
  */
-int Lexer::scan_input() {
-    // keep on reading next character until command is over
-    while (!(end_reached())) {
+const char * Lexer::text_of(const lexed_token * token) {
+    return line + token -> value.text.start;
+}
+
+
+/**
+ * \brief Reads characters from the input until they make up a whole token.
+ * \param [inout] output Pointer to where to store the token read (EMPTY if the input is over).
+ */
+void Lexer::scan_raw_token(lexed_token * output) {
+    scanned = output;
+    scanned -> type = EMPTY;
+    // every block found to have ended gets its own DEDENT token
+    if (pending_dedents > 0) {
+        pending_dedents--;
+        add_token(DEDENT);
+        return;
+    }
+    // the indentation of a new line decides which block it belongs to
+    if (at_line_start) {
+        scan_indentation();
+        if (has_error() || (scanned -> type != EMPTY)) {
+            return;
+        }
+    }
+    // whitespace and comments make no token, so keep going until a character does
+    while (!(end_reached()) && (scanned -> type == EMPTY)) {
         scan_next_token();
         // a syntax error at any time should stop all operations
         if (has_error()) {
-            return 1;
+            return;
+        }
+    }
+    // the end of the input ends its last line, and then every block still open
+    if (scanned -> type == EMPTY) {
+        if (!at_line_start) {
+            add_token(NEWLINE);
+            at_line_start = true;
+        } else if (indent_depth > 0) {
+            indent_depth--;
+            add_token(DEDENT);
+        }
+    }
+}
+
+
+/**
+ * \brief Measures the indentation at the start of a line, creating an INDENT or DEDENT token if it changes.
+ */
+void Lexer::scan_indentation() {
+    while (!(end_reached())) {
+        // count the columns before the first character, with tabs moving to the next tab stop
+        int column = 0;
+        while (!(end_reached()) && ((line[current] == ' ') || (line[current] == '\t') || (line[current] == '\f'))) {
+            if (line[current] == ' ') {
+                column++;
+            } else if (line[current] == '\t') {
+                column = (column / TAB_SIZE + 1) * TAB_SIZE;
+            } else {
+                column = 0;
+            }
+            current++;
         }
+        // lines that are blank or hold only a comment have no effect on indentation
+        if (!(end_reached()) && (line[current] == '#')) {
+            while (!(end_reached()) && (line[current] != '\n')) {
+                current++;
+            }
+        }
+        if (end_reached()) {
+            return;
+        }
+        if (line[current] == '\n') {
+            current++;
+            continue;
+        }
+        at_line_start = false;
+        // indenting further opens exactly one new block
+        if (column > indents[indent_depth]) {
+            if ((indent_depth + 1) >= MAX_INDENT_DEPTH) {
+                report_error(INDENTATION, "too many levels of indentation");
+                error_occurred = true;
+                return;
+            }
+            indent_depth++;
+            indents[indent_depth] = column;
+            add_token(INDENT);
+        // indenting less closes every block indented further, but must return to the level of an open one
+        } else if (column < indents[indent_depth]) {
+            while ((indent_depth > 0) && (column < indents[indent_depth])) {
+                indent_depth--;
+                pending_dedents++;
+            }
+            if (column != indents[indent_depth]) {
+                report_error(INDENTATION, "unindent does not match any outer indentation level");
+                error_occurred = true;
+                return;
+            }
+            pending_dedents--;
+            add_token(DEDENT);
+        }
+        return;
+    }
+}
+
+
+/**
+ * \brief Scans the next token of the input string, only reading as far as needed.
+ * \param [inout] output Pointer to where to store the token read (EMPTY if the input is over).
+ * \return 0 if execution succeeded; non-zero value if an error occurred.
+ */
+int Lexer::scan_token(lexed_token * output) {
+    // hand out the token that was read ahead before any new one
+    if (has_lookahead) {
+        *output = lookahead;
+        has_lookahead = false;
+    } else {
+        scan_raw_token(output);
+    }
+    // "is not" and "not in" are single operators, so read one token ahead to see if they are spelled out
+    if (!has_error() && ((output -> type == IS) || (output -> type == NOT))) {
+        scan_raw_token(&lookahead);
+        if ((output -> type == IS) && (lookahead.type == NOT)) {
+            output -> type = ISNOT;
+        } else if ((output -> type == NOT) && (lookahead.type == IN)) {
+            output -> type = NOTIN;
+        } else {
+            has_lookahead = true;
+        }
+    }
+    if (has_error()) {
+        return 1;
     }
     return 0;
 }
@@ -6,30 +6,28 @@
 *********************************************************************************/
 
 
+#include <climits>
 #include <cstdio>
+#include <cstdlib>
 #include <cstring>
 #include "error.h"
 #include "evaluator.h"
 #include "interpreter.h"
 #include "lexer.h"
 #include "parser.h"
+#include "source.h"
 #include "tree.h"
 #include "utility.h"
 
 
-// the maximum number of characters in a line of input
-#ifndef MAX_INPUT_LEN
-#define MAX_INPUT_LEN 64
+// the number of characters read from the input at a time (a longer line just takes more reads)
+#ifndef INPUT_PIECE_LEN
+#define INPUT_PIECE_LEN 64
 #endif
 
-// the maximum number of tokens in a line of input
-#ifndef MAX_INPUT_TOKENS
-#define MAX_INPUT_TOKENS 64
-#endif
-
-// the maximum number of characters in a line of output
-#ifndef MAX_OUTPUT_LEN
-#define MAX_OUTPUT_LEN 256
+// the number of characters there is room for in a command at first, before growing
+#ifndef MIN_COMMAND_LEN
+#define MIN_COMMAND_LEN 256
 #endif
 
 
@@ -40,45 +38,170 @@
 
 
 /**
- * \brief Reads in a line (until a '\n' character) of input.
- * \param [inout] input_ptr Pointer to where to store the input received.
+ * \brief Adds a line of input to the end of a command, making more room for the command if needed.
+ * \param [inout] input_ptr Pointer to where the command is stored (may be moved to make room).
+ * \param [inout] capacity_ptr Pointer to the number of characters there is room for in the command.
+ * \param [inout] length_ptr Pointer to the number of characters already in the command.
+ * \param [in] line The line of input to add.
  * \return 0 on success; a non-zero error number on failure.
  */
-int read(char ** input_ptr) {
+int append_line(char ** input_ptr, int * capacity_ptr, int * length_ptr, const char * line) {
+    int line_length = strlen(line);
+    // make room for more characters by doubling the space for them
+    if (*length_ptr + line_length + 1 > *capacity_ptr) {
+        int capacity = *capacity_ptr ? (2 * *capacity_ptr) : MIN_COMMAND_LEN;
+        while (*length_ptr + line_length + 1 > capacity) {
+            capacity *= 2;
+        }
+        char * resized = (char *) realloc(*input_ptr, capacity);
+        if (!resized) {
+            report_failure("out of memory for input");
+            return 1;
+        }
+        *input_ptr = resized;
+        *capacity_ptr = capacity;
+    }
+    memcpy(*input_ptr + *length_ptr, line, line_length + 1);
+    *length_ptr += line_length;
+    return 0;
+}
+
+
+/**
+ * \brief Reads one whole line of input, however long, onto the end of a command, always ending it with a '\n' character.
+ * \param [inout] input_ptr Pointer to where the command is stored (may be moved to make room).
+ * \param [inout] capacity_ptr Pointer to the number of characters there is room for in the command.
+ * \param [inout] length_ptr Pointer to the number of characters already in the command.
+ * \return 0 if a line was read; 1 if the input had already ended; 2 if memory ran out.
+ */
+int read_line(char ** input_ptr, int * capacity_ptr, int * length_ptr) {
+    char piece[INPUT_PIECE_LEN];
+    bool anything_read = false;
+    // keep reading pieces until one holds the end of the line
+    while (fgets(piece, sizeof(piece), stdin)) {
+        anything_read = true;
+        if (append_line(input_ptr, capacity_ptr, length_ptr, piece)) {
+            return 2;
+        }
+        if ((*length_ptr > 0) && ((*input_ptr)[*length_ptr - 1] == '\n')) {
+            return 0;
+        }
+    }
+    if (!anything_read) {
+        return 1;
+    }
+    // the last line of the input need not have a newline, but every command must be terminated by one
+    return append_line(input_ptr, capacity_ptr, length_ptr, "\n") ? 2 : 0;
+}
+
+
+/**
+ * \brief Determines if a line of input starts a compound statement, which goes on over later lines.
+ * \param [in] line The line of input to check (which need not be null-terminated).
+ * \param [in] length The number of characters in the line.
+ * \return True if the line begins with "if", "for", or "while"; false otherwise.
+ */
+bool starts_block(const char * line, size_t length) {
+    const char * const keywords[] = {"if", "for", "while"};
+    // skip any whitespace before the first word
+    size_t start = 0;
+    while ((start < length) && ((line[start] == ' ') || (line[start] == '\t'))) {
+        start++;
+    }
+    for (int i = 0; i < 3; i++) {
+        size_t keyword_length = strlen(keywords[i]);
+        // the whole first word must be the keyword
+        if ((start + keyword_length <= length) && (strncmp(line + start, keywords[i], keyword_length) == 0) &&
+            ((start + keyword_length == length) || !isalphanumeric(line[start + keyword_length]))) {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+/**
+ * \brief Finds where a script asks to exit, which is at a line holding only "exit()" just as at the prompt.
+ * \param [in] text The text of the script.
+ * \param [in] length The number of characters in the script.
+ * \return The number of characters of the script to run, which is all of them if it never exits.
+ */
+size_t find_script_end(const char * text, size_t length) {
+    size_t position = 0;
+    while (position < length) {
+        const char * line_end = (const char *) memchr(text + position, '\n', length - position);
+        size_t line_length = line_end ? (line_end - (text + position)) : (length - position);
+        if ((line_length == 6) && (strncmp(text + position, "exit()", 6) == 0)) {
+            return position;
+        }
+        position += line_length + 1;
+    }
+    return length;
+}
+
+
+/**
+ * \brief Reads in a command, which is one line (until a '\n' character) or a compound statement ended by a blank line.
+ * \param [inout] input_ptr Pointer to where to store the input received (may be moved to make room).
+ * \param [inout] capacity_ptr Pointer to the number of characters there is room for in the input.
+ * \return 0 on success; a non-zero error number on failure.
+ */
+int read(char ** input_ptr, int * capacity_ptr) {
+    int length = 0;
     // prompt user for command
     printf(">>> ");
-    // read characters until 'enter' key is hit or buffer is full
-    gets(*input_ptr);
-    strcat(*input_ptr, "\n");
+    // read characters until 'enter' key is hit, stopping at the end of input
+    if (read_line(input_ptr, capacity_ptr, &length)) {
+        return 1;
+    }
     // exit if user wants to
-    if (strcmp(*input_ptr, "exit()") == 0) {
+    if (strcmp(*input_ptr, "exit()\n") == 0) {
         return 1;
     }
+    // an if statement or loop means we expect more input, up until a blank line
+    if (starts_block(*input_ptr, length)) {
+        int line_start;
+        do {
+            // get another line of input, the end of input counting as a blank line
+            line_start = length;
+            printf("... ");
+            switch (read_line(input_ptr, capacity_ptr, &length)) {
+                case 1:
+                    if (append_line(input_ptr, capacity_ptr, &length, "\n")) {
+                        return 1;
+                    }
+                    break;
+                case 2:
+                    return 1;
+            }
+        } while ((*input_ptr)[line_start] != '\n');
+    }
     return 0;
 }
 
 
 /**
  * \brief Parses, analyzes, and executes the Python code to produce output.
- * \param [in] interpreter The interpreter to analyze and execute the command.
- * \param [inout] input_ptr Pointer to where the input received is stored.
- * \param [inout] output_ptr Pointer to where to store the text to be printed.
+ * \param [inout] interpreter Pointer to the interpreter to analyze and execute the command.
+ * \param [in] input The text of the command.
+ * \param [in] length The number of characters in the command.
+ * \param [inout] output Pointer to where to store the text to be printed.
  * \return 0 on success; a non-zero error number on failure.
  */
-int eval(Interpreter interpreter, char ** input_ptr, char ** output_ptr) {
-    return interpreter.interpret_command(input_ptr, output_ptr);
+int eval(Interpreter * interpreter, const char * input, size_t length, output_text * output) {
+    return interpreter -> interpret_command(input, length, output);
 }
 
 
 /**
  * \brief Prints some code output.
- * \param [in] output_ptr Pointer to where the text to be printed is stored.
+ * \param [in] output Pointer to where the text to be printed is stored.
  * \return 0 on success; a non-zero error number on failure.
  */
-int print(char ** output_ptr) {
-    // print the output string received
-    if (**output_ptr) {
-        printf(*output_ptr);
+int print(output_text * output) {
+    // print the output string received, exactly as it is (it may hold any characters, even '%')
+    if (output -> length) {
+        fwrite(output -> text, 1, output -> length, stdout);
     }
     return 0;
 }
@@ -86,44 +209,97 @@ int print(char ** output_ptr) {
 
 /**
  * \brief Produces the main REPL behavior of the interpreter.
+ * \param [inout] interpreter Pointer to the interpreter to execute each command with.
  * \return 0 on success; a non-zero integer on failure.
  */
-int main() {
+int repl(Interpreter * interpreter) {
     printf("\nWelcome to Python on the C3 board.\n");
 
     int return_code = 0;
     // REPL: Read-Eval-Print-Loop
-    environment env;
-    Interpreter interpreter(&env);
+    // stores the input command received, growing to fit the longest one
+    char * input_ptr = NULL;
+    int input_capacity = 0;
+    // stores the output to be printed, growing to fit the longest one
+    output_text output;
     while (true) {
-        // stores the input command received
-        char input[MAX_INPUT_LEN] = "";
-        char * input_ptr = (char *) input;
-        memset(input, 0, MAX_INPUT_LEN);
-        // stores the output to be printed
-        char output[MAX_OUTPUT_LEN] = "";
-        char * output_ptr = (char *) output;
-        memset(output, 0, MAX_OUTPUT_LEN);
-
-        // read in user input (command / code), handle sytem error
-        if ((return_code = read(&input_ptr))) {
-            report_failure("error in read()");
+        clear_output(&output);
+
+        // read in user input (command / code), stop once the user exits or input runs out
+        if ((return_code = read(&input_ptr, &input_capacity))) {
+            printf("\n");
             break;
         }
 
         // evaluate and execute input received
-        if ((return_code = eval(interpreter, &input_ptr, &output_ptr))) {
+        if ((return_code = eval(interpreter, input_ptr, strlen(input_ptr), &output))) {
             // if an error occurred, stop this command and prompt for a new one
             continue;
         }
         
         // display the correct output from this input, handle sytem error
-        if ((return_code = print(&output_ptr))) {
+        if ((return_code = print(&output))) {
             report_failure("error in print()");
             break;
         }
 
         // continue looping in this cycle
     }
+    free(input_ptr);
+    free_output(&output);
     return 0;
 }
+
+
+/**
+ * \brief Executes a whole script, without prompting, stopping at the first error.
+ * \param [inout] interpreter Pointer to the interpreter to execute the script with.
+ * \param [in] path The name of the file holding the script.
+ * \return 0 on success; a non-zero integer on failure.
+ */
+int run_script(Interpreter * interpreter, const char * path) {
+    source_file source;
+    if (map_source(path, &source)) {
+        printf("python: can't open file '%s'\n", path);
+        return 1;
+    }
+
+    // the lexer counts positions with ints, so larger scripts cannot be read
+    size_t length = find_script_end(source.text, source.length);
+    if (length > INT_MAX) {
+        report_failure("script is too long");
+        unmap_source(&source);
+        return 1;
+    }
+
+    // the script is lexed straight out of the file as one unit, with any error ending the whole script
+    int return_code = interpreter -> interpret_script(source.text, (int) length, print);
+    unmap_source(&source);
+    return return_code;
+}
+
+
+/**
+ * \brief Runs the interpreter, either on a script named on the command line or interactively.
+ * \param [in] argc The number of command-line arguments.
+ * \param [in] argv The command-line arguments, the first after the program name being the script to run.
+ * \return 0 on success; a non-zero integer on failure.
+ */
+int main(int argc, char ** argv) {
+    // the variables persist from one command to the next, however they are entered
+    environment env;
+    syntax_tree tree;
+    command_cache cache;
+    Interpreter interpreter(&env, &tree, &cache);
+    int return_code = 0;
+    if (argc > 1) {
+        return_code = run_script(&interpreter, argv[1]);
+    } else {
+        return_code = repl(&interpreter);
+    }
+    free_environment(&env);
+    free_tree(&tree);
+    free_cache(&cache);
+    free_symbols();
+    return return_code;
+}
@@ -0,0 +1,1097 @@
+/*********************************************************************************
+* Description: The semantics of Python's operators, shared by every executor
+* Author(s): Isaac Joffe and David Onchuru
+* Copyright: University of Alberta, 2024
+* License: CC-BY-4.0
+*********************************************************************************/
+
+
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include "bigint.h"
+#include "error.h"
+#include "operations.h"
+#include "utility.h"
+
+
+/** These functions define what each operator does once its operands are known.
+    Both the tree-walk evaluator and the bytecode virtual machine call into them,
+    so the two executors always agree on results and on the errors they report.
+    Binary operators are applied through a table of kernels, one for each operator and pair of operand types.
+    Numerical operands get kernels that know their types already, so adding two ints is one call and one add.
+    Every other pair of types (and every error) goes to compute_binary, which checks the types one step at a time.
+    Ints are checked for overflow as they are worked on, and any result that does not fit goes to big_binary instead.
+    Two ints held in the word have kernels of their own, which never need to check whether an operand is on the heap.
+*/
+
+
+/**
+ * \brief Determines if a literal value is legal to use in a numerical operation.
+ * \param [in] value The literal value's type to check.
+ * \return True if the literal can be used in a numerical expression; false otherwise.
+ */
+bool is_numerical(literal_types type) {
+    return ((type == FALSE_VALUE) || (type == NUMBER_VALUE) || (type == TRUE_VALUE));
+}
+
+
+/**
+ * \brief Converts a legal literal value into a number for use in a numerical operation.
+ * \param [in] value The literal value to convert.
+ * \return The integer representation of the literal.
+ */
+int numerify(const literal_value * value) {
+    switch (type_of(value)) {
+        // valid types map directly to integers
+        case FALSE_VALUE:
+            return 0;
+        case NUMBER_VALUE:
+            // numbers too big for an int are taken as the nearest int, which is as big as anything counted can be
+            if (is_object(value)) {
+                return is_negative(value) ? INT_MIN : INT_MAX;
+            }
+            return number_of(value);
+        case TRUE_VALUE:
+            return 1;
+        // strings and None are not acceptable for arithmetic operators
+        // theoretically unreachable
+        default:
+            report_failure("numerical value expected for operation");
+            return -1;
+    }
+}
+
+
+/**
+ * \brief Determines if a literal value is legal to use directly in a logical operation.
+ * \param [in] value The literal value's type to check.
+ * \return True if the literal can be used directly in a logical expression; false otherwise.
+ */
+bool is_boolean(literal_types type) {
+    return ((type == FALSE_VALUE) || (type == TRUE_VALUE));
+}
+
+
+/**
+ * \brief Converts a legal literal value into a boolean for use in a numerical operation.
+ * \param [in] value The literal value to convert.
+ * \return The boolean representation of the literal.
+ */
+bool boolify(const literal_value * value) {
+    switch (type_of(value)) {
+        case FALSE_VALUE:
+            return false;
+        case NONE_VALUE:
+            return false;
+        // number 0 is False and all others are true (numbers on the heap are never 0)
+        case NUMBER_VALUE:
+            if (!is_object(value) && (number_of(value) == 0)) {
+                return false;
+            } else {
+                return true;
+            }
+        // empty string is false and all others are true
+        case STRING_VALUE:
+            return (length_of(value) > 0);
+        case TRUE_VALUE:
+            return true;
+        // theoretically unreachable
+        default:
+            report_failure("logical value expected for operation");
+            return -1;
+    }
+}
+
+
+/**
+ * \brief Determines if a literal value is legal to iterate over in a for loop.
+ * \param [in] value The literal value's type to check.
+ * \return True if the literal can be used in a for loop; false otherwise.
+ */
+bool is_iterable(literal_types type) {
+    return (type == STRING_VALUE);
+}
+
+
+/**
+ * \brief Compares two values and determines if they are equal.
+ * \param [in] left The first value to compare.
+ * \param [in] left The second value to compare.
+ * \return True if the two values are equal; false otherwise.
+ */
+bool equals(const literal_value * left, const literal_value * right) {
+    // numerical values must be numerically equal
+    if (is_numerical(type_of(left)) && is_numerical(type_of(right))) {
+        if (is_object(left) || is_object(right)) {
+            return (compare_numbers(left, right) == 0);
+        }
+        return (numerify(left) == numerify(right));
+    // string values must have each and every character match
+    } else if ((type_of(left) == STRING_VALUE) && (type_of(right) == STRING_VALUE)) {
+        // the same string object always matches itself, and strings of different lengths or hashes never match
+        if (left -> bits == right -> bits) {
+            return true;
+        // there is only one interned string with any given characters
+        } else if (is_interned(left) && is_interned(right)) {
+            return false;
+        } else if (length_of(left) != length_of(right)) {
+            return false;
+        }
+        // hashes are only compared once both are known, since finding one reads every character anyway
+        unsigned int left_hash = ((const string_object *) object_of(left)) -> hash;
+        unsigned int right_hash = ((const string_object *) object_of(right)) -> hash;
+        if (left_hash && right_hash && (left_hash != right_hash)) {
+            return false;
+        }
+        return (memcmp(string_of(left), string_of(right), length_of(left)) == 0);
+    // if both are None, then they are equal
+    } else if ((type_of(left) == NONE_VALUE) && (type_of(right) == NONE_VALUE)) {
+        return true;
+    // values cannot possibly match
+    } else {
+        return false;
+    }
+}
+
+
+/**
+ * \brief Fetches one character of a string, as if the string ended in a null character.
+ * \param [in] value Pointer to a value holding a string.
+ * \param [in] index The position of the character (at most the length of the string).
+ * \return The character; the null character at the end of the string.
+ */
+static inline char char_at(const literal_value * value, int index) {
+    return (index < length_of(value)) ? string_of(value)[index] : '\0';
+}
+
+
+/**
+ * \brief Determines if one string appears anywhere within another.
+ * \param [in] part The string to search for.
+ * \param [in] whole The string to search through.
+ * \return True if the characters of part appear in order somewhere in whole; false otherwise.
+ */
+static bool contains(const literal_value * part, const literal_value * whole) {
+    int part_length = length_of(part);
+    const char * part_string = string_of(part);
+    const char * whole_string = string_of(whole);
+    // try every position the part could start at and still fit
+    for (int start = 0; start + part_length <= length_of(whole); start++) {
+        if (memcmp(whole_string + start, part_string, part_length) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+/**
+ * \brief Stores a new string as the result of an operation, leaving its characters to be written.
+ * \param [in] length The number of characters in the string.
+ * \param [inout] result Pointer to where to store the computed value.
+ * \return Pointer to where the characters go; NULL if the string is too long or memory ran out.
+ */
+static char * give_string(long long length, literal_value * result) {
+    // asking for too big a string is the program's mistake, not the interpreter's, so it is an ordinary error
+    char * text = (length <= MAX_STRING_LEN) ? new_string((int) length, result) : NULL;
+    if (!text) {
+        report_error(MEMORY, "string is too long to make");
+        *result = make_none();
+    }
+    return text;
+}
+
+
+/**
+ * \brief Applies a binary operator to two already-computed operands of any types, checking their types at every step.
+ * \param [in] opcode The token representing the operation to complete.
+ * \param [in] left Pointer to the value of the first operand.
+ * \param [in] right Pointer to the value of the second operand.
+ * \param [inout] result Pointer to where to store the computed value.
+ * \return 0 if the operation succeeded; non-zero value if an error occurred.
+ */
+static int compute_binary(lexemes opcode, const literal_value * left, const literal_value * right, literal_value * result) {
+    int return_code = 0;
+    // a failed operation still leaves a value behind, which holds nothing that needs releasing
+    *result = make_none();
+
+    // perform corresponding operation
+    switch (opcode) {
+        // matrix multiplication operation (@)
+        case AT:
+            // TODO: support?
+            report_error(TYPE, "unsupported operand type(s)");
+            return_code = 1;
+            break;
+
+        // bitwise and operation (&)
+        case B_AND:
+            // same as logical counterparts for boolean inputs
+            if (is_boolean(type_of(left)) && is_boolean(type_of(right))) {
+                if (boolify(left) && boolify(right)) {
+                    *result = make_bool(true);
+                } else {
+                    *result = make_bool(false);
+                }
+            // directly translates to C operator for numerical values only
+            } else if (is_numerical(type_of(left)) && is_numerical(type_of(right))) {
+                *result = make_number(numerify(left) & numerify(right));
+            } else {
+                report_error(TYPE, "unsupported operand type(s)");
+                return_code = 1;
+            }
+            break;
+
+        // bitwise or operation (|)
+        case B_OR:
+            // same as logical counterparts for boolean inputs
+            if (is_boolean(type_of(left)) && is_boolean(type_of(right))) {
+                if (boolify(left) || boolify(right)) {
+                    *result = make_bool(true);
+                } else {
+                    *result = make_bool(false);
+                }
+            // directly translates to C operator for numerical values only
+            } else if (is_numerical(type_of(left)) && is_numerical(type_of(right))) {
+                *result = make_number(numerify(left) | numerify(right));
+            } else {
+                report_error(TYPE, "unsupported operand type(s)");
+                return_code = 1;
+            }
+            break;
+
+        // bitwise arithmetic shift right operation (>>)
+        case B_SAR:
+            // directly translates to C operator for numerical values only
+            if (is_numerical(type_of(left)) && is_numerical(type_of(right))) {
+                *result = make_number(numerify(left) >> numerify(right));
+            } else {
+                report_error(TYPE, "unsupported operand type(s)");
+                return_code = 1;
+            }
+            break;
+
+        // bitwise logical shift left operation (<<)
+        case B_SLL:
+            // directly translates to C operator for numerical values only
+            if (is_numerical(type_of(left)) && is_numerical(type_of(right))) {
+                *result = make_number(numerify(left) << numerify(right));
+            } else {
+                report_error(TYPE, "unsupported operand type(s)");
+                return_code = 1;
+            }
+            break;
+
+        // bitwise exclusive or operation (^)
+        case B_XOR:
+            // same as logical counterparts for boolean inputs
+            if (is_boolean(type_of(left)) && is_boolean(type_of(right))) {
+                if (boolify(left) != boolify(right)) {
+                    *result = make_bool(true);
+                } else {
+                    *result = make_bool(false);
+                }
+            // directly translates to C operator for numerical values only
+            } else if (is_numerical(type_of(left)) && is_numerical(type_of(right))) {
+                *result = make_number(numerify(left) ^ numerify(right));
+            } else {
+                report_error(TYPE, "unsupported operand type(s)");
+                return_code = 1;
+            }
+            break;
+
+        // floor division operation (//)
+        case D_SLASH:
+            // directly translates to C operator for numerical values only
+            // identical to regular divison because only integers are allowed
+            if (is_numerical(type_of(left)) && is_numerical(type_of(right))) {
+                if (numerify(right)) {
+                    int quotient = numerify(left) / numerify(right);
+                    // account for case of one negative operand
+                    if ((((numerify(left) < 0) && (numerify(right) > 0)) ||
+                         ((numerify(left) > 0) && (numerify(right) < 0))) &&
+                        (numerify(left) % numerify(right))) {
+                        quotient--;
+                    }
+                    *result = make_number(quotient);
+                } else {
+                    report_error(ZERODIVISION, "integer division or modulo by zero");
+                    return_code = 1;
+                }
+            } else {
+                report_error(TYPE, "unsupported operand type(s)");
+                return_code = 1;
+            }
+            break;
+
+        // exponentiation operation (**)
+        case D_STAR:
+            // no access to standard library or multiplication operator, so manual computation for numerical values only
+            if (is_numerical(type_of(left)) && is_numerical(type_of(right))) {
+                // zero exponent always produces 1 as answer
+                if (numerify(right) == 0) {
+                    *result = make_number(1);
+                // compute number directly for positive exponents
+                } else if (numerify(right) > 0) {
+                    int power = numerify(left);
+                    for (int i = 1; i < numerify(right); i++) {
+                        power *= numerify(left);
+                    }
+                    *result = make_number(power);
+                // negatve exponents produce fractions, which round to 0 here (no floating point numbers)
+                } else {
+                    if (numerify(left)) {
+                        *result = make_number(0);
+                    } else {
+                        report_error(ZERODIVISION, "0 cannot be raised to a negative power");
+                        return_code = 1;
+                    }
+                }
+            } else {
+                report_error(TYPE, "unsupported operand type(s)");
+                return_code = 1;
+            }
+            break;
+
+        // equality operation (==)
+        case EQUAL:
+            // check that contained values match
+            if (equals(left, right)) {
+                *result = make_bool(true);
+            } else {
+                *result = make_bool(false);
+            }
+            break;
+        
+        // greater than operation (>)
+        case GREATER:
+            // numeric-adjacent types directly translate to C operator
+            if (is_numerical(type_of(left)) && is_numerical(type_of(right))) {
+                if (numerify(left) > numerify(right)) {
+                    *result = make_bool(true);
+                } else {
+                    *result = make_bool(false);
+                }
+            } else if ((type_of(left) == STRING_VALUE) && (type_of(right) == STRING_VALUE)) {
+                int i = 0;
+                // if one string is shorter than the other then its i is NULL; which is the smallest ASCII character
+                while ((char_at(left, i)) && (char_at(right, i)) && (char_at(left, i) == char_at(right, i))) {
+                    i++;
+                }
+                // whichever character is bigger at this point is the bigger string
+                // by bigger we mean bigger value in ASCII table
+                if (char_at(left, i) > char_at(right, i)) {
+                    *result = make_bool(true);
+                } else {
+                    *result = make_bool(false);
+                }
+            } else {
+                report_error(TYPE, "not supported between instances of");
+                return_code = 1;
+            }
+            break;
+
+        // greater than or equal to operation (>=)
+        case G_EQUAL:
+            // numeric-adjacent types directly translate to C operator
+            if (is_numerical(type_of(left)) && is_numerical(type_of(right))) {
+                if (numerify(left) >= numerify(right)) {
+                    *result = make_bool(true);
+                } else {
+                    *result = make_bool(false);
+                }
+            } else if ((type_of(left) == STRING_VALUE) && (type_of(right) == STRING_VALUE)) {
+                if (equals(left, right)) {
+                    *result = make_bool(true);
+                }
+                int i = 0;
+                // if one string is shorter than the other then its i is NULL; which is the smallest ASCII character
+                while ((char_at(left, i) && char_at(right, i)) && (char_at(left, i) == char_at(right, i))) {
+                    i++;
+                }
+                // whichever character is bigger at this point is the bigger string
+                // by bigger we mean bigger value in ASCII table
+                if (char_at(left, i) >= char_at(right, i)) {
+                    *result = make_bool(true);
+                } else {
+                    *result = make_bool(false);
+                }
+            } else {
+                report_error(TYPE, "not supported between instances of");
+                return_code = 1;
+            }
+            break;
+
+        // membership operator (in)
+        case IN:
+            // only valid for strings, just check if substring is present
+            if ((type_of(left) == STRING_VALUE) && (type_of(right) == STRING_VALUE)) {
+                // the null string is a substring of every string
+                *result = make_bool(contains(left, right));
+            } else {
+                report_error(TYPE, "argument is not iterable");
+                return_code = 1;
+            }
+            break;
+            
+        // identity operation (is)
+        case IS:
+            // check that types and contained values match
+            if ((type_of(left) == type_of(right)) && equals(left, right)) {
+                *result = make_bool(true);
+            } else {
+                *result = make_bool(false);
+            }
+            break;
+
+        // inverse identity operation (is not)
+        case ISNOT:
+            // check that types and contained values match
+            if ((type_of(left) == type_of(right)) && equals(left, right)) {
+                *result = make_bool(false);
+            } else {
+                *result = make_bool(true);
+            }
+            break;
+
+        // less than operation (<)
+        case LESS:
+            // numeric-adjacent types directly translate to C operator
+            if (is_numerical(type_of(left)) && is_numerical(type_of(right))) {
+                if (numerify(left) < numerify(right)) {
+                    *result = make_bool(true);
+                } else {
+                    *result = make_bool(false);
+                }
+            } else if ((type_of(left) == STRING_VALUE) && (type_of(right) == STRING_VALUE)) {
+                int i = 0;
+                // if one string is shorter than the other then its i is NULL; which is the smallest ASCII character
+                while ((char_at(left, i)) && (char_at(right, i)) && (char_at(left, i) == char_at(right, i))) {
+                    i++;
+                }
+                // whichever character is smaller at this point is the smaller string
+                // by smaller we mean smaller value in ASCII table
+                if (char_at(left, i) < char_at(right, i)) {
+                    *result = make_bool(true);
+                } else {
+                    *result = make_bool(false);
+                }
+            } else {
+                report_error(TYPE, "not supported between instances of");
+                return_code = 1;
+            }
+            break;
+            
+        // less than or equal to operation (<=)
+        case L_EQUAL:
+            // numeric-adjacent types directly translate to C operator
+            if (is_numerical(type_of(left)) && is_numerical(type_of(right))) {
+                if (numerify(left) <= numerify(right)) {
+                    *result = make_bool(true);
+                } else {
+                    *result = make_bool(false);
+                }
+            } else if ((type_of(left) == STRING_VALUE) && (type_of(right) == STRING_VALUE)) {
+                if (equals(left, right)) {
+                    *result = make_bool(true);
+                }
+                int i = 0;
+                // if one string is shorter than the other then its i is NULL; which is the smallest ASCII character
+                while ((char_at(left, i) && char_at(right, i)) && (char_at(left, i) == char_at(right, i))) {
+                    i++;
+                }
+                // whichever character is smaller at this point is the smaller string
+                // by smaller we mean smaller value in ASCII table
+                if (char_at(left, i) <= char_at(right, i)) {
+                    *result = make_bool(true);
+                } else {
+                    *result = make_bool(false);
+                }
+            } else {
+                report_error(TYPE, "not supported between instances of");
+                return_code = 1;
+            }
+            break;
+
+        // subtraction operation (-)
+        case MINUS:
+            // directly translates to C operator for numerical values only
+            if (is_numerical(type_of(left)) && is_numerical(type_of(right))) {
+                *result = make_number(numerify(left) - numerify(right));
+            } else {
+                report_error(TYPE, "unsupported operand type(s)");
+                return_code = 1;
+            }
+            break;
+
+        // not equals operation (!=)
+        case N_EQUAL:
+            // simple negation of the equality logic
+            if (!equals(left, right)) {
+                *result = make_bool(true);
+            } else {
+                *result = make_bool(false);
+            }
+            break;
+
+        // inverse membership operator (not in)
+        case NOTIN:
+            // only valid for strings, just check if substring is present
+            if ((type_of(left) == STRING_VALUE) && (type_of(right) == STRING_VALUE)) {
+                // the null string is a substring of every string
+                *result = make_bool(!contains(left, right));
+            } else {
+                report_error(TYPE, "argument is not iterable");
+                return_code = 1;
+            }
+            break;
+
+        // modulus operation (%)
+        case PERCENT:
+            // directly translates to C operator for numerical values only
+            if (is_numerical(type_of(left)) && is_numerical(type_of(right))) {
+                if (numerify(right)) {
+                    int remainder = numerify(left) % numerify(right);
+                    // account for case of one negative operand, unless the division is exact
+                    if ((((numerify(left) < 0) && (numerify(right) > 0)) ||
+                         ((numerify(left) > 0) && (numerify(right) < 0))) &&
+                        remainder) {
+                        remainder += numerify(right);
+                    }
+                    *result = make_number(remainder);
+                } else {
+                    report_error(ZERODIVISION, "integer division or modulo by zero");
+                    return_code = 1;
+                }
+            } else {
+                report_error(TYPE, "unsupported operand type(s)");
+                return_code = 1;
+            }
+            break;
+
+        // addition and string concatenation operation (+)
+        case PLUS:
+            // directly translates to C operator for numerical values, concatenates two strings
+            if (is_numerical(type_of(left)) && is_numerical(type_of(right))) {
+                *result = make_number(numerify(left) + numerify(right));
+            } else if ((type_of(left) == STRING_VALUE) && (type_of(right) == STRING_VALUE)) {
+                // appending to a string built up this way only copies the new characters
+                if (append_string(left, right, result)) {
+                    report_error(MEMORY, "string is too long to make");
+                    *result = make_none();
+                    return_code = 1;
+                }
+            } else {
+                report_error(TYPE, "unsupported operand type(s)");
+                return_code = 1;
+            }
+            break;
+
+        // division operator (/)
+        case SLASH:
+            // directly translates to C operator for numerical values only
+            if (is_numerical(type_of(left)) && is_numerical(type_of(right))) {
+                if (numerify(right)) {
+                    *result = make_number(numerify(left) / numerify(right));
+                } else {
+                    report_error(ZERODIVISION, "division by zero");
+                    return_code = 1;
+                }
+            } else {
+                report_error(TYPE, "unsupported operand type(s)");
+                return_code = 1;
+            }
+            break;
+
+        // multiplication and string repitition operation (+)
+        case STAR:
+            // no access to standard library or multiplication operator, so manual computation for numerical values
+            // repeats a string
+            if (is_numerical(type_of(left)) && is_numerical(type_of(right))) {
+                *result = make_number(numerify(left) * numerify(right));
+            // repeatedly concatenates a string to itself (right) number of times
+            } else if (((type_of(left) == STRING_VALUE) && is_numerical(type_of(right))) || ((type_of(right) == STRING_VALUE) && is_numerical(type_of(left)))) {
+                // fetch the multiplier and string from the correct operands
+                const literal_value * count = is_numerical(type_of(left)) ? left : right;
+                const literal_value * initial = is_numerical(type_of(left)) ? right : left;
+                // a number on the heap is far too big (or too negative) to count repetitions with
+                if (is_object(count)) {
+                    report_error(OVERFLOW, "cannot fit 'int' into an index-sized integer");
+                    return_code = 1;
+                    break;
+                }
+                int multiplier = numerify(count);
+                // edge case: user does string * (nonpositive number), giving the empty string
+                if (multiplier < 0) {
+                    multiplier = 0;
+                }
+                int initial_length = length_of(initial);
+                char * text = give_string((long long) initial_length * multiplier, result);
+                if (text && (multiplier > 0)) {
+                    // copy the string once, then double what is there until it is long enough
+                    long long total = (long long) initial_length * multiplier;
+                    long long filled = initial_length;
+                    memcpy(text, string_of(initial), initial_length);
+                    while (filled < total) {
+                        long long step = (filled < total - filled) ? filled : (total - filled);
+                        memcpy(text + filled, text, step);
+                        filled += step;
+                    }
+                } else if (!text) {
+                    return_code = 1;
+                }
+            } else {
+                report_error(TYPE, "unsupported operand type(s)");
+                return_code = 1;
+            }
+            break;
+
+        // theoretically unreachable
+        default:
+            report_failure("no such binary operator exists");
+            return_code = 1;
+            break;
+    }
+    return return_code;
+}
+
+
+/**
+ * \brief Applies a binary operator to operands of any types, for the pairs of types that have no kernel of their own.
+ * \param [in] left Pointer to the value of the first operand.
+ * \param [in] right Pointer to the value of the second operand.
+ * \param [inout] result Pointer to where to store the computed value.
+ * \return 0 if the operation succeeded; non-zero value if an error occurred.
+ */
+template <lexemes opcode>
+static int general_binary(const literal_value * left, const literal_value * right, literal_value * result) {
+    return compute_binary(opcode, left, right, result);
+}
+
+
+/**
+ * \brief Determines if a type of literal is legal to use in a numerical operation, ahead of time.
+ * \param [in] type The literal value's type to check.
+ * \return True if the type can be used in a numerical expression; false otherwise.
+ */
+static constexpr bool is_numerical_type(literal_types type) {
+    return ((type == FALSE_VALUE) || (type == NUMBER_VALUE) || (type == TRUE_VALUE));
+}
+
+
+/**
+ * \brief Determines if an operator has a kernel of its own for numerical operands of the given types.
+ * \param [in] opcode The token representing the operation.
+ * \param [in] left_type The type of the first operand.
+ * \param [in] right_type The type of the second operand.
+ * \return True if numerical_binary handles this combination; false if compute_binary must.
+ */
+static constexpr bool has_numerical_kernel(lexemes opcode, literal_types left_type, literal_types right_type) {
+    if (!is_numerical_type(left_type) || !is_numerical_type(right_type)) {
+        return false;
+    }
+    // bitwise operators on two bools give a bool, which compute_binary takes care of
+    bool booleans = (left_type != NUMBER_VALUE) && (right_type != NUMBER_VALUE);
+    switch (opcode) {
+        case B_AND:
+        case B_OR:
+        case B_XOR:
+            return !booleans;
+        case B_SAR:
+        case B_SLL:
+        case D_SLASH:
+        case D_STAR:
+        case EQUAL:
+        case GREATER:
+        case G_EQUAL:
+        case IS:
+        case ISNOT:
+        case LESS:
+        case L_EQUAL:
+        case MINUS:
+        case N_EQUAL:
+        case PERCENT:
+        case PLUS:
+        case SLASH:
+        case STAR:
+            return true;
+        // matrix multiplication and membership are errors on numbers
+        default:
+            return false;
+    }
+}
+
+
+/**
+ * \brief Converts an operand of a type known ahead of time into a number, without checking its type.
+ * \param [in] value The literal value to convert.
+ * \return The integer representation of the literal.
+ */
+template <literal_types type>
+static inline int operand_of(const literal_value * value) {
+    if constexpr (type == NUMBER_VALUE) {
+        return number_of(value);
+    } else {
+        return (type == TRUE_VALUE);
+    }
+}
+
+
+/**
+ * \brief Stores a number as the result of an operation.
+ * \param [in] number The number to store.
+ * \param [inout] result Pointer to where to store the computed value.
+ * \return 0, since the operation succeeded.
+ */
+static inline int give_number(int number, literal_value * result) {
+    *result = make_number(number);
+    return 0;
+}
+
+
+/**
+ * \brief Stores a truth value as the result of an operation.
+ * \param [in] truth The truth value to store.
+ * \param [inout] result Pointer to where to store the computed value.
+ * \return 0, since the operation succeeded.
+ */
+static inline int give_bool(bool truth, literal_value * result) {
+    *result = make_bool(truth);
+    return 0;
+}
+
+
+/**
+ * \brief Applies a binary operator to numerical operands whose types are known ahead of time.
+ * \param [in] left Pointer to the value of the first operand.
+ * \param [in] right Pointer to the value of the second operand.
+ * \param [inout] result Pointer to where to store the computed value.
+ * \return 0 if the operation succeeded; non-zero value if an error occurred.
+ */
+template <lexemes opcode, literal_types left_type, literal_types right_type, bool unboxed>
+static int numerical_binary(const literal_value * left, const literal_value * right, literal_value * result) {
+    // unless both operands are known to be held in the word, either may be a number on the heap
+    if constexpr (!unboxed && ((left_type == NUMBER_VALUE) || (right_type == NUMBER_VALUE))) {
+        if (((left_type == NUMBER_VALUE) && is_object(left)) || ((right_type == NUMBER_VALUE) && is_object(right))) {
+            return big_binary(opcode, left, right, result);
+        }
+    }
+    int a = operand_of<left_type>(left);
+    int b = operand_of<right_type>(right);
+    int number = 0;
+    // a result that overflows an int is worked out again on the heap
+    if constexpr (opcode == PLUS) {
+        return __builtin_add_overflow(a, b, &number) ? big_binary(opcode, left, right, result) : give_number(number, result);
+    } else if constexpr (opcode == MINUS) {
+        return __builtin_sub_overflow(a, b, &number) ? big_binary(opcode, left, right, result) : give_number(number, result);
+    } else if constexpr (opcode == STAR) {
+        return __builtin_mul_overflow(a, b, &number) ? big_binary(opcode, left, right, result) : give_number(number, result);
+    } else if constexpr (opcode == B_AND) {
+        return give_number(a & b, result);
+    } else if constexpr (opcode == B_OR) {
+        return give_number(a | b, result);
+    } else if constexpr (opcode == B_XOR) {
+        return give_number(a ^ b, result);
+    } else if constexpr ((opcode == B_SAR) || (opcode == B_SLL)) {
+        // a negative shift count is left to big_binary, which reports the error
+        if (b < 0) {
+            return big_binary(opcode, left, right, result);
+        }
+        // shifting right by the whole width of an int leaves only its sign
+        if constexpr (opcode == B_SAR) {
+            return give_number((b < 32) ? (a >> b) : (a >> 31), result);
+        } else {
+            long long shifted = (b < 32) ? ((long long) a * (1LL << b)) : (a ? LLONG_MAX : 0);
+            return ((shifted < INT_MIN) || (shifted > INT_MAX)) ? big_binary(opcode, left, right, result) : give_number(shifted, result);
+        }
+    } else if constexpr ((opcode == SLASH) || (opcode == D_SLASH) || (opcode == PERCENT)) {
+        // dividing by zero is left to compute_binary, which reports the error
+        if (!b) {
+            return compute_binary(opcode, left, right, result);
+        }
+        // the only quotient of two ints that overflows
+        if ((a == INT_MIN) && (b == -1)) {
+            return big_binary(opcode, left, right, result);
+        }
+        bool opposite = ((a < 0) && (b > 0)) || ((a > 0) && (b < 0));
+        if constexpr (opcode == SLASH) {
+            return give_number(a / b, result);
+        } else if constexpr (opcode == D_SLASH) {
+            return give_number(((a / b) - (opposite && (a % b))), result);
+        } else {
+            return give_number(((a % b) + ((opposite && (a % b)) ? b : 0)), result);
+        }
+    } else if constexpr (opcode == D_STAR) {
+        // raising 0 to a negative power is left to compute_binary, which reports the error
+        if (b <= 0) {
+            return (b == 0) ? give_number(1, result) : (a ? give_number(0, result) : compute_binary(opcode, left, right, result));
+        }
+        // square the base for each bit of the exponent, which overflows only if the result would
+        int power = 1;
+        int base = a;
+        while (true) {
+            if ((b & 1) && __builtin_mul_overflow(power, base, &power)) {
+                return big_binary(opcode, left, right, result);
+            }
+            b >>= 1;
+            if (!b) {
+                return give_number(power, result);
+            }
+            if (__builtin_mul_overflow(base, base, &base)) {
+                return big_binary(opcode, left, right, result);
+            }
+        }
+    } else if constexpr ((opcode == EQUAL) || (opcode == IS)) {
+        // an int is never the same object as a bool, even if they are equal
+        return give_bool((a == b) && ((opcode == EQUAL) || (left_type == right_type)), result);
+    } else if constexpr ((opcode == N_EQUAL) || (opcode == ISNOT)) {
+        return give_bool((a != b) || ((opcode == ISNOT) && (left_type != right_type)), result);
+    } else if constexpr (opcode == GREATER) {
+        return give_bool(a > b, result);
+    } else if constexpr (opcode == G_EQUAL) {
+        return give_bool(a >= b, result);
+    } else if constexpr (opcode == LESS) {
+        return give_bool(a < b, result);
+    } else {
+        return give_bool(a <= b, result);
+    }
+}
+
+
+/**
+ * \brief Picks the kernel that applies an operator to operands of the given types.
+ * \return The most specialized kernel for the combination (for ints held in the word, if unboxed).
+ */
+template <lexemes opcode, literal_types left_type, literal_types right_type, bool unboxed = false>
+static constexpr binary_kernel select_kernel() {
+    if constexpr (has_numerical_kernel(opcode, left_type, right_type)) {
+        return numerical_binary<opcode, left_type, right_type, unboxed>;
+    } else {
+        return general_binary<opcode>;
+    }
+}
+
+
+/**
+ * \brief Fills in the kernels of an operator for every type of right operand, given the type of the left one.
+ * \param [inout] kernels Pointer to the kernels to fill in, one for each type of right operand.
+ */
+template <lexemes opcode, literal_types left_type>
+static constexpr void fill_kernels(binary_kernel * kernels) {
+    kernels[FALSE_VALUE] = select_kernel<opcode, left_type, FALSE_VALUE>();
+    kernels[NONE_VALUE] = select_kernel<opcode, left_type, NONE_VALUE>();
+    kernels[NUMBER_VALUE] = select_kernel<opcode, left_type, NUMBER_VALUE>();
+    kernels[STRING_VALUE] = select_kernel<opcode, left_type, STRING_VALUE>();
+    kernels[TRUE_VALUE] = select_kernel<opcode, left_type, TRUE_VALUE>();
+}
+
+
+/**
+ * \brief Fills in the row of the table for one operator, covering every pair of types.
+ * \param [inout] table Pointer to the table being built.
+ * \param [in] row The row of the table to give the operator.
+ */
+template <lexemes opcode>
+static constexpr void fill_operator(binary_kernel_table * table, int row) {
+    table -> rows[opcode] = row;
+    table -> small_kernels[row] = select_kernel<opcode, NUMBER_VALUE, NUMBER_VALUE, true>();
+    fill_kernels<opcode, FALSE_VALUE>(table -> kernels[row][FALSE_VALUE]);
+    fill_kernels<opcode, NONE_VALUE>(table -> kernels[row][NONE_VALUE]);
+    fill_kernels<opcode, NUMBER_VALUE>(table -> kernels[row][NUMBER_VALUE]);
+    fill_kernels<opcode, STRING_VALUE>(table -> kernels[row][STRING_VALUE]);
+    fill_kernels<opcode, TRUE_VALUE>(table -> kernels[row][TRUE_VALUE]);
+}
+
+
+/**
+ * \brief Builds the table of kernels for every binary operator and pair of types, while compiling the interpreter.
+ * \return The finished table.
+ */
+static constexpr binary_kernel_table build_kernel_table() {
+    binary_kernel_table table = {};
+    // the first row is for any token that is not a binary operator, which compute_binary reports as a failure
+    fill_operator<EMPTY>(&table, 0);
+    fill_operator<PLUS>(&table, 1);
+    fill_operator<MINUS>(&table, 2);
+    fill_operator<STAR>(&table, 3);
+    fill_operator<SLASH>(&table, 4);
+    fill_operator<PERCENT>(&table, 5);
+    fill_operator<AT>(&table, 6);
+    fill_operator<D_STAR>(&table, 7);
+    fill_operator<D_SLASH>(&table, 8);
+    fill_operator<B_AND>(&table, 9);
+    fill_operator<B_OR>(&table, 10);
+    fill_operator<B_XOR>(&table, 11);
+    fill_operator<B_SLL>(&table, 12);
+    fill_operator<B_SAR>(&table, 13);
+    fill_operator<EQUAL>(&table, 14);
+    fill_operator<GREATER>(&table, 15);
+    fill_operator<LESS>(&table, 16);
+    fill_operator<N_EQUAL>(&table, 17);
+    fill_operator<G_EQUAL>(&table, 18);
+    fill_operator<L_EQUAL>(&table, 19);
+    fill_operator<IS>(&table, 20);
+    fill_operator<ISNOT>(&table, 21);
+    fill_operator<IN>(&table, 22);
+    fill_operator<NOTIN>(&table, 23);
+    return table;
+}
+
+
+// every binary operator applied by the interpreter goes through this table, which is built before it ever runs
+constexpr binary_kernel_table binary_kernels = build_kernel_table();
+
+
+/**
+ * \brief Applies a unary operator to an already-computed operand.
+ * \param [in] opcode The token representing the operation to complete.
+ * \param [in] right Pointer to the value of the operand.
+ * \param [inout] result Pointer to where to store the computed value.
+ * \return 0 if the operation succeeded; non-zero value if an error occurred.
+ */
+int apply_unary(lexemes opcode, const literal_value * right, literal_value * result) {
+    int return_code = 0;
+    // a failed operation still leaves a value behind, which holds nothing that needs releasing
+    *result = make_none();
+
+    // perform corresponding operation
+    switch (opcode) {
+        // bitwise not operation (~)
+        case B_NOT:
+            // directly translates to C operator for numerical values only
+            if (is_numerical(type_of(right)) && is_object(right)) {
+                return big_unary(opcode, right, result);
+            } else if (is_numerical(type_of(right))) {
+                *result = make_number(~numerify(right));
+            } else {
+                report_error(TYPE, "bad operand type");
+                return_code = 1;
+            }
+            break;
+
+        // unary negation operation (-)
+        case MINUS:
+            // directly translates to C operator for numerical values only
+            // the negation of the smallest int does not fit in one
+            if (is_numerical(type_of(right)) && (is_object(right) || (numerify(right) == INT_MIN))) {
+                return big_unary(opcode, right, result);
+            } else if (is_numerical(type_of(right))) {
+                *result = make_number(-numerify(right));
+            } else {
+                report_error(TYPE, "bad operand type");
+                return_code = 1;
+            }
+            break;
+
+        // logical negation operator (not)
+        case NOT:
+            // simply negates logical value of input
+            if (boolify(right)) {
+                *result = make_bool(false);
+            } else {
+                *result = make_bool(true);
+            }
+            break;
+
+        // unary positive operation (+)
+        case PLUS:
+            // directly translates to C operator for numerical values only
+            // a number on the heap is never changed, so it is simply shared
+            if (is_numerical(type_of(right)) && is_object(right)) {
+                *result = *right;
+                retain(result);
+            } else if (is_numerical(type_of(right))) {
+                *result = make_number(+numerify(right));
+            } else {
+                report_error(TYPE, "bad operand type");
+                return_code = 1;
+            }
+            break;
+
+        // theoretically unreachable
+        default:
+            report_failure("no such unary operator exists");
+            return_code = 1;
+            break;
+    }
+    return return_code;
+}
+
+
+/**
+ * \brief Determines whether applying a binary operator to two operands would succeed, without reporting any error.
+ * \param [in] opcode The token representing the operation to check.
+ * \param [in] left Pointer to the value of the first operand.
+ * \param [in] right Pointer to the value of the second operand.
+ * \return True if apply_binary would succeed on these operands; false if it would report an error.
+ */
+bool can_apply_binary(lexemes opcode, const literal_value * left, const literal_value * right) {
+    bool numbers = is_numerical(type_of(left)) && is_numerical(type_of(right));
+    bool strings = (type_of(left) == STRING_VALUE) && (type_of(right) == STRING_VALUE);
+    switch (opcode) {
+        // comparisons of equality and identity work on any values
+        case EQUAL:
+        case IS:
+        case ISNOT:
+        case N_EQUAL:
+            return true;
+        // arithmetic and bitwise operators work on numerical values only
+        case B_AND:
+        case B_OR:
+        case B_XOR:
+        case MINUS:
+            return numbers;
+        // shifting by a negative count is an error
+        case B_SAR:
+        case B_SLL:
+            return numbers && (numerify(right) >= 0);
+        // division by zero is an error, as is raising 0 to a negative power
+        case D_SLASH:
+        case PERCENT:
+        case SLASH:
+            return numbers && numerify(right);
+        case D_STAR:
+            return numbers && ((numerify(right) >= 0) || numerify(left));
+        // ordering works on two numerical values or two strings
+        case GREATER:
+        case G_EQUAL:
+        case LESS:
+        case L_EQUAL:
+        case PLUS:
+            return numbers || strings;
+        // membership works on strings only
+        case IN:
+        case NOTIN:
+            return strings;
+        // a string may be repeated by a number on either side
+        case STAR:
+            return numbers || ((type_of(left) == STRING_VALUE) && is_numerical(type_of(right))) ||
+                   ((type_of(right) == STRING_VALUE) && is_numerical(type_of(left)));
+        // matrix multiplication is unsupported, and anything else is not a binary operator
+        default:
+            return false;
+    }
+}
+
+
+/**
+ * \brief Determines whether applying a unary operator to an operand would succeed, without reporting any error.
+ * \param [in] opcode The token representing the operation to check.
+ * \param [in] right Pointer to the value of the operand.
+ * \return True if apply_unary would succeed on this operand; false if it would report an error.
+ */
+bool can_apply_unary(lexemes opcode, const literal_value * right) {
+    switch (opcode) {
+        // any value can be negated logically
+        case NOT:
+            return true;
+        // the rest work on numerical values only
+        case B_NOT:
+        case MINUS:
+        case PLUS:
+            return is_numerical(type_of(right));
+        default:
+            return false;
+    }
+}
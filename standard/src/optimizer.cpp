@@ -0,0 +1,442 @@
+/*********************************************************************************
+* Description: The optimizer (simplifies a syntax tree before it is run)
+* Author(s): Isaac Joffe
+* Copyright: University of Alberta, 2024
+* License: CC-BY-4.0
+*********************************************************************************/
+
+
+#include <cstdlib>
+#include "arena.h"
+#include "lexer.h"
+#include "operations.h"
+#include "optimizer.h"
+#include "tree.h"
+
+
+/** Any operation whose operands are all literals gives the same value every time it runs, so it is computed once here.
+    The operators are applied by the same functions that the evaluator and virtual machine use, so results always agree.
+    An operation that would fail (dividing by zero, mixing types, etc.) is left alone, so that its error is still reported when run.
+    Simplifications like x + 0 into x are not made, since x may turn out to be a string or a bool, which the operation would change.
+    Logical operators whose left operand is a literal are the exception, since Python defines them to give one operand or the other.
+    Likewise, an if statement or while loop whose condition is a literal only ever runs one of its parts, so the others are removed.
+    Blocks then lose every statement that does nothing (pass, a missing else-branch, etc.) or comes after a break or continue.
+    Nodes are replaced in place, so a parent never needs to know that its child was simplified.
+    A long chain of operations leans left, so it is walked with a list rather than by recursing once per operand.
+    Anything nested deeper than MAX_FOLD_DEPTH is just left as it is, so simplifying can never run out of stack.
+*/
+
+
+/**
+ * \brief Constructor for the optimizer class.
+ * \param [inout] input Pointer to the syntax tree to be simplified.
+ */
+Optimizer::Optimizer(syntax_tree * input) {
+    tree = input;
+}
+
+
+/**
+ * \brief Simplifies every expression within a portion of a syntax tree.
+ * \param [in] index The index of the syntax tree node to simplify.
+ */
+void Optimizer::fold(int index) {
+    // empty statements have nothing to simplify
+    if (index == NO_NODE) {
+        return;
+    }
+    // a node nested too deeply is left unsimplified, which still runs correctly
+    if (fold_depth >= MAX_FOLD_DEPTH) {
+        return;
+    }
+    fold_depth++;
+    node * tree_node = node_at(tree, index);
+    // visit every child of the node, simplifying expressions from the bottom up
+    switch (tree_node -> type) {
+        case ASSIGN_NODE:
+            fold(tree_node -> entry.assign_val.value);
+            break;
+        case BINARY_NODE:
+            fold_binary(index);
+            break;
+        case BLOCK_NODE:
+            fold_block(index);
+            break;
+        case FORLOOP_NODE:
+            fold_forloop(index);
+            break;
+        case GROUPING_NODE:
+            fold_grouping(index);
+            break;
+        case IFELSE_NODE:
+            fold_ifelse(index);
+            break;
+        case LOGICAL_NODE:
+            fold_logical(index);
+            break;
+        case UNARY_NODE:
+            fold_unary(index);
+            break;
+        case WHILELOOP_NODE:
+            fold_whileloop(index);
+            break;
+        // literals, variables, and special keywords are as simple as they get
+        default:
+            break;
+    }
+    fold_depth--;
+}
+
+
+/**
+ * \brief Adds an operation to the list of those in the chain being simplified, making more room if it is full.
+ * \param [in] index The index of the syntax tree node of the operation.
+ * \return True if the operation was added; false if memory ran out.
+ */
+bool Optimizer::push_chain(int index) {
+    if (chain_count >= chain_capacity) {
+        int capacity = chain_capacity ? (2 * chain_capacity) : MIN_CHAIN_LEN;
+        int * resized = (int *) realloc(chain, capacity * sizeof(int));
+        if (!resized) {
+            return false;
+        }
+        chain = resized;
+        chain_capacity = capacity;
+    }
+    chain[chain_count] = index;
+    chain_count++;
+    return true;
+}
+
+
+/**
+ * \brief Simplifies a binary operation and its operands, along with the whole chain of operations leaning left beneath it.
+ * \param [in] index The index of the syntax tree node of the operation.
+ */
+void Optimizer::fold_binary(int index) {
+    // list the chain from the top down, stopping at the first left operand that is not another operation
+    int base = chain_count;
+    int current = index;
+    while (push_chain(current)) {
+        int left = node_at(tree, current) -> entry.binary_val.left;
+        if ((left == NO_NODE) || (node_at(tree, left) -> type != BINARY_NODE)) {
+            break;
+        }
+        current = left;
+    }
+    // the operand at the bottom of the chain is simplified on its own (which is also where the list stops if memory ran out)
+    fold(node_at(tree, current) -> entry.binary_val.left);
+    // then each operation, from the bottom up, once its right operand is simplified too
+    for (int i = chain_count - 1; i >= base; i--) {
+        fold(node_at(tree, chain[i]) -> entry.binary_val.right);
+        fold_operation(chain[i]);
+    }
+    chain_count = base;
+}
+
+
+/**
+ * \brief Replaces a binary arithmetic operation on two literals with its value, its operands already being simplified.
+ * \param [in] index The index of the syntax tree node of the operation.
+ */
+void Optimizer::fold_operation(int index) {
+    binary_value expr = node_at(tree, index) -> entry.binary_val;
+    const node * left_node = node_at(tree, expr.left);
+    const node * right_node = node_at(tree, expr.right);
+    if ((left_node -> type != LITERAL_NODE) || (right_node -> type != LITERAL_NODE)) {
+        return;
+    }
+    const literal_value * left = &(left_node -> entry.literal_val);
+    const literal_value * right = &(right_node -> entry.literal_val);
+    // an operation that would fail must still fail when it is run, not before
+    if (!can_apply_binary(expr.opcode, left, right)) {
+        return;
+    }
+    // large exponents, shifts, and repetitions take long to compute, which would be wasted if they are never run
+    if (((expr.opcode == D_STAR) || (expr.opcode == B_SLL)) && (numerify(right) > MAX_FOLD_COUNT)) {
+        return;
+    }
+    // and a number on the heap raised to even a small power may be far too big to keep
+    if ((expr.opcode == D_STAR) && is_object(left)) {
+        return;
+    }
+    // a repetition is judged by the string it would make, since repeating one already repeated multiplies its length
+    if ((expr.opcode == STAR) && ((type_of(left) == STRING_VALUE) || (type_of(right) == STRING_VALUE))) {
+        const literal_value * text = (type_of(left) == STRING_VALUE) ? left : right;
+        const literal_value * times = (type_of(left) == STRING_VALUE) ? right : left;
+        long count = numerify(times);
+        if (is_object(times) || (count > MAX_FOLD_COUNT) || (length_of(text) * count > MAX_FOLD_LEN)) {
+            return;
+        }
+    }
+    literal_value result;
+    if (apply_binary(expr.opcode, left, right, &result)) {
+        return;
+    }
+    replace_with_literal(index, result);
+}
+
+
+/**
+ * \brief Removes the statements of a block that do nothing or can never run, and splices in the blocks nested within it.
+ * \param [in] index The index of the syntax tree node of the block.
+ */
+void Optimizer::fold_block(int index) {
+    block_value expr = node_at(tree, index) -> entry.block_val;
+    for (int i = 0; i < expr.count; i++) {
+        fold(statement_at(tree, &expr, i));
+    }
+    // most blocks have nothing to remove or splice, and keep the statements they already have
+    int count = trim_block(&expr, NULL);
+    bool unchanged = (count == expr.count);
+    for (int i = 0; (i < expr.count) && unchanged; i++) {
+        unchanged = (node_at(tree, statement_at(tree, &expr, i)) -> type != BLOCK_NODE);
+    }
+    if (unchanged) {
+        return;
+    }
+    // the statements kept are gathered first, since the tree's list of statements may move as it grows
+    int * kept = (int *) arena_allocate(&(tree -> memory), count * sizeof(int));
+    // if memory runs out, the block is just left as it was, which still runs correctly
+    if (!kept) {
+        return;
+    }
+    trim_block(&expr, kept);
+    int first = add_statements(tree, kept, count);
+    if (first < 0) {
+        return;
+    }
+    *node_at(tree, index) = make_new_block(first, count);
+}
+
+
+/**
+ * \brief Simplifies a for loop, dropping an else-block that does nothing.
+ * \param [in] index The index of the syntax tree node of the loop.
+ */
+void Optimizer::fold_forloop(int index) {
+    forloop_value expr = node_at(tree, index) -> entry.forloop_val;
+    fold(expr.expression);
+    fold(expr.statements);
+    fold(expr.end);
+    if (is_empty(expr.end)) {
+        node_at(tree, index) -> entry.forloop_val.end = NO_NODE;
+    }
+}
+
+
+/**
+ * \brief Replaces a parenthetical expression with the expression inside it.
+ * \param [in] index The index of the syntax tree node of the grouping.
+ */
+void Optimizer::fold_grouping(int index) {
+    // parentheses only matter to the parser, which has already put the expression in its place
+    int expression = node_at(tree, index) -> entry.grouping_val.expression;
+    fold(expression);
+    replace_with_node(index, expression);
+}
+
+
+/**
+ * \brief Replaces an if-else statement whose condition is a literal with the branch it takes, dropping an else-branch that does nothing.
+ * \param [in] index The index of the syntax tree node of the statement.
+ */
+void Optimizer::fold_ifelse(int index) {
+    ifelse_value expr = node_at(tree, index) -> entry.ifelse_val;
+    fold(expr.condition);
+    const node * condition = node_at(tree, expr.condition);
+    // only the branch the condition picks can ever run (an elif is just an if within the else-branch)
+    if (condition -> type == LITERAL_NODE) {
+        int taken = boolify(&(condition -> entry.literal_val)) ? expr.ifbranch : expr.elsebranch;
+        fold(taken);
+        replace_with_node(index, is_empty(taken) ? NO_NODE : taken);
+        return;
+    }
+    fold(expr.ifbranch);
+    fold(expr.elsebranch);
+    if (is_empty(expr.elsebranch)) {
+        node_at(tree, index) -> entry.ifelse_val.elsebranch = NO_NODE;
+    }
+}
+
+
+/**
+ * \brief Replaces a binary logical operation whose left operand is a literal with the operand it gives.
+ * \param [in] index The index of the syntax tree node of the operation.
+ */
+void Optimizer::fold_logical(int index) {
+    logical_value expr = node_at(tree, index) -> entry.logical_val;
+    fold(expr.left);
+    const node * left_node = node_at(tree, expr.left);
+    if (left_node -> type != LITERAL_NODE) {
+        fold(expr.right);
+        return;
+    }
+    // "and" gives a false left operand and "or" a true one without running the right operand at all
+    bool left_value = boolify(&(left_node -> entry.literal_val));
+    if (((expr.opcode == AND) && !left_value) || ((expr.opcode == OR) && left_value)) {
+        replace_with_node(index, expr.left);
+    // otherwise the result is whatever the right operand gives
+    } else {
+        fold(expr.right);
+        replace_with_node(index, expr.right);
+    }
+}
+
+
+/**
+ * \brief Replaces a unary operation on a literal with its value.
+ * \param [in] index The index of the syntax tree node of the operation.
+ */
+void Optimizer::fold_unary(int index) {
+    unary_value expr = node_at(tree, index) -> entry.unary_val;
+    fold(expr.right);
+    const node * right_node = node_at(tree, expr.right);
+    if (right_node -> type != LITERAL_NODE) {
+        return;
+    }
+    // an operation that would fail must still fail when it is run, not before
+    if (!can_apply_unary(expr.opcode, &(right_node -> entry.literal_val))) {
+        return;
+    }
+    literal_value result;
+    if (apply_unary(expr.opcode, &(right_node -> entry.literal_val), &result)) {
+        return;
+    }
+    replace_with_literal(index, result);
+}
+
+
+/**
+ * \brief Simplifies a while loop, removing it if its condition is always false, and dropping an else-block that never runs or does nothing.
+ * \param [in] index The index of the syntax tree node of the loop.
+ */
+void Optimizer::fold_whileloop(int index) {
+    whileloop_value expr = node_at(tree, index) -> entry.whileloop_val;
+    fold(expr.expression);
+    const node * condition = node_at(tree, expr.expression);
+    bool constant = (condition -> type == LITERAL_NODE);
+    // a loop whose condition is always false just runs its else-block
+    if (constant && !boolify(&(condition -> entry.literal_val))) {
+        fold(expr.end);
+        replace_with_node(index, is_empty(expr.end) ? NO_NODE : expr.end);
+        return;
+    }
+    fold(expr.statements);
+    fold(expr.end);
+    // a loop whose condition is always true only stops by a break, which skips its else-block
+    if (constant || is_empty(expr.end)) {
+        node_at(tree, index) -> entry.whileloop_val.end = NO_NODE;
+    }
+}
+
+
+/**
+ * \brief Determines if a statement does nothing at all when run.
+ * \param [in] index The index of the syntax tree node of the statement.
+ * \return True if the statement can be removed; false otherwise.
+ */
+bool Optimizer::is_empty(int index) {
+    const node * tree_node = node_at(tree, index);
+    switch (tree_node -> type) {
+        // a missing else-branch is written as None, which prints nothing
+        case LITERAL_NODE:
+            return (type_of(&(tree_node -> entry.literal_val)) == NONE_VALUE);
+        // the missing node itself is a pass statement
+        case SPECIAL_NODE:
+            return (tree_node -> entry.special_val.keyword == PASS);
+        case BLOCK_NODE:
+            return (tree_node -> entry.block_val.count == 0);
+        default:
+            return false;
+    }
+}
+
+
+/**
+ * \brief Determines if a statement leaves the rest of its block, so that the statements after it never run.
+ * \param [in] index The index of the syntax tree node of the statement.
+ * \return True if the statement is a break or continue; false otherwise.
+ */
+bool Optimizer::leaves_block(int index) {
+    const node * tree_node = node_at(tree, index);
+    return (tree_node -> type == SPECIAL_NODE) &&
+           ((tree_node -> entry.special_val.keyword == BREAK) || (tree_node -> entry.special_val.keyword == CONTINUE));
+}
+
+
+/**
+ * \brief Finds the statements of a block that are worth keeping, whose own statements have already been simplified.
+ * \param [in] expr Pointer to the internal representation of the block.
+ * \param [inout] kept Pointer to where to store the indices of the statements kept; NULL to only count them.
+ * \return The number of statements kept.
+ */
+int Optimizer::trim_block(const block_value * expr, int * kept) {
+    int count = 0;
+    for (int i = 0; i < (expr -> count); i++) {
+        int statement = statement_at(tree, expr, i);
+        if (is_empty(statement)) {
+            continue;
+        }
+        const node * tree_node = node_at(tree, statement);
+        // a block within a block (left by an if statement whose condition is known) runs the same once spliced in
+        if (tree_node -> type == BLOCK_NODE) {
+            const block_value * inner = &(tree_node -> entry.block_val);
+            for (int j = 0; j < (inner -> count); j++) {
+                if (kept) {
+                    kept[count] = statement_at(tree, inner, j);
+                }
+                count++;
+            }
+            // that block has already been trimmed, so only its last statement can leave it
+            statement = statement_at(tree, inner, inner -> count - 1);
+        } else {
+            if (kept) {
+                kept[count] = statement;
+            }
+            count++;
+        }
+        // nothing after a break or continue can ever run
+        if (leaves_block(statement)) {
+            break;
+        }
+    }
+    return count;
+}
+
+
+/**
+ * \brief Turns a node into a literal.
+ * \param [in] index The index of the syntax tree node to replace.
+ * \param [in] value The value the node is to have, whose reference is handed to the tree.
+ */
+void Optimizer::replace_with_literal(int index, literal_value value) {
+    // if memory runs out, the node is just left as it was, which still runs correctly
+    if (keep_value(tree, value)) {
+        return;
+    }
+    *node_at(tree, index) = make_new_literal(value);
+}
+
+
+/**
+ * \brief Turns a node into a copy of another, which then shares its children.
+ * \param [in] index The index of the syntax tree node to replace.
+ * \param [in] other The index of the syntax tree node to copy.
+ */
+void Optimizer::replace_with_node(int index, int other) {
+    *node_at(tree, index) = *node_at(tree, other);
+}
+
+
+/**
+ * \brief Simplifies every expression in the input syntax tree.
+ * \return 0 if simplification succeeded; non-zero value if an error occurred.
+ */
+int Optimizer::optimize_input() {
+    fold(tree -> root);
+    free(chain);
+    chain = NULL;
+    chain_capacity = 0;
+    return 0;
+}
@@ -7,9 +7,11 @@
 
 
 #include <cstdio>
+#include <cstdlib>
 #include "error.h"
 #include "lexer.h"
 #include "parser.h"
+#include "symbols.h"
 #include "tree.h"
 #include "utility.h"
 
@@ -24,65 +26,195 @@
 
 /** precedence levels of operators are as follows (from lowest to highest):
     https://docs.python.org/3/reference/grammar.html
-        logical or (OR) [disjunction]
-        logical and (AND) [conjunction]
-        logical not (NOT) [inversion]
-        comparison/identity/membership (==, !=, >, >=, <, <=, is, is not, in, not in) [comparison]
-        bitwise or (|) [bor]
-        bitwise xor (^) [bxor]
-        bitwise and (&) [band]
-        bitwise shift (>>, <<) [shift]
-        add/subtract (+, -) [sum]
-        multiply/divide (*, /, //, %, @) [term]
-        unary (+, -, ~) [factor]
-        exponent (**) [power]
+        logical or (OR) [PREC_OR]
+        logical and (AND) [PREC_AND]
+        logical not (NOT) [PREC_NOT]
+        comparison/identity/membership (==, !=, >, >=, <, <=, is, is not, in, not in) [PREC_COMPARISON]
+        bitwise or (|) [PREC_BOR]
+        bitwise xor (^) [PREC_BXOR]
+        bitwise and (&) [PREC_BAND]
+        bitwise shift (>>, <<) [PREC_SHIFT]
+        add/subtract (+, -) [PREC_SUM]
+        multiply/divide (*, /, //, %, @) [PREC_TERM]
+        unary (+, -, ~) [PREC_FACTOR]
+        exponent (**) [PREC_POWER]
     all operators in the same tier are left-associative, except for power
 */
 
 
 /**
  * \brief Basic constructor for the parser.
- * \param [in] input Pointer to the token list returned by the lexer.
- * \param [inout] output Pointer to pointer to where to store the produced syntax tree.
+ * \param [inout] input Pointer to the lexer to pull tokens from as they are needed.
+ * \param [inout] output Pointer to the (empty) syntax tree to store the parsed nodes in.
  */
-Parser::Parser(lexed_command input, node ** output) {
-    command_info = input;
-    syntax_trees = output;
+Parser::Parser(Lexer * input, syntax_tree * output) {
+    lexer = input;
+    tree = output;
 }
 
 
 /**
- * \brief Allocates and transcribes a syntax tree node for storage.
+ * \brief Stores a syntax tree node at the end of the tree.
  * \param [in] value Pointer to the node to save.
- * \return Pointer to where the node has been safely stored.
+ * \return The index where the node has been safely stored.
  */
-node * Parser::write_new_node(node * value) {
-    // determine the type of node needed to be created
-    tree_nodes[current_node].type = value -> type;
-    tree_nodes[current_node].entry = value -> entry;
-    // return the address of this current node while moving along counter to new node location
-    return &tree_nodes[current_node++];
+int Parser::write_new_node(node * value) {
+    int index = add_node(tree, value);
+    if ((index == NO_NODE) && !error_occurred) {
+        report_failure("out of memory for syntax tree");
+        error_occurred = true;
+    }
+    return index;
 }
 
 
 /**
- * \brief Starts the chain of parsing a Python command.
+ * \brief Creates the value of a string literal, taking its characters straight from the input.
+ * \param [in] token Pointer to the string literal's token.
+ * \return The string's value, kept by the tree (None if memory ran out).
+ */
+literal_value Parser::write_new_string(const lexed_token * token) {
+    literal_value value;
+    if (add_string_literal(tree, lexer -> text_of(token), token -> value.text.length, &value)) {
+        if (!error_occurred) {
+            report_failure("out of memory for syntax tree");
+            error_occurred = true;
+        }
+        return make_none();
+    }
+    return value;
+}
+
+
+/**
+ * \brief Creates the value of a number literal, reading its digits straight from the input.
+ * \param [in] token Pointer to the number literal's token.
+ * \return The number's value, kept by the tree if it is too big for an int (None if memory ran out).
+ */
+literal_value Parser::write_new_number(const lexed_token * token) {
+    literal_value value;
+    int return_code = add_number_literal(tree, lexer -> text_of(token), token -> value.text.length, &value);
+    if (return_code) {
+        // a number too big to make has already been reported
+        if ((return_code == 1) && !error_occurred) {
+            report_failure("out of memory for syntax tree");
+            error_occurred = true;
+        }
+        return make_none();
+    }
+    return value;
+}
+
+
+/**
+ * \brief Holds the index of a statement until the rest of its block has been parsed.
+ * \param [in] statement The index of the statement's node.
+ */
+void Parser::push_pending(int statement) {
+    // make room for more statements by doubling the space for them
+    if (num_pending >= pending_capacity) {
+        int capacity = pending_capacity ? (2 * pending_capacity) : MIN_NUM_PENDING;
+        int * resized = (int *) realloc(pending, capacity * sizeof(int));
+        if (!resized) {
+            if (!error_occurred) {
+                report_failure("out of memory for syntax tree");
+                error_occurred = true;
+            }
+            return;
+        }
+        pending = resized;
+        pending_capacity = capacity;
+    }
+    pending[num_pending] = statement;
+    num_pending++;
+}
+
+
+/**
+ * \brief Starts the chain of parsing a Python command, or the lines of an indented block.
  * \return The internal representation of the command.
  */
-node * Parser::block() {
-    node * trees[MAX_NUM_STMTS] = {NULL};
+int Parser::block() {
+    // nested blocks finish before this one does, so this block's statements stay together at the top
+    int base = num_pending;
     // a block requires one statement, so parse this first
-    trees[0] = statement();
-    // parse as many statements as there are in the input provided
-    int i = 1;
-    while ((current_matches(SEMICOLON) || current_matches(NEWLINE)) && !(end_reached())) {
-        // parse statements delimited by semicolons or newlines until the end
-        trees[i] = statement();
-        i++;
-    }
-    // make this a syntax tree node
-    node expr = make_new_block(trees);
-    node * expr_ptr = write_new_node(&expr);
+    int start = current;
+    push_pending(statement());
+    // parse as many statements as there are, up until the end of the input or of the indented block
+    while (!(end_reached()) && (current_token() != DEDENT)) {
+        // statements are delimited by semicolons or newlines, except that compound statements end their own lines
+        if (!(current_matches(SEMICOLON) || current_matches(NEWLINE) || ((current > start) && line_ended()))) {
+            break;
+        }
+        if (end_reached() || (current_token() == DEDENT)) {
+            break;
+        }
+        start = current;
+        push_pending(statement());
+    }
+    return finish_block(base);
+}
+
+
+/**
+ * \brief Handles the statements on the rest of a line, which make up a block after a colon.
+ * \return The internal representation of the block parsed.
+ */
+int Parser::simple_block() {
+    int base = num_pending;
+    push_pending(statement());
+    // only semicolons delimit these statements, but a compound statement among them may have ended the line already
+    while (!line_ended() && current_matches(SEMICOLON) && !(end_reached()) && (current_token() != NEWLINE)) {
+        push_pending(statement());
+    }
+    if (!line_ended()) {
+        current_matches(NEWLINE);
+    }
+    return finish_block(base);
+}
+
+
+/**
+ * \brief Handles the block of a compound statement, either indented on the lines after its colon or on the same line.
+ * \return The internal representation of the block parsed.
+ */
+int Parser::suite() {
+    // statements on the same line as the colon make up the whole block
+    if (!current_matches(NEWLINE)) {
+        return simple_block();
+    }
+    // otherwise the block is every line indented further than the statement
+    if (!current_matches(INDENT)) {
+        // error detected, there must be something to execute
+        indentation_error("expected an indented block");
+        return NO_NODE;
+    }
+    int suite_block = block();
+    if (!current_matches(DEDENT)) {
+        // error detected, the block must end where its indentation does
+        syntax_error("invalid syntax");
+    }
+    return suite_block;
+}
+
+
+/**
+ * \brief Stores the statements parsed for a block as one node of the tree.
+ * \param [in] base The number of statements that were already pending when the block started.
+ * \return The internal representation of the block.
+ */
+int Parser::finish_block(int base) {
+    // copy the statements into the tree as one run that takes only as much room as needed
+    int count = num_pending - base;
+    int first = add_statements(tree, pending + base, count);
+    num_pending = base;
+    if ((first < 0) && !error_occurred) {
+        report_failure("out of memory for syntax tree");
+        error_occurred = true;
+    }
+    // make this a syntax tree node (an empty block if memory ran out)
+    node expr = make_new_block((first < 0) ? 0 : first, (first < 0) ? 0 : count);
+    int expr_ptr = write_new_node(&expr);
     return expr_ptr;
 }
 
@@ -91,7 +223,12 @@ node * Parser::block() {
  * \brief Starts the chain of parsing a Python statement.
  * \return The internal representation of the statement.
  */
-node * Parser::statement() {
+int Parser::statement() {
+    // only a compound statement can be followed by a line indented further
+    if (current_matches(INDENT)) {
+        // error detected, the indentation starts no block
+        indentation_error("unexpected indent");
+    }
     // start recursively looking for statement operators
     return special();
 }
@@ -101,26 +238,25 @@ node * Parser::statement() {
  * \brief Handles special keyword statements.
  * \return The internal representation of the statement parsed so far.
  */
-node * Parser::special() {
+int Parser::special() {
     // TODO: add support for more single-keyword statements?
     // for keywords allowed only when inside a loop
     if (current_matches(BREAK) || current_matches(CONTINUE)) {
         if (not_in_loop()) {
             // error detected, must be inside a loop to leave one
-            report_error(SYNTAX, "outside loop");
-            error_occurred = true;
+            syntax_error("outside loop");
         }
         // create tree node for the statement
         lexemes keyword = previous_token();
         node expr = make_new_special(keyword);
-        node * expr_ptr = write_new_node(&expr);
+        int expr_ptr = write_new_node(&expr);
         return expr_ptr;
     // for keywords that can be used at any time
     } else if (current_matches(PASS)) {
         // create tree node for the statement
         lexemes keyword = previous_token();
         node expr = make_new_special(keyword);
-        node * expr_ptr = write_new_node(&expr);
+        int expr_ptr = write_new_node(&expr);
         return expr_ptr;
     }
 
@@ -133,66 +269,59 @@ node * Parser::special() {
  * \brief Handles all for loops.
  * \return The internal representation of the statement parsed so far.
  */
-node * Parser::forloop() {
+int Parser::forloop() {
     // for loop always begins with a for keyword
     if (current_matches(FOR)) {
         loop_depth++;
         // variable must follow as loop variable
-        char * name = NULL;
+        int name = NO_SYMBOL;
         if (current_matches(IDENTIFIER)) {
-            name = command_info.identifiers[current_identifier++];
+            name = token_at(current - 1) -> value.symbol;
         } else {
             // error detected, must have loop variable be a variable
-            report_error(SYNTAX, "cannot assign to literal");
-            error_occurred = true;
+            syntax_error("cannot assign to literal");
         }
 
         // in operator must immediately follow
         if (!(current_matches(IN))) {
             // error detected, must have loop variable followed by an in operator
-            report_error(SYNTAX, "invalid syntax");
-            error_occurred = true;
+            syntax_error("invalid syntax");
         }
 
         // parse value that must be iterated over right after the in keyword
-        node * iterable = expression();
+        int iterable = expression();
 
         // consume colon which must be immediately after the expression
         if (!current_matches(COLON)) {
             // error detected, must have colon to know that 
-            report_error(SYNTAX, "invalid syntax");
-            error_occurred = true;
+            syntax_error("invalid syntax");
         }
-        // consume the optional newline if it exists
-        current_matches(NEWLINE);
-
         // the block to execute immediately follows
-        node * for_block = block();
+        int for_block = suite();
         
         // no longer in the loop body
         loop_depth--;
 
-        node * final_block = NULL;
+        int final_block = NO_NODE;
         // else-branch depends on what is provided
         if (current_matches(ELSE)) {
-            // consume required colon and optional newline
+            // consume required colon
             if (!current_matches(COLON)) {
-                report_error(SYNTAX, "invalid syntax");
-                error_occurred = true;
+                syntax_error("invalid syntax");
             }
-            current_matches(NEWLINE);
-            final_block = block();
+            final_block = suite();
         // if none provided, then make it explicit
         } else {
-            literal_value temp_val;
-            temp_val.type = NONE_VALUE;
-            node temp_node = make_new_literal(temp_val);
+            node temp_node = make_new_literal(make_none());
             final_block = write_new_node(&temp_node);
         }
 
+        // the loop variable is a node of its own, which keeps the loop's node as small as the others
+        node variable = make_new_variable(name);
+        int variable_ptr = write_new_node(&variable);
         // create tree node for the branching
-        node expr = make_new_forloop(name, iterable, for_block, final_block);
-        node * expr_ptr = write_new_node(&expr);
+        node expr = make_new_forloop(variable_ptr, iterable, for_block, final_block);
+        int expr_ptr = write_new_node(&expr);
         return expr_ptr;
     }
 
@@ -205,49 +334,41 @@ node * Parser::forloop() {
  * \brief Handles all while loops.
  * \return The internal representation of the statement parsed so far.
  */
-node * Parser::whileloop() {
+int Parser::whileloop() {
     // TODO: add break and continue support
     // while loop always begins with a while keyword
     if (current_matches(WHILE)) {
         loop_depth++;
         // parse condition for breaking out which must be right after the initial keyword
-        node * condition = expression();
+        int condition = expression();
         // consume colon which must be immediately after the expression
         if (!current_matches(COLON)) {
             // error detected, must have colon to know that 
-            report_error(SYNTAX, "invalid syntax");
-            error_occurred = true;
+            syntax_error("invalid syntax");
         }
-        // consume the optional newline if it exists
-        current_matches(NEWLINE);
-
         // the block to execute immediately follows
-        node * while_block = block();
+        int while_block = suite();
         
         // no longer in the loop body
         loop_depth--;
         
-        node * final_block = NULL;
+        int final_block = NO_NODE;
         // else-branch depends on what is provided
         if (current_matches(ELSE)) {
-            // consume required colon and optional newline
+            // consume required colon
             if (!current_matches(COLON)) {
-                report_error(SYNTAX, "invalid syntax");
-                error_occurred = true;
+                syntax_error("invalid syntax");
             }
-            current_matches(NEWLINE);
-            final_block = block();
+            final_block = suite();
         // if none provided, then make it explicit
         } else {
-            literal_value temp_val;
-            temp_val.type = NONE_VALUE;
-            node temp_node = make_new_literal(temp_val);
+            node temp_node = make_new_literal(make_none());
             final_block = write_new_node(&temp_node);
         }
 
         // create tree node for the branching
         node expr = make_new_whileloop(condition, while_block, final_block);
-        node * expr_ptr = write_new_node(&expr);
+        int expr_ptr = write_new_node(&expr);
         return expr_ptr;
     }
 
@@ -260,79 +381,63 @@ node * Parser::whileloop() {
  * \brief Handles all if statements.
  * \return The internal representation of the statement parsed so far.
  */
-node * Parser::ifelse() {
-    // TODO: for now, no nested if statements
+int Parser::ifelse() {
     // if-else statement always begins with an if keyword
     if (current_matches(IF)) {
-        // allow storage f an arbitrary number of branches in the statement
-        node * branch_conditions[MAX_NUM_BRANCHES] = {NULL};
-        node * branch_statements[MAX_NUM_BRANCHES] = {NULL};
+        // the condition and statements of each branch are kept on the pending stack, so there can be any number of branches
+        int base = num_pending;
 
         // parse the first (if) branch
         // parse condition for branch which must be right after the initial keyword
-        branch_conditions[0] = expression();
+        push_pending(expression());
         // consume colon which must be immediately after the expression
         if (!current_matches(COLON)) {
             // error detected, must have colon to know that 
-            report_error(SYNTAX, "invalid syntax");
-            error_occurred = true;
+            syntax_error("invalid syntax");
         }
-        // consume the optional newline if it exists
-        current_matches(NEWLINE);
         // the branches to execute follow, always then-branch is first
-        branch_statements[0] = block();
+        push_pending(suite());
 
         // parse an arbitrary number of additional (elif) branches
-        int num_branches = 1;
         while (current_matches(ELIF)) {
             // parse condition for branch which must be right after the initial keyword
-            branch_conditions[num_branches] = expression();
+            push_pending(expression());
             // consume colon which must be immediately after the expression
             if (!current_matches(COLON)) {
                 // error detected, must have colon to know that 
-                report_error(SYNTAX, "invalid syntax");
-                error_occurred = true;
+                syntax_error("invalid syntax");
             }
-            // consume the optional newline if it exists
-            current_matches(NEWLINE);
-
             // the branches to execute follow, always then-branch is first
-            branch_statements[num_branches] = block();
-
-            // one more branch stored, so move along size limit
-            num_branches++;
+            push_pending(suite());
         }
 
         // parse the final (else) branch
-        node * final_branch = NULL;
+        int final_branch = NO_NODE;
         // else-branch depends on what is provided
         if (current_matches(ELSE)) {
-            // consume required colon and optional newline
+            // consume required colon
             if (!current_matches(COLON)) {
-                report_error(SYNTAX, "invalid syntax");
-                error_occurred = true;
+                syntax_error("invalid syntax");
             }
-            current_matches(NEWLINE);
-            final_branch = block();
+            final_branch = suite();
         // if none provided, then make it explicit
         } else {
-            literal_value temp_val;
-            temp_val.type = NONE_VALUE;
-            node temp_node = make_new_literal(temp_val);
+            node temp_node = make_new_literal(make_none());
             final_branch = write_new_node(&temp_node);
         }
-        
-        // pointer now needs to point to last existing barnch, not next new one
-        num_branches--;
+
+        // a branch that failed to be stored would leave the pairs misaligned, and the statement is thrown away anyway
+        if (error_occurred) {
+            num_pending = base;
+            return NO_NODE;
+        }
         // make final branch with last elif condition and else branch first because of the tree structure
-        node expr = make_new_ifelse(branch_conditions[num_branches], branch_statements[num_branches], final_branch);
-        node * expr_ptr = write_new_node(&expr);
-        num_branches--;
+        int expr_ptr = final_branch;
         // repeat this tree construction process moving back to the original branch
-        while (num_branches >= 0) {
-            expr = make_new_ifelse(branch_conditions[num_branches], branch_statements[num_branches], expr_ptr);
+        while (num_pending > base) {
+            node expr = make_new_ifelse(pending[num_pending - 2], pending[num_pending - 1], expr_ptr);
             expr_ptr = write_new_node(&expr);
-            num_branches--;
+            num_pending -= 2;
         }
         return expr_ptr;
     }
@@ -346,20 +451,20 @@ node * Parser::ifelse() {
  * \brief Handles assignment statements (both normal and augmented).
  * \return The internal representation of the statement parsed so far.
  */
-node * Parser::assign() {
+int Parser::assign() {
     // TODO: support more complex variables to be written to (necessary?)
     // assignment must begin with variable on the left-hand side
     if (current_matches(IDENTIFIER)) {
         // normal assignment is handled differently, no variable reading needed
         if (current_matches(ASSIGN)) {
-            // get variable name to assign into
-            char * name = command_info.identifiers[current_identifier++];
+            // get variable name to assign into (from before the assignment operator)
+            int name = token_at(current - 2) -> value.symbol;
             // assignments can be chained, but the value being assigned is an expression
-            node * value_ptr = assign();
+            int value_ptr = assign();
             // make a tree node for this assignment with the correct variable name
             node expr = make_new_assign(name, value_ptr);
             // save this node to build up the syntax tree
-            node * expr_ptr = write_new_node(&expr);
+            int expr_ptr = write_new_node(&expr);
             return expr_ptr;
 
         // augmented assignment involves an additional binary operation on the data, but no chaining
@@ -369,15 +474,15 @@ node * Parser::assign() {
                    current_matches(BO_ASSIGN) || current_matches(BX_ASSIGN) || current_matches(BL_ASSIGN) ||
                    current_matches(BR_ASSIGN) || current_matches(W_ASSIGN)) {
 
-            // get variable name to assign into
-            char * name = command_info.identifiers[current_identifier++];
+            // get variable name to assign into (from before the assignment operator)
+            int name = token_at(current - 2) -> value.symbol;
             // make a tree node for reading the original variable
             node var = make_new_variable(name);
-            node * var_ptr = write_new_node(&var);
+            int var_ptr = write_new_node(&var);
             // find the augmentation operation required
             lexemes opcode = previous_token();
             // value that variable is augmented with must be an expression
-            node * value_ptr = expression();
+            int value_ptr = expression();
             // make a tree node for the augmentation operation
             node aug;
 
@@ -440,11 +545,11 @@ node * Parser::assign() {
                     break;
             }
 
-            node * aug_ptr = write_new_node(&aug);
+            int aug_ptr = write_new_node(&aug);
             // make a tree node for this assignment with the correct variable name
             node expr = make_new_assign(name, aug_ptr);
             // save this node to build up the syntax tree
-            node * expr_ptr = write_new_node(&expr);
+            int expr_ptr = write_new_node(&expr);
             return expr_ptr;
 
         // unconsume the identifier token since no assignment followed
@@ -457,242 +562,146 @@ node * Parser::assign() {
 
 
 /**
- * \brief Starts the chain of parsing a Python expression.
- * \return The internal representation of the expression.
+ * \brief Finds how tightly a token binds as an operator between two operands.
+ * \param [in] token The token that may be an operator.
+ * \return The precedence level of the operator; PREC_NONE if the token is not one.
  */
-node * Parser::expression() {
-    // start recursively looking for expression operators
-    return disjunction();
+static precedence infix_precedence(lexemes token) {
+    switch (token) {
+        case OR:
+            return PREC_OR;
+        case AND:
+            return PREC_AND;
+        case EQUAL: case N_EQUAL: case GREATER: case G_EQUAL: case LESS: case L_EQUAL:
+        case IS: case ISNOT: case IN: case NOTIN:
+            return PREC_COMPARISON;
+        case B_OR:
+            return PREC_BOR;
+        case B_XOR:
+            return PREC_BXOR;
+        case B_AND:
+            return PREC_BAND;
+        case B_SLL: case B_SAR:
+            return PREC_SHIFT;
+        case PLUS: case MINUS:
+            return PREC_SUM;
+        case STAR: case SLASH: case D_SLASH: case PERCENT: case AT:
+            return PREC_TERM;
+        case D_STAR:
+            return PREC_POWER;
+        default:
+            return PREC_NONE;
+    }
 }
 
 
 /**
- * \brief Handles the lowest priority operator: "or"/"OR".
- * \return The internal representation of the expression parsed so far.
+ * \brief Starts the chain of parsing a Python expression.
+ * \return The internal representation of the expression.
  */
-node * Parser::disjunction() {
-    /** general strategy for all levels of expression operators is as follows:
-     *    recurse down, allowing higher priority operators to start, then
-     *    deal with current operator as it arises, then
-     *    recurse down for subsequent operand, then
-     *    combine these two operands with the current operator
-     */
-    // recurse to higher priority operators
-    node * expr_ptr = conjunction();
-    // deal with any OR operators
-    while (current_matches(OR)) {
-        // find the operation to be completed
-        lexemes opcode = previous_token();
-        // recurse again to get the right operand
-        node * right_ptr = conjunction();
-        // combine the operands, building up the syntax tree
-        node expr = make_new_logical(expr_ptr, opcode, right_ptr);
-        expr_ptr = write_new_node(&expr);
-    }
-    // combined nested expressions is the new expression
-    return expr_ptr;
+int Parser::expression() {
+    // an expression may use operators of any precedence at all
+    return parse_precedence(PREC_OR);
 }
 
 
 /**
- * \brief Handles the next lowest priority operator: "and"/"AND".
+ * \brief Handles an expression made up of operators that bind at least as tightly as some level.
+ * \param [in] level The lowest precedence of the operators that this expression may use.
  * \return The internal representation of the expression parsed so far.
  */
-node * Parser::conjunction() {
-    node * expr_ptr = inversion();
-    while (current_matches(AND)) {
-        lexemes opcode = previous_token();
-        node * right_ptr = inversion();
-        node expr = make_new_logical(expr_ptr, opcode, right_ptr);
+int Parser::parse_precedence(precedence level) {
+    /** general strategy is precedence climbing, rather than a function per level of precedence:
+     *    parse the leftmost operand, along with any unary operator in front of it, then
+     *    while the next operator binds at least as tightly as this level allows,
+     *      parse its right operand with only the operators that bind more tightly, then
+     *      combine these two operands with the operator, which becomes the new left operand
+     *  so a lone operand takes one call here, however many levels of precedence there are
+     */
+    int expr_ptr = NO_NODE;
+    // unary operators handled differently, no left operand to handle first
+    lexemes opcode = current_token();
+    // every operand nested inside another takes another call here, so give up before the stack runs out
+    if (nesting_depth >= MAX_NESTING_DEPTH) {
+        syntax_error((previous_token() == L_PAREN) ? "too many nested parentheses" : "expression is too deeply nested");
+        return NO_NODE;
+    }
+    nesting_depth++;
+    if ((opcode == NOT) && (level <= PREC_NOT)) {
+        advance_current();
+        // the operand is also an inversion, to allow stacked unary operators
+        int right_ptr = parse_precedence(PREC_NOT);
+        node expr = make_new_unary(opcode, right_ptr);
         expr_ptr = write_new_node(&expr);
+    } else if (((opcode == PLUS) || (opcode == MINUS) || (opcode == B_NOT)) && (level <= PREC_FACTOR)) {
+        advance_current();
+        // the operand is also a factor, so a power binds more tightly than the sign in front of it
+        int right_ptr = parse_precedence(PREC_FACTOR);
+        node expr = make_new_unary(opcode, right_ptr);
+        expr_ptr = write_new_node(&expr);
+    } else {
+        expr_ptr = primary();
     }
-    return expr_ptr;
-}
-
 
-/**
- * \brief Handles the next lowest priority operator: "not"/"NOT".
- * \return The internal representation of the expression parsed so far.
- */
-node * Parser::inversion() {
-    // unary operator handled differently, no left operand to handle first
-    while (current_matches(NOT)) {
-        lexemes opcode = previous_token();
-        // recursively call itself to allow stacked unary operators
-        node * right_ptr = inversion();
-        node expr = make_new_unary(opcode, right_ptr);
-        return write_new_node(&expr);
+    // deal with every binary operator that belongs to this level or a tighter one
+    precedence operator_level;
+    while ((operator_level = infix_precedence(current_token())) && (operator_level >= level)) {
+        // comparisons are chained rather than nested, so they are handled all at once
+        if (operator_level == PREC_COMPARISON) {
+            expr_ptr = comparison(expr_ptr);
+            continue;
+        }
+        advance_current();
+        opcode = previous_token();
+        // power is right-associative and its right operand may have a sign, so it is a whole factor
+        // every other operator is left-associative, so its right operand only holds operators that bind more tightly
+        int right_ptr = parse_precedence((operator_level == PREC_POWER) ? PREC_FACTOR : (precedence) (operator_level + 1));
+        // combine the operands, building up the syntax tree
+        node expr = ((operator_level == PREC_OR) || (operator_level == PREC_AND)) ?
+                    make_new_logical(expr_ptr, opcode, right_ptr) : make_new_binary(expr_ptr, opcode, right_ptr);
+        expr_ptr = write_new_node(&expr);
     }
-    return comparison();
+    nesting_depth--;
+    // combined nested expressions is the new expression
+    return expr_ptr;
 }
 
 
 /**
- * \brief Handles the next lowest priority operator: "=="/"EQUAL", "!="/"N_EQUAL", ">"/"GREATER",
- *                                                   ">="/"G_EQUAL", "<"/"LESS", "<="/"L_EQUAL",
- *                                                   "is"/"IS", "is not"/"ISNOT", "in"/"IN", "not in"/"NOTIN") .
+ * \brief Handles a chain of comparison operators: "=="/"EQUAL", "!="/"N_EQUAL", ">"/"GREATER",
+ *                                                 ">="/"G_EQUAL", "<"/"LESS", "<="/"L_EQUAL",
+ *                                                 "is"/"IS", "is not"/"ISNOT", "in"/"IN", "not in"/"NOTIN".
+ * \param [in] left_ptr The internal representation of the operand before the first comparison.
  * \return The internal representation of the expression parsed so far.
  */
-node * Parser::comparison() {
+int Parser::comparison(int left_ptr) {
     // these operators handled differently, can be chained with implicit conversion
-    node * expr_ptr = bor();
+    int expr_ptr = left_ptr;
     // need to be able to store inner operands for longer expressions
-    node * right_ptr;
+    int right_ptr = NO_NODE;
     bool first_time = true;
-    while (current_matches(EQUAL) || current_matches(N_EQUAL) || current_matches(GREATER) ||
-           current_matches(G_EQUAL) || current_matches(LESS) || current_matches(L_EQUAL) ||
-           current_matches(IS) || current_matches(ISNOT) || current_matches(IN) ||
-           current_matches(NOTIN)) {
+    while (infix_precedence(current_token()) == PREC_COMPARISON) {
+        advance_current();
+        lexemes opcode = previous_token();
+        right_ptr = parse_precedence(PREC_BOR);
         // process normally on the first encounter of comparison operator
         if (first_time) {
             first_time = false;
-            lexemes opcode = previous_token();
-            right_ptr = bor();
             node expr = make_new_binary(expr_ptr, opcode, right_ptr);
             expr_ptr = write_new_node(&expr);
         // implicitly convert logic for subsequent chained operators
         } else {
-            // left operand of next expression becomes what the right operand of the last one was
-            node * left_ptr = right_ptr;
-            lexemes opcode = previous_token();
-            right_ptr = bor();
             // old expression must be saved to be chained with the new one
-            node * old_ptr = expr_ptr;
-            // make comparison node for new operand
+            int old_ptr = expr_ptr;
+            // make comparison node for new operand, whose left operand is what the right operand of the last one was
             node expr = make_new_binary(left_ptr, opcode, right_ptr);
             expr_ptr = write_new_node(&expr);
             // combine this and previous node with AND condition as per Python standard (both comparisons must be true)
             expr = make_new_logical(old_ptr, AND, expr_ptr);
             expr_ptr = write_new_node(&expr);
         }
-    }
-    return expr_ptr;
-}
-
-
-/**
- * \brief Handles the next lowest priority operator: "|"/"B_OR".
- * \return The internal representation of the expression parsed so far.
- */
-node * Parser::bor() {
-    node * expr_ptr = bxor();
-    while (current_matches(B_OR)) {
-        lexemes opcode = previous_token();
-        node * right_ptr = bxor();
-        node expr = make_new_binary(expr_ptr, opcode, right_ptr);
-        expr_ptr = write_new_node(&expr);
-    }
-    return expr_ptr;
-}
-
-
-/**
- * \brief Handles the next lowest priority operator: "^"/"B_XOR".
- * \return The internal representation of the expression parsed so far.
- */
-node * Parser::bxor() {
-    node * expr_ptr = band();
-    while (current_matches(B_XOR)) {
-        lexemes opcode = previous_token();
-        node * right_ptr = band();
-        node expr = make_new_binary(expr_ptr, opcode, right_ptr);
-        expr_ptr = write_new_node(&expr);
-    }
-    return expr_ptr;
-}
-
-
-/**
- * \brief Handles the next lowest priority operator: "&"/"B_AND".
- * \return The internal representation of the expression parsed so far.
- */
-node * Parser::band() {
-    node * expr_ptr = shift();
-    while (current_matches(B_AND)) {
-        lexemes opcode = previous_token();
-        node * right_ptr = shift();
-        node expr = make_new_binary(expr_ptr, opcode, right_ptr);
-        expr_ptr = write_new_node(&expr);
-    }
-    return expr_ptr;
-}
-
-
-/**
- * \brief Handles the next lowest priority operator: "<<"/"B_SLL", ">>"/"B_SAR".
- * \return The internal representation of the expression parsed so far.
- */
-node * Parser::shift() {
-    node * expr_ptr = sum();
-    while (current_matches(B_SLL) || current_matches(B_SAR)) {
-        lexemes opcode = previous_token();
-        node * right_ptr = sum();
-        node expr = make_new_binary(expr_ptr, opcode, right_ptr);
-        expr_ptr = write_new_node(&expr);
-    }
-    return expr_ptr;
-}
-
-
-/**
- * \brief Handles the next lowest priority operator: "+"/"PLUS", "-"/"MINUS".
- * \return The internal representation of the expression parsed so far.
- */
-node * Parser::sum() {
-    node * expr_ptr = term();
-    while (current_matches(PLUS) || current_matches(MINUS)) {
-        lexemes opcode = previous_token();
-        node * right_ptr = term();
-        node expr = make_new_binary(expr_ptr, opcode, right_ptr);
-        expr_ptr = write_new_node(&expr);
-    }
-    return expr_ptr;
-}
-
-
-/**
- * \brief Handles the next lowest priority operator: "*"/"STAR", "/"/"SLASH", "//"/"D_SLASH", "%"/"PERCENT", "@"/"AT".
- * \return The internal representation of the expression parsed so far.
- */
-node * Parser::term() {
-    node * expr_ptr = factor();
-    while (current_matches(STAR) || current_matches(SLASH) || current_matches(D_SLASH) ||
-           current_matches(PERCENT) || current_matches(AT)) {
-        lexemes opcode = previous_token();
-        node * right_ptr = factor();
-        node expr = make_new_binary(expr_ptr, opcode, right_ptr);
-        expr_ptr = write_new_node(&expr);
-    }
-    return expr_ptr;
-}
-
-
-/**
- * \brief Handles the next lowest priority operator: "+"/"PLUS", "-"/"MINUS", "~"/"B_NOT".
- * \return The internal representation of the expression parsed so far.
- */
-node * Parser::factor() {
-    while (current_matches(PLUS) || current_matches(MINUS) || current_matches(B_NOT)) {
-        lexemes opcode = previous_token();
-        node * right_ptr = factor();
-        node expr = make_new_unary(opcode, right_ptr);
-        return write_new_node(&expr);
-    }
-    return power();
-}
-
-
-/**
- * \brief Handles the next lowest priority operator: "**"/"D_STAR".
- * \return The internal representation of the expression parsed so far.
- */
-node * Parser::power() {
-    node * expr_ptr = primary();
-    if (current_matches(D_STAR)) {
-        lexemes opcode = previous_token();
-        node * right_ptr = factor();
-        node expr = make_new_binary(expr_ptr, opcode, right_ptr);
-        expr_ptr = write_new_node(&expr);
+        // left operand of next expression becomes what the right operand of this one was
+        left_ptr = right_ptr;
     }
     return expr_ptr;
 }
@@ -702,44 +711,28 @@ node * Parser::power() {
  * \brief Handles literal values: "STRING", "NUMBER", "TRUE", "FALSE", "NONE".
  * \return The internal representation of the expression parsed so far.
  */
-node * Parser::primary() {
+int Parser::primary() {
     // base case deals with literal values and parentheses
-    node * expr_ptr = NULL;
+    int expr_ptr = NO_NODE;
 
     // sentinel literal values
     if (current_matches(FALSE)) {
-        literal_value lit;
-        lit.type = FALSE_VALUE;
-        node expr = make_new_literal(lit);
+        node expr = make_new_literal(make_bool(false));
         expr_ptr = write_new_node(&expr);
     } else if (current_matches(NONE)) {
-        literal_value lit;
-        lit.type = NONE_VALUE;
-        node expr = make_new_literal(lit);
+        node expr = make_new_literal(make_none());
         expr_ptr = write_new_node(&expr);
     } else if (current_matches(TRUE)) {
-        literal_value lit;
-        lit.type = TRUE_VALUE;
-        node expr = make_new_literal(lit);
+        node expr = make_new_literal(make_bool(true));
         expr_ptr = write_new_node(&expr);
 
     // number and string literal values that need to be fetched
     } else if (current_matches(NUMBER)) {
-        literal_value lit;
-        lit.type = NUMBER_VALUE;
-        lit.data.number = command_info.num_lits[current_num_lit];
-        current_num_lit++;
-        node expr = make_new_literal(lit);
+        node expr = make_new_literal(write_new_number(token_at(current - 1)));
         expr_ptr = write_new_node(&expr);
     } else if (current_matches(STRING)) {
-        literal_value lit;
-        lit.type = STRING_VALUE;
-        char * temp = command_info.str_lits[current_str_lit];
-        for (int i = 0; i < MAX_LIT_LEN; i++) {
-            lit.data.string[i] = *(temp + i);
-        }
-        current_str_lit++;
-        node expr = make_new_literal(lit);
+        // the string is copied out of the input only now, once, into an object the tree keeps
+        node expr = make_new_literal(write_new_string(token_at(current - 1)));
         expr_ptr = write_new_node(&expr);
 
     // deal with parentheses (nested expressions)
@@ -748,16 +741,13 @@ node * Parser::primary() {
         node expr = make_new_grouping(expression());
         expr_ptr = write_new_node(&expr);
         if (!current_matches(R_PAREN)) {
-            // TODO: enable parentheses over multiple line
             // error detected, must have closing parenthesis
-            report_error(SYNTAX, "invalid syntax");
-            error_occurred = true;
+            syntax_error("invalid syntax");
         }
 
     // deal with identifiers (meaning variables)
     } else if (current_matches(IDENTIFIER)) {
-        node expr = make_new_variable(command_info.identifiers[current_identifier]);
-        current_identifier++;
+        node expr = make_new_variable(token_at(current - 1) -> value.symbol);
         expr_ptr = write_new_node(&expr);
     }
 
@@ -776,7 +766,7 @@ bool Parser::current_matches(lexemes token) {
     if (end_reached()) {
         return false;
     }
-    if ((command_info.tokens[current]) == token) {
+    if ((token_at(current) -> type) == token) {
         // must consume this token and move along (assumption of calling code)
         advance_current();
         return true;
@@ -793,7 +783,7 @@ lexemes Parser::current_token() {
     if (end_reached()) {
         return EMPTY;
     }
-    return command_info.tokens[current];
+    return token_at(current) -> type;
 }
 
 
@@ -805,26 +795,69 @@ lexemes Parser::previous_token() {
     if (current == 0) {
         return EMPTY;
     }
-    return command_info.tokens[current - 1];
+    return token_at(current - 1) -> type;
+}
+
+
+/**
+ * \brief Provides a token that has been pulled from the lexer, which must be one of the last few.
+ * \param [in] position The position of the token in the input.
+ * \return Pointer to the token at that position.
+ */
+const lexed_token * Parser::token_at(int position) {
+    return &(lookahead[position & (LOOKAHEAD_SIZE - 1)]);
 }
 
 
 /**
- * \brief Increments the pointer to the current token being parsed.
+ * \brief Increments the pointer to the current token being parsed, pulling the next one from the lexer.
  */
 void Parser::advance_current() {
     if (!end_reached()) {
         current++;
+        // keep the current token on hand so that checking it stays as cheap as possible
+        if (current >= num_scanned) {
+            pull_token();
+        }
     }
 }
 
 
+/**
+ * \brief Asks the lexer for the next token of the input, noting if the input is over.
+ */
+void Parser::pull_token() {
+    if (input_ended) {
+        return;
+    }
+    lexed_token * next = &(lookahead[num_scanned & (LOOKAHEAD_SIZE - 1)]);
+    if (lexer -> scan_token(next)) {
+        // the lexer has already reported the error, so the input simply ends here
+        error_occurred = true;
+        input_ended = true;
+    } else if (next -> type == EMPTY) {
+        input_ended = true;
+    } else {
+        num_scanned++;
+    }
+}
+
+
+/**
+ * \brief Helper function to determine if a compound statement just parsed has already ended its line.
+ * \return True if the line has ended; false otherwise.
+ */
+bool Parser::line_ended() {
+    return (previous_token() == NEWLINE) || (previous_token() == DEDENT);
+}
+
+
 /**
  * \brief Helper function to determine if we are at the token list's end or not.
  * \return True if the end has been reached; false otherwise.
  */
 bool Parser::end_reached() {
-    return current >= (command_info.token_count);
+    return current >= num_scanned;
 }
 
 
@@ -837,6 +870,32 @@ bool Parser::not_in_loop() {
 }
 
 
+/**
+ * \brief Reports a syntax error, unless the input was cut short by an error the lexer already reported,
+ *        or an earlier error in the same input has already been reported.
+ * \param [in] message The description of the error.
+ */
+void Parser::syntax_error(const char * message) {
+    if (!(lexer -> has_error()) && !error_occurred) {
+        report_error(SYNTAX, message);
+    }
+    error_occurred = true;
+}
+
+
+/**
+ * \brief Reports an indentation error, unless the input was cut short by an error the lexer already reported,
+ *        or an earlier error in the same input has already been reported.
+ * \param [in] message The description of the error.
+ */
+void Parser::indentation_error(const char * message) {
+    if (!(lexer -> has_error()) && !error_occurred) {
+        report_error(INDENTATION, message);
+    }
+    error_occurred = true;
+}
+
+
 /**
  * \brief Tells if an error has occurred while parsing a token sequence.
  * \return True if an error has occurred; false otherwise.
@@ -846,13 +905,32 @@ bool Parser::has_error() {
 }
 
 
+/**
+ * \brief Tells if parsing used up every token of the input, rather than stopping at one that fits no statement.
+ * \return True if the whole input was parsed; false otherwise.
+ */
+bool Parser::parsed_all() {
+    return all_parsed;
+}
+
+
 /**
  * \brief Parses the input tokens into an expression.
  * \return 0 if execution succeeded; non-zero value if an error occurred.
  */
 int Parser::parse_input() {
-    // parse the input provided
-    *syntax_trees = block();
+    // parse the input provided, starting from its first token
+    pull_token();
+    tree -> root = block();
+    all_parsed = end_reached();
+    // finish lexing anything left over so that characters which can never be valid are still reported
+    while (!(end_reached())) {
+        advance_current();
+    }
+    // the statements of every block are now in the tree, so the space for holding them is no longer needed
+    free(pending);
+    pending = NULL;
+    pending_capacity = 0;
     // an error at any time should stop all operations
     if (has_error()) {
         return 1;
@@ -0,0 +1,159 @@
+/*********************************************************************************
+* Description: The resolver (gives each variable in a syntax tree its scope and storage slot)
+* Author(s): Isaac Joffe
+* Copyright: University of Alberta, 2024
+* License: CC-BY-4.0
+*********************************************************************************/
+
+
+#include <cstdio>
+#include "environment.h"
+#include "error.h"
+#include "resolver.h"
+#include "tree.h"
+
+
+/** Much of this code is based on Crafting Interpreters by Robert Nystrom.
+    Specifically, this file takes inspiration mostly from these chapters:
+      * Chapter 11 (https://craftinginterpreters.com/resolving-and-binding.html)
+    Names are looked up once here so that reading or writing a variable at run time is just an array index.
+    Each variable is recorded as (depth, slot): how many enclosing scopes out it lives, and where within that scope.
+    Slots are never reused, so a slot stays valid for every later command typed into the REPL.
+*/
+
+
+/**
+ * \brief Constructor for the resolver class.
+ * \param [inout] input Pointer to the syntax tree whose variables are to be resolved.
+ * \param [inout] env Pointer to the pre-created environment that holds the variables.
+ */
+Resolver::Resolver(syntax_tree * input, environment * env) {
+    tree = input;
+    this -> env = env;
+}
+
+
+/**
+ * \brief Resolves every variable within a portion of a syntax tree.
+ * \param [in] index The index of the syntax tree node to resolve.
+ */
+void Resolver::resolve(int index) {
+    // empty statements have nothing to resolve
+    if (index == NO_NODE) {
+        return;
+    }
+    // each level of nesting takes some of the stack, so a command nested too deeply is refused rather than crashing
+    if (resolve_depth >= MAX_RESOLVE_DEPTH) {
+        if (!error_occurred) {
+            report_error(RUNTIME, "expression is too deeply nested");
+            error_occurred = true;
+        }
+        return;
+    }
+    resolve_depth++;
+    node * tree_node = node_at(tree, index);
+    // visit every child of the node, resolving the names found along the way
+    switch (tree_node -> type) {
+        case ASSIGN_NODE:
+            resolve(tree_node -> entry.assign_val.value);
+            resolve_name(tree_node -> entry.assign_val.name, true,
+                         &(tree_node -> entry.assign_val.depth), &(tree_node -> entry.assign_val.slot));
+            break;
+        case BINARY_NODE:
+            resolve(tree_node -> entry.binary_val.left);
+            resolve(tree_node -> entry.binary_val.right);
+            break;
+        case BLOCK_NODE:
+            for (int i = 0; i < (tree_node -> entry.block_val.count); i++) {
+                resolve(statement_at(tree, &(tree_node -> entry.block_val), i));
+            }
+            break;
+        case FORLOOP_NODE: {
+            resolve(tree_node -> entry.forloop_val.expression);
+            // the loop variable is assigned to rather than read, so it is declared instead of resolved like other variables
+            variable_value * variable = &(node_at(tree, tree_node -> entry.forloop_val.variable) -> entry.variable_val);
+            resolve_name(variable -> name, true, &(variable -> depth), &(variable -> slot));
+            resolve(tree_node -> entry.forloop_val.statements);
+            resolve(tree_node -> entry.forloop_val.end);
+            break;
+        }
+        case GROUPING_NODE:
+            resolve(tree_node -> entry.grouping_val.expression);
+            break;
+        case IFELSE_NODE:
+            resolve(tree_node -> entry.ifelse_val.condition);
+            resolve(tree_node -> entry.ifelse_val.ifbranch);
+            resolve(tree_node -> entry.ifelse_val.elsebranch);
+            break;
+        case LOGICAL_NODE:
+            resolve(tree_node -> entry.logical_val.left);
+            resolve(tree_node -> entry.logical_val.right);
+            break;
+        case UNARY_NODE:
+            resolve(tree_node -> entry.unary_val.right);
+            break;
+        case VARIABLE_NODE:
+            resolve_name(tree_node -> entry.variable_val.name, false,
+                         &(tree_node -> entry.variable_val.depth), &(tree_node -> entry.variable_val.slot));
+            break;
+        case WHILELOOP_NODE:
+            resolve(tree_node -> entry.whileloop_val.expression);
+            resolve(tree_node -> entry.whileloop_val.statements);
+            resolve(tree_node -> entry.whileloop_val.end);
+            break;
+        // literals and special keywords refer to no variables
+        default:
+            break;
+    }
+    resolve_depth--;
+}
+
+
+/**
+ * \brief Finds (or creates) the scope and slot in the environment where a variable is stored.
+ * \param [in] name The symbol of the variable.
+ * \param [in] assigning True if the variable is being written to; false if it is being read from.
+ * \param [inout] depth Pointer to where to store the number of scopes out from the current one.
+ * \param [inout] slot Pointer to where to store the index of the variable's slot within that scope.
+ */
+void Resolver::resolve_name(int name, bool assigning, int * depth, int * slot) {
+    // assignments always bind the name in the current scope
+    environment * scope = env;
+    *depth = 0;
+    // reads use the nearest scope that has the name, otherwise the outermost (global) one
+    if (!assigning) {
+        while ((find_variable(scope, name) == (scope -> num_used)) && (scope -> enclosing)) {
+            scope = scope -> enclosing;
+            (*depth)++;
+        }
+    }
+    *slot = declare_variable(scope, name);
+    if ((*slot == UNRESOLVED_SLOT) && !error_occurred) {
+        // error detected, the environment has no room left for another variable
+        report_error(RUNTIME, "too many variables");
+        error_occurred = true;
+    }
+}
+
+
+/**
+ * \brief Tells if an error has occurred while resolving a syntax tree.
+ * \return True if an error has occurred; false otherwise.
+ */
+bool Resolver::has_error() {
+    return error_occurred;
+}
+
+
+/**
+ * \brief Resolves every variable in the input syntax tree.
+ * \return 0 if resolution succeeded; non-zero value if an error occurred.
+ */
+int Resolver::resolve_input() {
+    resolve(tree -> root);
+    // report any errors that occurred during resolution
+    if (has_error()) {
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,69 @@
+/*********************************************************************************
+* Description: Source files (gives access to the whole text of a script at once)
+* Author(s): Isaac Joffe
+* Copyright: University of Alberta, 2024
+* License: CC-BY-4.0
+*********************************************************************************/
+
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "source.h"
+
+
+/** A script is mapped into memory instead of being read into a buffer, so it has no length limit.
+    The operating system only reads each page from disk once the lexer reaches it,
+    so running the first statement of a large script does not have to wait for the rest of it to load.
+*/
+
+
+/**
+ * \brief Maps the whole text of a script into memory.
+ * \param [in] path The name of the file holding the script.
+ * \param [inout] source Pointer to where to store the text of the script.
+ * \return 0 on success; a non-zero error number on failure.
+ */
+int map_source(const char * path, source_file * source) {
+    int file = open(path, O_RDONLY);
+    if (file < 0) {
+        return 1;
+    }
+    struct stat info;
+    if (fstat(file, &info) < 0) {
+        close(file);
+        return 1;
+    }
+    source -> length = info.st_size;
+    // an empty file cannot be mapped, but it is still a valid (empty) script
+    if (source -> length == 0) {
+        source -> text = NULL;
+        close(file);
+        return 0;
+    }
+    void * text = mmap(NULL, source -> length, PROT_READ, MAP_PRIVATE, file, 0);
+    // the mapping stays valid once the file is closed
+    close(file);
+    if (text == MAP_FAILED) {
+        source -> length = 0;
+        return 1;
+    }
+    // the script is read from start to end, so let the operating system read ahead
+    madvise(text, source -> length, MADV_SEQUENTIAL);
+    source -> text = (const char *) text;
+    return 0;
+}
+
+
+/**
+ * \brief Releases the memory holding the text of a script.
+ * \param [inout] source Pointer to the script to release.
+ */
+void unmap_source(source_file * source) {
+    if (source -> text) {
+        munmap((void *) source -> text, source -> length);
+    }
+    source -> text = NULL;
+    source -> length = 0;
+}
@@ -0,0 +1,127 @@
+/*********************************************************************************
+* Description: The symbol table (gives every identifier a unique integer ID)
+* Author(s): Isaac Joffe
+* Copyright: University of Alberta, 2024
+* License: CC-BY-4.0
+*********************************************************************************/
+
+
+#include <cstdlib>
+#include <cstring>
+#include "symbols.h"
+#include "table.h"
+
+
+/** Much of this code is based on Crafting Interpreters by Robert Nystrom.
+    Specifically, this file takes inspiration mostly from these chapters:
+      * Chapter 20 (https://craftinginterpreters.com/hash-tables.html#string-interning)
+    The lexer interns each identifier once, so every later stage compares and indexes symbols instead of names.
+    Symbols are handed out in order (0, 1, 2, ...), so they can index arrays directly.
+    Each name is copied once when its symbol is made, and that copy is also the key the table looks it up by.
+*/
+
+
+// the one symbol table shared by every command, so a symbol means the same identifier forever
+static symbol_table global_symbols;
+
+
+/**
+ * \brief Gives an identifier its symbol, creating a new one if it has never been seen.
+ * \param [in] name The name of the identifier.
+ * \return The symbol of the identifier; NO_SYMBOL if memory ran out.
+ */
+int intern_symbol(const char name[]) {
+    return intern_symbol(name, strlen(name));
+}
+
+
+/**
+ * \brief Gives an identifier its symbol straight from the text it appears in, creating a new one if it has never been seen.
+ * \param [in] text The characters of the identifier (which need not be null-terminated).
+ * \param [in] length The number of characters in the identifier.
+ * \return The symbol of the identifier; NO_SYMBOL if memory ran out.
+ */
+int intern_symbol(const char * text, int length) {
+    // identifiers seen before keep the symbol they were first given
+    int symbol;
+    if (!table_get(&(global_symbols.symbols), text, length, &symbol)) {
+        return symbol;
+    }
+    // make room for more names by doubling the space for them
+    if (global_symbols.count >= global_symbols.capacity) {
+        int capacity = global_symbols.capacity ? (2 * global_symbols.capacity) : MIN_NUM_SYMBOLS;
+        char ** names = (char **) realloc(global_symbols.names, capacity * sizeof(char *));
+        if (!names) {
+            return NO_SYMBOL;
+        }
+        global_symbols.names = names;
+        global_symbols.capacity = capacity;
+    }
+    // keep a copy of the name, since the text it came from does not last
+    char * name = (char *) malloc(length + 1);
+    if (!name) {
+        return NO_SYMBOL;
+    }
+    memcpy(name, text, length);
+    name[length] = '\0';
+    // the next symbol in order is this identifier's
+    symbol = global_symbols.count;
+    if (table_set(&(global_symbols.symbols), name, length, symbol)) {
+        free(name);
+        return NO_SYMBOL;
+    }
+    global_symbols.names[symbol] = name;
+    global_symbols.count++;
+    return symbol;
+}
+
+
+/**
+ * \brief Finds the symbol of an identifier without creating one.
+ * \param [in] name The name of the identifier.
+ * \return The symbol of the identifier; NO_SYMBOL if it has never been interned.
+ */
+int find_symbol(const char name[]) {
+    int symbol;
+    if (table_get(&(global_symbols.symbols), name, strlen(name), &symbol)) {
+        return NO_SYMBOL;
+    }
+    return symbol;
+}
+
+
+/**
+ * \brief Fetches the name of a symbol.
+ * \param [in] symbol The symbol of interest.
+ * \return The name of the identifier the symbol stands for.
+ */
+const char * symbol_name(int symbol) {
+    if ((symbol < 0) || (symbol >= global_symbols.count)) {
+        return "";
+    }
+    return global_symbols.names[symbol];
+}
+
+
+/**
+ * \brief Counts the symbols that have been handed out.
+ * \return The number of symbols in existence.
+ */
+int num_symbols() {
+    return global_symbols.count;
+}
+
+
+/**
+ * \brief Releases the memory used by the symbol table, forgetting every symbol.
+ */
+void free_symbols() {
+    free_table(&(global_symbols.symbols));
+    for (int i = 0; i < global_symbols.count; i++) {
+        free(global_symbols.names[i]);
+    }
+    free(global_symbols.names);
+    global_symbols.names = NULL;
+    global_symbols.count = 0;
+    global_symbols.capacity = 0;
+}
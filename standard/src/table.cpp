@@ -0,0 +1,152 @@
+/*********************************************************************************
+* Description: A hash table mapping names to integers (used to intern identifiers)
+* Author(s): Isaac Joffe
+* Copyright: University of Alberta, 2024
+* License: CC-BY-4.0
+*********************************************************************************/
+
+
+#include <cstdlib>
+#include <cstring>
+#include "table.h"
+
+
+/** Much of this code is based on Crafting Interpreters by Robert Nystrom.
+    Specifically, this file takes inspiration mostly from these chapters:
+      * Chapter 20 (https://craftinginterpreters.com/hash-tables.html)
+    Names are never removed from a table, so no tombstones are needed.
+    Names are given with their length, so they can be read straight from the source without being copied out first.
+    A table only points to the names stored in it, which must be kept by the caller for as long as the table is used.
+*/
+
+
+/**
+ * \brief Computes the hash of a name using the FNV-1a algorithm.
+ * \param [in] key The name to hash (which need not be null-terminated).
+ * \param [in] length The number of characters in the name.
+ * \return The hash of the name.
+ */
+unsigned int hash_string(const char * key, int length) {
+    unsigned int hash = 2166136261u;
+    for (int i = 0; i < length; i++) {
+        hash ^= (unsigned char) key[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+
+/**
+ * \brief Locates the entry holding a name, or the empty entry where it would go.
+ * \param [in] entries The entries of the table to search.
+ * \param [in] capacity The number of entries in the table (a power of 2).
+ * \param [in] key The name to search for.
+ * \param [in] length The number of characters in the name.
+ * \param [in] hash The hash of the name.
+ * \return Pointer to the matching entry, or to an empty one if the name is not present.
+ */
+static table_entry * find_entry(table_entry * entries, int capacity, const char * key, int length, unsigned int hash) {
+    // capacity is a power of 2, so masking is the same as taking the remainder
+    unsigned int index = hash & (capacity - 1);
+    while (true) {
+        table_entry * entry = &(entries[index]);
+        // stop at the first empty entry, or at a matching name (which must end where the key does)
+        if ((entry -> value < 0) ||
+            ((entry -> hash == hash) && (entry -> length == length) && (memcmp(entry -> key, key, length) == 0))) {
+            return entry;
+        }
+        // collision, so try the next entry along
+        index = (index + 1) & (capacity - 1);
+    }
+}
+
+
+/**
+ * \brief Moves every entry of a table into a larger block of entries.
+ * \param [inout] map Pointer to the table to grow.
+ * \param [in] capacity The new number of entries (a power of 2).
+ * \return 0 if the table was grown; 1 if memory ran out.
+ */
+static int grow_table(table * map, int capacity) {
+    table_entry * entries = (table_entry *) malloc(capacity * sizeof(table_entry));
+    if (!entries) {
+        return 1;
+    }
+    for (int i = 0; i < capacity; i++) {
+        entries[i].value = -1;
+    }
+    // reinsert each existing entry, whose position depends on the capacity
+    for (int i = 0; i < (map -> capacity); i++) {
+        table_entry * entry = &(map -> entries[i]);
+        if (entry -> value >= 0) {
+            *find_entry(entries, capacity, entry -> key, entry -> length, entry -> hash) = *entry;
+        }
+    }
+    free(map -> entries);
+    map -> entries = entries;
+    map -> capacity = capacity;
+    return 0;
+}
+
+
+/**
+ * \brief Finds the value associated with a name.
+ * \param [in] map Pointer to the table to search.
+ * \param [in] key The name to search for (which need not be null-terminated).
+ * \param [in] length The number of characters in the name.
+ * \param [inout] value Pointer to where to store the value associated with the name.
+ * \return 0 if the name was found; 1 otherwise.
+ */
+int table_get(table * map, const char * key, int length, int * value) {
+    if (map -> count == 0) {
+        return 1;
+    }
+    table_entry * entry = find_entry(map -> entries, map -> capacity, key, length, hash_string(key, length));
+    if (entry -> value < 0) {
+        return 1;
+    }
+    *value = entry -> value;
+    return 0;
+}
+
+
+/**
+ * \brief Associates a value with a name, adding the name if it is not already present.
+ * \param [inout] map Pointer to the table to store into.
+ * \param [in] key The name to store (which need not be null-terminated, but must outlive the table).
+ * \param [in] length The number of characters in the name.
+ * \param [in] value The non-negative value to associate with the name.
+ * \return 0 if the value was stored; 1 if memory ran out.
+ */
+int table_set(table * map, const char * key, int length, int value) {
+    // grow before the table gets so full that probe sequences become long
+    if (4 * (map -> count + 1) > TABLE_MAX_LOAD * (map -> capacity)) {
+        int capacity = (map -> capacity) ? (2 * (map -> capacity)) : TABLE_MIN_CAPACITY;
+        if (grow_table(map, capacity)) {
+            return 1;
+        }
+    }
+    unsigned int hash = hash_string(key, length);
+    table_entry * entry = find_entry(map -> entries, map -> capacity, key, length, hash);
+    if (entry -> value < 0) {
+        // new name, so remember where it is kept
+        entry -> hash = hash;
+        entry -> key = key;
+        entry -> length = length;
+        (map -> count)++;
+    }
+    entry -> value = value;
+    return 0;
+}
+
+
+/**
+ * \brief Releases the memory used by a table, leaving it empty.
+ * \param [inout] map Pointer to the table to free.
+ */
+void free_table(table * map) {
+    free(map -> entries);
+    map -> entries = NULL;
+    map -> count = 0;
+    map -> capacity = 0;
+}
@@ -7,9 +7,13 @@
 
 
 #include <cstdio>
+#include <cstdlib>
 #include <cstring>
+#include "arena.h"
+#include "bigint.h"
 #include "lexer.h"
 #include "parser.h"
+#include "symbols.h"
 #include "tree.h"
 #include "utility.h"
 
@@ -26,16 +30,16 @@
 
 /**
  * \brief Constructor for an assignment operation's syntax tree node.
- * \param [in] name The name of identifier to write into.
- * \param [in] right Pointer to the node representing the expression to assign.
+ * \param [in] name The symbol of the identifier to write into.
+ * \param [in] value The index of the node representing the expression to assign.
  * \return A structure representing the syntax tree node.
  */
-node make_new_assign(char name[], node * value) {
+node make_new_assign(int name, int value) {
     node current;
     current.type = ASSIGN_NODE;
-    for (int i = 0; i < MAX_IDENTIFIER_LEN; i++) {
-        current.entry.assign_val.name[i] = name[i];
-    }
+    current.entry.assign_val.name = name;
+    current.entry.assign_val.depth = 0;
+    current.entry.assign_val.slot = UNRESOLVED_SLOT;
     current.entry.assign_val.value = value;
     return current;
 }
@@ -43,12 +47,12 @@ node make_new_assign(char name[], node * value) {
 
 /**
  * \brief Constructor for a binary arithmetic operation's syntax tree node.
- * \param [in] left Pointer to the node representing the first operand.
+ * \param [in] left The index of the node representing the first operand.
  * \param [in] opcode The token representing the operation to complete.
- * \param [in] right Pointer to the node representing the second operand.
+ * \param [in] right The index of the node representing the second operand.
  * \return A structure representing the syntax tree node.
  */
-node make_new_binary(node * left, lexemes opcode, node * right) {
+node make_new_binary(int left, lexemes opcode, int right) {
     node current;
     current.type = BINARY_NODE;
     current.entry.binary_val.left = left;
@@ -60,32 +64,31 @@ node make_new_binary(node * left, lexemes opcode, node * right) {
 
 /**
  * \brief Constructor for a block's syntax tree node.
- * \param [in] statements Pointer to the a pointer representing the list of statements.
+ * \param [in] first The position of the block's first statement in the tree's list of statements.
+ * \param [in] count The number of statements in the block.
  * \return A structure representing the syntax tree node.
  */
-node make_new_block(node ** statements) {
+node make_new_block(int first, int count) {
     node current;
     current.type = BLOCK_NODE;
-    for (int i = 0; i < MAX_NUM_STMTS; i++) {
-        current.entry.block_val.statements[i] = statements[i];
-    }
+    current.entry.block_val.first = first;
+    current.entry.block_val.count = count;
     return current;
 }
 
 
 /**
  * \brief Constructor for a for loop statement's syntax tree node.
- * \param [in] name The name of the loop variable to iterate over.
- * \param [in] expression Pointer to the node representing the variable to iterate over.
- * \param [in] statements Pointer to the node representing the statements to run at each iteration.
+ * \param [in] variable The index of the node representing the loop variable.
+ * \param [in] expression The index of the node representing the variable to iterate over.
+ * \param [in] statements The index of the node representing the statements to run at each iteration.
+ * \param [in] end The index of the node representing the statements to run after normal execution.
  * \return A structure representing the syntax tree node.
  */
-node make_new_forloop(char name[], node * expression, node * statements, node * end) {
+node make_new_forloop(int variable, int expression, int statements, int end) {
     node current;
     current.type = FORLOOP_NODE;
-    for (int i = 0; i < MAX_IDENTIFIER_LEN; i++) {
-        current.entry.forloop_val.name[i] = name[i];
-    }
+    current.entry.forloop_val.variable = variable;
     current.entry.forloop_val.expression = expression;
     current.entry.forloop_val.statements = statements;
     current.entry.forloop_val.end = end;
@@ -95,10 +98,10 @@ node make_new_forloop(char name[], node * expression, node * statements, node *
 
 /**
  * \brief Constructor for a grouping's syntax tree node.
- * \param [in] expression Pointer to the node representing the nested expression.
+ * \param [in] expression The index of the node representing the nested expression.
  * \return A structure representing the syntax tree node.
  */
-node make_new_grouping(node * expression) {
+node make_new_grouping(int expression) {
     node current;
     current.type = GROUPING_NODE;
     current.entry.grouping_val.expression = expression;
@@ -108,12 +111,12 @@ node make_new_grouping(node * expression) {
 
 /**
  * \brief Constructor for a if-else statement's syntax tree node.
- * \param [in] condition Pointer to the node representing the condition to branch on.
- * \param [in] ifbranch Pointer to the node representing the statements to run if the condition is true.
- * \param [in] elsebranch Pointer to the node representing the statements to run if the condition is false.
+ * \param [in] condition The index of the node representing the condition to branch on.
+ * \param [in] ifbranch The index of the node representing the statements to run if the condition is true.
+ * \param [in] elsebranch The index of the node representing the statements to run if the condition is false.
  * \return A structure representing the syntax tree node.
  */
-node make_new_ifelse(node * condition, node * ifbranch, node * elsebranch) {
+node make_new_ifelse(int condition, int ifbranch, int elsebranch) {
     node current;
     current.type = IFELSE_NODE;
     current.entry.ifelse_val.condition = condition;
@@ -125,33 +128,25 @@ node make_new_ifelse(node * condition, node * ifbranch, node * elsebranch) {
 
 /**
  * \brief Constructor for a literal value's syntax tree node.
- * \param [in] value A structure representing the literal's value.
+ * \param [in] value The literal's value (whose object, if any, the tree must keep).
  * \return A structure representing the syntax tree node.
  */
 node make_new_literal(literal_value value) {
     node current;
     current.type = LITERAL_NODE;
-    current.entry.literal_val.type = value.type;
-    // need to copy over actualdata contained
-    if (current.entry.literal_val.type == NUMBER_VALUE) {
-        current.entry.literal_val.data.number = value.data.number;
-    } else if (current.entry.literal_val.type == STRING_VALUE) {
-        for (int i = 0; i < MAX_LIT_LEN; i++) {
-            current.entry.literal_val.data.string[i] = value.data.string[i];
-        }
-    }
+    current.entry.literal_val = value;
     return current;
 }
 
 
 /**
  * \brief Constructor for a binary logical operation's syntax tree node.
- * \param [in] left Pointer to the node representing the first operand.
+ * \param [in] left The index of the node representing the first operand.
  * \param [in] opcode The token representing the operation to complete.
- * \param [in] right Pointer to the node representing the second operand.
+ * \param [in] right The index of the node representing the second operand.
  * \return A structure representing the syntax tree node.
  */
-node make_new_logical(node * left, lexemes opcode, node * right) {
+node make_new_logical(int left, lexemes opcode, int right) {
     node current;
     current.type = LOGICAL_NODE;
     current.entry.logical_val.left = left;
@@ -177,10 +172,10 @@ node make_new_special(lexemes keyword) {
 /**
  * \brief Constructor for a unary operation's syntax tree node.
  * \param [in] opcode The token representing the operation to complete.
- * \param [in] right Pointer to the node representing the operand.
+ * \param [in] right The index of the node representing the operand.
  * \return A structure representing the syntax tree node.
  */
-node make_new_unary(lexemes opcode, node * right) {
+node make_new_unary(lexemes opcode, int right) {
     node current;
     current.type = UNARY_NODE;
     current.entry.unary_val.opcode = opcode;
@@ -191,26 +186,27 @@ node make_new_unary(lexemes opcode, node * right) {
 
 /**
  * \brief Constructor for an variable-fetching operation's syntax tree node.
- * \param [in] name The name of identifier to read from.
+ * \param [in] name The symbol of the identifier to read from.
  * \return A structure representing the syntax tree node.
  */
-node make_new_variable(char name[]) {
+node make_new_variable(int name) {
     node current;
     current.type = VARIABLE_NODE;
-    for (int i = 0; i < MAX_IDENTIFIER_LEN; i++) {
-        current.entry.variable_val.name[i] = name[i];
-    }
+    current.entry.variable_val.name = name;
+    current.entry.variable_val.depth = 0;
+    current.entry.variable_val.slot = UNRESOLVED_SLOT;
     return current;
 }
 
 
 /**
  * \brief Constructor for a while loop statement's syntax tree node.
- * \param [in] expression Pointer to the node representing the condition to branch on at each iteration.
- * \param [in] statements Pointer to the node representing the statements to run at each iteration.
+ * \param [in] expression The index of the node representing the condition to branch on at each iteration.
+ * \param [in] statements The index of the node representing the statements to run at each iteration.
+ * \param [in] end The index of the node representing the statements to run after normal execution.
  * \return A structure representing the syntax tree node.
  */
-node make_new_whileloop(node * expression, node * statements, node * end) {
+node make_new_whileloop(int expression, int statements, int end) {
     node current;
     current.type = WHILELOOP_NODE;
     current.entry.whileloop_val.expression = expression;
@@ -221,120 +217,396 @@ node make_new_whileloop(node * expression, node * statements, node * end) {
 
 
 /**
- * \brief Converts a literal value to a properly-formatted string.
- * \param [in] value The literal value to be converted into a string.
- * \param [inout] output_ptr Pointer to the output string buffer.
+ * \brief Stores a node at the end of a syntax tree, starting a new page of nodes when the last one is full.
+ * \param [inout] tree Pointer to the syntax tree to store the node in.
+ * \param [in] value Pointer to the node to store.
+ * \return The index of the stored node; NO_NODE if memory ran out.
+ */
+int add_node(syntax_tree * tree, const node * value) {
+    // the first index is reserved to mean no node at all, so it holds a statement that does nothing
+    int index = tree -> num_nodes;
+    if (index == 0) {
+        index = 1;
+    }
+    // pages are never moved, so nodes already stored stay where they are
+    int page = index >> NODE_PAGE_SHIFT;
+    if ((index == 1) || ((index & ((1 << NODE_PAGE_SHIFT) - 1)) == 0)) {
+        // make room for more pages by doubling the space for them (this table outlives the arena)
+        if (page >= (tree -> page_capacity)) {
+            int capacity = (tree -> page_capacity) ? (2 * (tree -> page_capacity)) : MIN_NUM_PAGES;
+            node ** pages = (node **) realloc(tree -> pages, capacity * sizeof(node *));
+            if (!pages) {
+                return NO_NODE;
+            }
+            tree -> pages = pages;
+            tree -> page_capacity = capacity;
+        }
+        node * nodes = (node *) arena_allocate(&(tree -> memory), (1 << NODE_PAGE_SHIFT) * sizeof(node));
+        if (!nodes) {
+            return NO_NODE;
+        }
+        tree -> pages[page] = nodes;
+    }
+    if (index == 1) {
+        *node_at(tree, NO_NODE) = make_new_special(PASS);
+    }
+    *node_at(tree, index) = *value;
+    tree -> num_nodes = index + 1;
+    return index;
+}
+
+
+/**
+ * \brief Stores the statements of a block as one contiguous run at the end of a syntax tree's list of statements.
+ * \param [inout] tree Pointer to the syntax tree to store the statements in.
+ * \param [in] statements The indices of the nodes of the statements (which must not be in the tree's list already).
+ * \param [in] count The number of statements to store.
+ * \return The position of the first stored statement in the list; -1 if memory ran out.
+ */
+int add_statements(syntax_tree * tree, const int * statements, int count) {
+    // make room for more statements by doubling the space for them
+    if ((tree -> num_statements) + count > (tree -> statement_capacity)) {
+        int capacity = (tree -> statement_capacity) ? (tree -> statement_capacity) : MIN_NUM_STATEMENTS;
+        while (capacity < (tree -> num_statements) + count) {
+            capacity *= 2;
+        }
+        int * resized = (int *) realloc(tree -> statements, capacity * sizeof(int));
+        if (!resized) {
+            return -1;
+        }
+        tree -> statements = resized;
+        tree -> statement_capacity = capacity;
+    }
+    int first = tree -> num_statements;
+    memcpy(tree -> statements + first, statements, count * sizeof(int));
+    tree -> num_statements += count;
+    return first;
+}
+
+
+/**
+ * \brief Hands a syntax tree the reference to a value, so that it is released along with the tree.
+ * \param [inout] tree Pointer to the syntax tree to keep the value.
+ * \param [in] value The value, whose reference now belongs to the tree.
+ * \return 0 if the value is kept; 1 if memory ran out (and the value was released).
+ */
+int keep_value(syntax_tree * tree, literal_value value) {
+    // only objects need releasing, so numbers and immediates are not tracked
+    if (!is_object(&value)) {
+        return 0;
+    }
+    owned_value * kept = (owned_value *) arena_allocate(&(tree -> memory), sizeof(owned_value));
+    if (!kept) {
+        release(&value);
+        return 1;
+    }
+    kept -> value = value;
+    kept -> next = tree -> owned;
+    tree -> owned = kept;
+    return 0;
+}
+
+
+/**
+ * \brief Creates the value of a string literal for a syntax tree, interning its characters straight from the source.
+ * \param [inout] tree Pointer to the syntax tree to keep the string.
+ * \param [in] text The characters of the string (which need not be null-terminated).
+ * \param [in] length The number of characters in the string.
+ * \param [inout] value Pointer to where to store the string's value.
+ * \return 0 if the string was created; 1 if memory ran out.
+ */
+int add_string_literal(syntax_tree * tree, const char * text, int length, literal_value * value) {
+    if (intern_string(text, length, value)) {
+        return 1;
+    }
+    return keep_value(tree, *value);
+}
+
+
+/**
+ * \brief Creates the value of a number literal for a syntax tree, reading its digits straight from the source.
+ * \param [inout] tree Pointer to the syntax tree to keep the number (if it is too big for an int).
+ * \param [in] text The digits of the number (which need not be null-terminated).
+ * \param [in] length The number of digits.
+ * \param [inout] value Pointer to where to store the number's value.
+ * \return 0 if the number was created; 1 if memory ran out; 2 if the number itself could not be made (which has been reported).
+ */
+int add_number_literal(syntax_tree * tree, const char * text, int length, literal_value * value) {
+    if (parse_number(text, length, value)) {
+        return 2;
+    }
+    return keep_value(tree, *value);
+}
+
+
+/**
+ * \brief Drops the references held by a syntax tree, before its arena is reset.
+ * \param [inout] tree Pointer to the syntax tree of interest.
  */
-void stringify_value(literal_value value, char ** output_ptr) {
-    switch (value.type) {
+static void release_owned(syntax_tree * tree) {
+    for (owned_value * kept = tree -> owned; kept; kept = kept -> next) {
+        release(&(kept -> value));
+    }
+    tree -> owned = NULL;
+}
+
+
+/**
+ * \brief Empties a syntax tree in constant time, keeping its memory so that the next tree needs no allocation.
+ * \param [inout] tree Pointer to the syntax tree to empty.
+ */
+void clear_tree(syntax_tree * tree) {
+    release_owned(tree);
+    reset_arena(&(tree -> memory));
+    tree -> num_nodes = 0;
+    tree -> num_statements = 0;
+    tree -> root = NO_NODE;
+}
+
+
+/**
+ * \brief Releases the memory used by a syntax tree, leaving it empty.
+ * \param [inout] tree Pointer to the syntax tree to free.
+ */
+void free_tree(syntax_tree * tree) {
+    release_owned(tree);
+    free_arena(&(tree -> memory));
+    free(tree -> pages);
+    tree -> pages = NULL;
+    tree -> page_capacity = 0;
+    tree -> num_nodes = 0;
+    free(tree -> statements);
+    tree -> statements = NULL;
+    tree -> statement_capacity = 0;
+    tree -> num_statements = 0;
+    tree -> root = NO_NODE;
+}
+
+
+/**
+ * \brief Makes room for more characters at the end of the output, doubling its room until they fit.
+ * \param [inout] output Pointer to the output to grow.
+ * \param [in] extra The number of characters to make room for (not counting the null character).
+ * \return Pointer to where the characters go; NULL if memory ran out.
+ */
+static char * reserve_output(output_text * output, size_t extra) {
+    size_t needed = output -> length + extra + 1;
+    if (needed > output -> capacity) {
+        size_t capacity = output -> capacity ? output -> capacity : MIN_OUTPUT_LEN;
+        while (capacity < needed) {
+            capacity *= 2;
+        }
+        char * resized = (char *) realloc(output -> text, capacity);
+        if (!resized) {
+            return NULL;
+        }
+        output -> text = resized;
+        output -> capacity = capacity;
+    }
+    return output -> text + output -> length;
+}
+
+
+/**
+ * \brief Converts a literal value to a properly-formatted string, added to the end of the output.
+ * \param [in] value Pointer to the literal value to be converted into a string.
+ * \param [inout] output Pointer to the output, which grows to fit the whole string.
+ * \return 0 on success; 1 if memory ran out.
+ */
+int stringify_value(const literal_value * value, output_text * output) {
+    // None prints nothing, and everything else is measured first so that it is never cut off
+    const char * text = NULL;
+    char * digits = NULL;
+    int length = 0;
+    switch (type_of(value)) {
         case FALSE_VALUE:
-            sprintf(*output_ptr, "%sFalse\n", *output_ptr);
+            text = "False";
+            length = 5;
             break;
 
         case NONE_VALUE:
-            break;
+            return 0;
 
         case NUMBER_VALUE:
-            sprintf(*output_ptr, "%s%d\n", *output_ptr, value.data.number);
+            // numbers too big for an int have their digits written out first
+            if (is_object(value)) {
+                digits = number_text(value);
+                if (!digits) {
+                    return 1;
+                }
+                text = digits;
+                length = strlen(digits);
+            } else {
+                length = snprintf(NULL, 0, "%d", number_of(value));
+            }
             break;
 
         case STRING_VALUE:
-            sprintf(*output_ptr, "%s\'%s\'\n", *output_ptr, value.data.string);
+            text = string_of(value);
+            length = length_of(value);
             break;
 
         case TRUE_VALUE:
-            sprintf(*output_ptr, "%sTrue\n", *output_ptr);
+            text = "True";
+            length = 4;
             break;
     }
+    // strings are wrapped in quotes, and every value ends its own line
+    bool quoted = (type_of(value) == STRING_VALUE);
+    char * end = reserve_output(output, length + (quoted ? 3 : 1));
+    if (!end) {
+        free(digits);
+        return 1;
+    }
+    if (quoted) {
+        *end++ = '\'';
+    }
+    if (text) {
+        memcpy(end, text, length);
+    } else {
+        snprintf(end, length + 1, "%d", number_of(value));
+    }
+    end += length;
+    if (quoted) {
+        *end++ = '\'';
+    }
+    *end++ = '\n';
+    *end = '\0';
+    output -> length = end - output -> text;
+    free(digits);
+    return 0;
+}
+
+
+/**
+ * \brief Empties the output, keeping its memory for the next command to write into.
+ * \param [inout] output Pointer to the output to clear.
+ */
+void clear_output(output_text * output) {
+    output -> length = 0;
+    if (output -> text) {
+        output -> text[0] = '\0';
+    }
+}
+
+
+/**
+ * \brief Releases the memory used by the output, leaving it empty.
+ * \param [inout] output Pointer to the output to free.
+ */
+void free_output(output_text * output) {
+    free(output -> text);
+    output -> text = NULL;
+    output -> length = 0;
+    output -> capacity = 0;
+}
+
+
+/**
+ * \brief Prints a literal value for debugging.
+ * \param [in] value Pointer to the literal value to print.
+ */
+void print_value(const literal_value * value) {
+    literal_types type = type_of(value);
+    if (type == FALSE_VALUE) {
+        printf(" False ");
+    } else if (type == NONE_VALUE) {
+        printf(" None ");
+    } else if (type == NUMBER_VALUE) {
+        printf(" ");
+        if (is_object(value)) {
+            char * digits = number_text(value);
+            printf("%s", digits ? digits : "...");
+            free(digits);
+        } else {
+            printf("%d", number_of(value));
+        }
+        printf(" ");
+    } else if (type == STRING_VALUE) {
+        printf(" ");
+        printf("%.*s", length_of(value), string_of(value));
+        printf(" ");
+    } else if (type == TRUE_VALUE) {
+        printf(" True ");
+    }
 }
 
 
 /**
  * \brief Prints the generated syntax tree for debugging.
- * \param [in] tree The tree (or subtree, or node) to print.
+ * \param [in] tree Pointer to the syntax tree containing the node.
+ * \param [in] index The index of the tree (or subtree, or node) to print.
  */
-void print_tree(node tree) {
-    int i = 0;
-    switch (tree.type) {
+void print_tree(const syntax_tree * tree, int index) {
+    const node * current = node_at(tree, index);
+    switch (current -> type) {
         case ASSIGN_NODE:
             printf(" ( ");
-            printf(tree.entry.assign_val.name);
+            printf(symbol_name(current -> entry.assign_val.name));
             printf(" GETS ");
-            print_tree(*(tree.entry.assign_val.value));
+            print_tree(tree, current -> entry.assign_val.value);
             printf(" ) ");
             break;
 
         case BINARY_NODE:
             printf(" ( ");
-            print_tree(*(tree.entry.binary_val.left));
-            printf(token_names[tree.entry.binary_val.opcode]);
-            print_tree(*(tree.entry.binary_val.right));
+            print_tree(tree, current -> entry.binary_val.left);
+            printf(token_names[current -> entry.binary_val.opcode]);
+            print_tree(tree, current -> entry.binary_val.right);
             printf(" ) ");
             break;
 
         case BLOCK_NODE:
             printf("BLOCK (\n");
-            while (tree.entry.block_val.statements[i] != NULL) {
+            for (int i = 0; i < (current -> entry.block_val.count); i++) {
                 printf("    STATEMENT: ");
-                print_tree(*(tree.entry.block_val.statements[i]));
+                print_tree(tree, statement_at(tree, &(current -> entry.block_val), i));
                 printf("\n");
-                i++;
             }
             printf(")");
             break;
 
         case GROUPING_NODE:
             printf(" ( ");
-            print_tree(*(tree.entry.grouping_val.expression));
+            print_tree(tree, current -> entry.grouping_val.expression);
             printf(" ) ");
             break;
 
         case IFELSE_NODE:
             printf("if ( ");
-            print_tree(*(tree.entry.ifelse_val.condition));
+            print_tree(tree, current -> entry.ifelse_val.condition);
             printf(" ) then ( ");
-            print_tree(*(tree.entry.ifelse_val.ifbranch));
+            print_tree(tree, current -> entry.ifelse_val.ifbranch);
             printf(" ) else ( ");
-            print_tree(*(tree.entry.ifelse_val.elsebranch));
+            print_tree(tree, current -> entry.ifelse_val.elsebranch);
             break;
 
         case LITERAL_NODE:
-            if (tree.entry.literal_val.type == FALSE_VALUE) {
-                printf(" False ");
-            } else if (tree.entry.literal_val.type == NONE_VALUE) {
-                printf(" None ");
-            } else if (tree.entry.literal_val.type == NUMBER_VALUE) {
-                printf(" ");
-                printf("%d", tree.entry.literal_val.data.number);
-                printf(" ");
-            } else if (tree.entry.literal_val.type == STRING_VALUE) {
-                printf(" ");
-                printf(tree.entry.literal_val.data.string);
-                printf(" ");
-            } else if (tree.entry.literal_val.type == TRUE_VALUE) {
-                printf(" True ");
-            }
+            print_value(&(current -> entry.literal_val));
             break;
 
         case LOGICAL_NODE:
             printf(" ( ");
-            print_tree(*(tree.entry.logical_val.left));
-            printf(token_names[tree.entry.logical_val.opcode]);
-            print_tree(*(tree.entry.logical_val.right));
+            print_tree(tree, current -> entry.logical_val.left);
+            printf(token_names[current -> entry.logical_val.opcode]);
+            print_tree(tree, current -> entry.logical_val.right);
             printf(" ) ");
             break;
             
         case UNARY_NODE:
             printf(" ( ");
-            printf(token_names[tree.entry.unary_val.opcode]);
-            print_tree(*(tree.entry.unary_val.right));
+            printf(token_names[current -> entry.unary_val.opcode]);
+            print_tree(tree, current -> entry.unary_val.right);
             printf(" ) ");
             break;
 
         case VARIABLE_NODE:
             printf(" ( ");
-            printf(tree.entry.variable_val.name);
+            printf(symbol_name(current -> entry.variable_val.name));
             printf(" ) ");
             break;
+
+        default:
+            break;
     }
 }
@@ -9,43 +9,42 @@
 #include <cstdio>
 #include "utility.h"
 
-
-// the maximum number of characters in a literal
-#ifndef MAX_LIT_LEN
-#define MAX_LIT_LEN 32
+// the widest vector instructions available scan runs of characters a block at a time
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
 #endif
 
 
-/**
- * \brief Determines if a particular character is a numerical digit or not, like the standard isdigit().
- * \param [in] character The character to test.
- * \return True if the character is a digit; false otherwise.
- */
-bool isdigit(char character) {
-    return ((character >= '0') && (character <= '9'));
-}
+// shorthands for the kinds of character, to keep the table below readable
+#define D CHAR_DIGIT
+#define A CHAR_ALPHA
+#define S CHAR_SPACE
 
+// the kinds of every character, indexed by its (unsigned) value; characters past 127 are none of them
+const unsigned char char_classes[256] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, S, 0, 0, S, 0, 0, 0,    // control characters, with tab and form feed
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    S, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,    // space and punctuation
+    D, D, D, D, D, D, D, D, D, D, 0, 0, 0, 0, 0, 0,    // '0' to '9'
+    0, A, A, A, A, A, A, A, A, A, A, A, A, A, A, A,    // 'A' to 'O'
+    A, A, A, A, A, A, A, A, A, A, A, 0, 0, 0, 0, A,    // 'P' to 'Z' and '_'
+    0, A, A, A, A, A, A, A, A, A, A, A, A, A, A, A,    // 'a' to 'o'
+    A, A, A, A, A, A, A, A, A, A, A, 0, 0, 0, 0, 0,    // 'p' to 'z'
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+};
 
-/**
- * \brief Determines if a particular character is a letter or not, like the standard isalpha().
- * \param [in] character The character to test.
- * \return True if the character is a letter or underscore; false otherwise.
- */
-bool isalpha(char character) {
-    return (((character >= 'a') && (character <= 'z')) ||
-            ((character >= 'A') && (character <= 'Z')) ||
-            (character == '_'));
-}
-
-
-/**
- * \brief Determines if a particular character is a letter or digit not, like the standard isalphanumeric().
- * \param [in] character The character to test.
- * \return True if the character is a letter or digit; false otherwise.
- */
-bool isalphanumeric(char character) {
-    return (isalpha(character) || isdigit(character));
-}
+#undef D
+#undef A
+#undef S
 
 
 /**
@@ -100,3 +99,199 @@ int stoi(char ** num_str, int str_len) {
 void itos(char ** num_str, int num_value) {
     sprintf(*num_str, "%d", num_value); 
 }
+
+
+/** Runs of characters are scanned a whole block at a time where the processor has vector instructions.
+    Each character of the block is tested at once, and the test's results are gathered into one bit per character.
+    The first character that fails the test is then the lowest clear bit; whatever is left over at the end is scanned one by one.
+    Blocks are never loaded past the end given, so the text need not be padded.
+*/
+
+
+#if defined(__AVX2__)
+
+// the number of characters tested at once
+#define BLOCK_SIZE 32
+typedef __m256i block;
+
+static inline block load_block(const char * text) { return _mm256_loadu_si256((const __m256i *) text); }
+static inline block fill_block(char character) { return _mm256_set1_epi8(character); }
+static inline block equal_bytes(block a, block b) { return _mm256_cmpeq_epi8(a, b); }
+static inline block either_bytes(block a, block b) { return _mm256_or_si256(a, b); }
+static inline block sub_bytes(block a, block b) { return _mm256_sub_epi8(a, b); }
+static inline block max_bytes(block a, block b) { return _mm256_max_epu8(a, b); }
+static inline unsigned int block_bits(block a) { return (unsigned int) _mm256_movemask_epi8(a); }
+
+#elif defined(__SSE2__)
+
+#define BLOCK_SIZE 16
+typedef __m128i block;
+
+static inline block load_block(const char * text) { return _mm_loadu_si128((const __m128i *) text); }
+static inline block fill_block(char character) { return _mm_set1_epi8(character); }
+static inline block equal_bytes(block a, block b) { return _mm_cmpeq_epi8(a, b); }
+static inline block either_bytes(block a, block b) { return _mm_or_si128(a, b); }
+static inline block sub_bytes(block a, block b) { return _mm_sub_epi8(a, b); }
+static inline block max_bytes(block a, block b) { return _mm_max_epu8(a, b); }
+static inline unsigned int block_bits(block a) { return (unsigned int) _mm_movemask_epi8(a); }
+
+#endif
+
+
+#ifdef BLOCK_SIZE
+
+// every bit of a block's results set, as when every character passes the test
+#define ALL_BITS ((unsigned int) ((1ULL << BLOCK_SIZE) - 1))
+
+
+/**
+ * \brief Tests every character of a block for lying in a range of values.
+ * \param [in] characters The block of characters to test.
+ * \param [in] low The lowest character in the range.
+ * \param [in] high The highest character in the range.
+ * \return A block holding all ones for each character in the range, and zero otherwise.
+ */
+static inline block in_range(block characters, char low, char high) {
+    // shifting the range down to start at zero lets one unsigned comparison check both of its ends
+    block offset = sub_bytes(characters, fill_block(low));
+    block limit = fill_block((char) (high - low));
+    return equal_bytes(max_bytes(offset, limit), limit);
+}
+
+
+/**
+ * \brief Tests every character of a block for being a digit.
+ * \param [in] text The start of the block.
+ * \return One bit per character of the block, set if it is a digit.
+ */
+static inline unsigned int digit_bits(const char * text) {
+    return block_bits(in_range(load_block(text), '0', '9'));
+}
+
+
+/**
+ * \brief Tests every character of a block for being a letter, digit, or underscore.
+ * \param [in] text The start of the block.
+ * \return One bit per character of the block, set if it is a letter, digit, or underscore.
+ */
+static inline unsigned int alphanumeric_bits(const char * text) {
+    block characters = load_block(text);
+    block matches = either_bytes(in_range(characters, 'a', 'z'), in_range(characters, 'A', 'Z'));
+    matches = either_bytes(matches, in_range(characters, '0', '9'));
+    return block_bits(either_bytes(matches, equal_bytes(characters, fill_block('_'))));
+}
+
+
+/**
+ * \brief Tests every character of a block for being whitespace within a line.
+ * \param [in] text The start of the block.
+ * \return One bit per character of the block, set if it is a space, tab, or form feed.
+ */
+static inline unsigned int space_bits(const char * text) {
+    block characters = load_block(text);
+    block matches = either_bytes(equal_bytes(characters, fill_block(' ')), equal_bytes(characters, fill_block('\t')));
+    return block_bits(either_bytes(matches, equal_bytes(characters, fill_block('\f'))));
+}
+
+#endif
+
+
+/**
+ * \brief Finds the end of a run of digits.
+ * \param [in] text The text to scan.
+ * \param [in] start The index of the first character to test.
+ * \param [in] end The index to stop scanning at.
+ * \return The index of the first character from start on that is not a digit, or end if there is none.
+ */
+int skip_digits(const char * text, int start, int end) {
+#ifdef BLOCK_SIZE
+    while (start + BLOCK_SIZE <= end) {
+        unsigned int misses = ~digit_bits(text + start) & ALL_BITS;
+        if (misses) {
+            return start + __builtin_ctz(misses);
+        }
+        start += BLOCK_SIZE;
+    }
+#endif
+    while ((start < end) && isdigit(text[start])) {
+        start++;
+    }
+    return start;
+}
+
+
+/**
+ * \brief Finds the end of a run of letters, digits, and underscores, such as the rest of an identifier.
+ * \param [in] text The text to scan.
+ * \param [in] start The index of the first character to test.
+ * \param [in] end The index to stop scanning at.
+ * \return The index of the first character from start on that is not a letter, digit, or underscore, or end if there is none.
+ */
+int skip_alphanumerics(const char * text, int start, int end) {
+#ifdef BLOCK_SIZE
+    while (start + BLOCK_SIZE <= end) {
+        unsigned int misses = ~alphanumeric_bits(text + start) & ALL_BITS;
+        if (misses) {
+            return start + __builtin_ctz(misses);
+        }
+        start += BLOCK_SIZE;
+    }
+#endif
+    while ((start < end) && isalphanumeric(text[start])) {
+        start++;
+    }
+    return start;
+}
+
+
+/**
+ * \brief Finds the end of a run of whitespace within a line.
+ * \param [in] text The text to scan.
+ * \param [in] start The index of the first character to test.
+ * \param [in] end The index to stop scanning at.
+ * \return The index of the first character from start on that is not a space, tab, or form feed, or end if there is none.
+ */
+int skip_spaces(const char * text, int start, int end) {
+#ifdef BLOCK_SIZE
+    while (start + BLOCK_SIZE <= end) {
+        unsigned int misses = ~space_bits(text + start) & ALL_BITS;
+        if (misses) {
+            return start + __builtin_ctz(misses);
+        }
+        start += BLOCK_SIZE;
+    }
+#endif
+    while ((start < end) && isspace(text[start])) {
+        start++;
+    }
+    return start;
+}
+
+
+/**
+ * \brief Finds the first of either of two characters, such as the end of a string literal or comment.
+ * \param [in] text The text to scan.
+ * \param [in] start The index of the first character to test.
+ * \param [in] end The index to stop scanning at.
+ * \param [in] first One character to look for.
+ * \param [in] second The other character to look for (which may be the same as the first).
+ * \return The index of the first character from start on that is either one, or end if there is none.
+ */
+int find_either(const char * text, int start, int end, char first, char second) {
+#ifdef BLOCK_SIZE
+    block firsts = fill_block(first);
+    block seconds = fill_block(second);
+    while (start + BLOCK_SIZE <= end) {
+        block characters = load_block(text + start);
+        unsigned int hits = block_bits(either_bytes(equal_bytes(characters, firsts), equal_bytes(characters, seconds)));
+        if (hits) {
+            return start + __builtin_ctz(hits);
+        }
+        start += BLOCK_SIZE;
+    }
+#endif
+    while ((start < end) && (text[start] != first) && (text[start] != second)) {
+        start++;
+    }
+    return start;
+}
@@ -0,0 +1,340 @@
+/*********************************************************************************
+* Description: Defines the tagged word that every value of the interpreter is held in
+* Author(s): Isaac Joffe
+* Copyright: University of Alberta, 2024
+* License: CC-BY-4.0
+*********************************************************************************/
+
+
+#include <cstdlib>
+#include <cstring>
+#include "table.h"
+#include "value.h"
+
+
+/**
+ * \brief The table of interned strings, using open addressing with linear probing.
+ */
+struct intern_table {
+    // the interned strings, found by their hashes (NULL for an empty entry)
+    string_object ** entries = NULL;
+    // the number of strings interned
+    int count = 0;
+    // the total number of entries, in use or not (always a power of 2)
+    int capacity = 0;
+};
+
+
+// every short string literal with the same characters is the one string object stored here
+static intern_table interned_strings;
+
+// the strings of each single character, made the first time one is needed (one block, never freed)
+static char * character_block = NULL;
+
+// the space each string of a single character takes in the block, keeping each aligned to 8 bytes
+#define CHARACTER_STRIDE ((sizeof(string_object) + 1 + 7) & ~((size_t) 7))
+
+
+/**
+ * \brief Creates a string object with one reference to it, holding its own characters with some room to spare.
+ * \param [in] length The number of characters in the string.
+ * \param [in] capacity The number of characters to make room for (at least length).
+ * \param [inout] value Pointer to where to store the value referring to the string.
+ * \return Pointer to the string; NULL if memory ran out.
+ */
+static string_object * new_storage(int length, int capacity, literal_value * value) {
+    if ((length < 0) || (length > MAX_STRING_LEN)) {
+        return NULL;
+    }
+    // malloc gives memory aligned to at least 8 bytes, leaving the lowest bits of the pointer free for the tag
+    string_object * object = (string_object *) malloc(sizeof(string_object) + capacity);
+    if (!object) {
+        return NULL;
+    }
+    object -> header.type = STRING_VALUE;
+    object -> header.references = 1;
+    object -> length = length;
+    object -> hash = 0;
+    object -> text = object -> characters;
+    object -> storage = object;
+    object -> capacity = capacity;
+    object -> used = length;
+    object -> interned = false;
+    value -> bits = (uint64_t) (uintptr_t) object;
+    return object;
+}
+
+
+/**
+ * \brief Creates a string object with one reference to it, leaving its characters for the caller to write.
+ * \param [in] length The number of characters in the string.
+ * \param [inout] value Pointer to where to store the value referring to the string.
+ * \return Pointer to where the characters go; NULL if memory ran out.
+ */
+char * new_string(int length, literal_value * value) {
+    string_object * object = new_storage(length, length, value);
+    return object ? object -> text : NULL;
+}
+
+
+/**
+ * \brief Creates a string object holding a copy of some characters, with one reference to it.
+ * \param [in] text The characters of the string (which need not be null-terminated).
+ * \param [in] length The number of characters in the string.
+ * \param [inout] value Pointer to where to store the value referring to the string.
+ * \return 0 if the string was created; 1 if memory ran out.
+ */
+int make_string(const char * text, int length, literal_value * value) {
+    char * characters = new_string(length, value);
+    if (!characters) {
+        return 1;
+    }
+    memcpy(characters, text, length);
+    return 0;
+}
+
+
+/**
+ * \brief Creates a string object holding the characters of one string followed by those of another.
+ * \param [in] left Pointer to a value holding the first string.
+ * \param [in] right Pointer to a value holding the second string.
+ * \param [inout] value Pointer to where to store the value referring to the new string.
+ * \return 0 if the string was created; 1 if it would be too long or memory ran out.
+ */
+int append_string(const literal_value * left, const literal_value * right, literal_value * value) {
+    const string_object * first = (const string_object *) object_of(left);
+    const string_object * second = (const string_object *) object_of(right);
+    long long length = (long long) first -> length + second -> length;
+    if (length > MAX_STRING_LEN) {
+        return 1;
+    }
+    string_object * storage = first -> storage;
+    // the first string can be extended in place if nothing has been written after it yet, and there is room
+    if ((storage -> used == first -> length) && (storage -> capacity >= length)) {
+        string_object * object = (string_object *) malloc(sizeof(string_object));
+        if (!object) {
+            return 1;
+        }
+        // the second string may share the same memory, but only ever the part before what is written
+        memcpy(storage -> text + first -> length, second -> text, second -> length);
+        storage -> used = length;
+        storage -> header.references++;
+        object -> header.type = STRING_VALUE;
+        object -> header.references = 1;
+        object -> length = length;
+        object -> hash = 0;
+        object -> text = storage -> text;
+        object -> storage = storage;
+        object -> capacity = 0;
+        object -> used = 0;
+        object -> interned = false;
+        value -> bits = (uint64_t) (uintptr_t) object;
+        return 0;
+    }
+    // otherwise the result gets memory of its own, with room for as much again to be appended later
+    long long capacity = 2 * length;
+    if (capacity > MAX_STRING_LEN) {
+        capacity = MAX_STRING_LEN;
+    }
+    string_object * object = new_storage(length, capacity, value);
+    if (!object) {
+        return 1;
+    }
+    memcpy(object -> text, first -> text, first -> length);
+    memcpy(object -> text + first -> length, second -> text, second -> length);
+    return 0;
+}
+
+
+/**
+ * \brief Locates the entry holding the interned string with some characters, or the empty entry where it would go.
+ * \param [in] entries The entries of the table to search.
+ * \param [in] capacity The number of entries in the table (a power of 2).
+ * \param [in] text The characters to search for.
+ * \param [in] length The number of characters.
+ * \param [in] hash The hash of the characters.
+ * \return Pointer to the matching entry, or to an empty one if no string with the characters is interned.
+ */
+static string_object ** find_interned(string_object ** entries, int capacity, const char * text, int length, unsigned int hash) {
+    // capacity is a power of 2, so masking is the same as taking the remainder
+    unsigned int index = hash & (capacity - 1);
+    while (true) {
+        string_object * entry = entries[index];
+        if (!entry ||
+            ((entry -> hash == hash) && (entry -> length == length) && (memcmp(entry -> text, text, length) == 0))) {
+            return &(entries[index]);
+        }
+        // collision, so try the next entry along
+        index = (index + 1) & (capacity - 1);
+    }
+}
+
+
+/**
+ * \brief Moves every interned string into a larger block of entries.
+ * \param [in] capacity The new number of entries (a power of 2).
+ * \return 0 if the table was grown; 1 if memory ran out.
+ */
+static int grow_interned(int capacity) {
+    string_object ** entries = (string_object **) calloc(capacity, sizeof(string_object *));
+    if (!entries) {
+        return 1;
+    }
+    // reinsert each interned string, whose position depends on the capacity
+    for (int i = 0; i < interned_strings.capacity; i++) {
+        string_object * entry = interned_strings.entries[i];
+        if (entry) {
+            *find_interned(entries, capacity, entry -> text, entry -> length, entry -> hash) = entry;
+        }
+    }
+    free(interned_strings.entries);
+    interned_strings.entries = entries;
+    interned_strings.capacity = capacity;
+    return 0;
+}
+
+
+/**
+ * \brief Takes a string out of the intern table, once nothing refers to it.
+ * \param [in] string Pointer to the interned string.
+ */
+static void forget_interned(const string_object * string) {
+    unsigned int mask = interned_strings.capacity - 1;
+    string_object ** entries = interned_strings.entries;
+    unsigned int hole = string -> hash & mask;
+    while (entries[hole] != string) {
+        hole = (hole + 1) & mask;
+    }
+    // later strings that collided may now move back, so that no search stops at the emptied entry too soon
+    for (unsigned int next = (hole + 1) & mask; entries[next]; next = (next + 1) & mask) {
+        unsigned int home = entries[next] -> hash & mask;
+        // a string may fill the hole if the hole lies between where it belongs and where it is
+        if (((next - home) & mask) >= ((next - hole) & mask)) {
+            entries[hole] = entries[next];
+            hole = next;
+        }
+    }
+    entries[hole] = NULL;
+    interned_strings.count--;
+}
+
+
+/**
+ * \brief Fetches the interned string object holding some characters, creating it if no such string is interned yet.
+ * \param [in] text The characters of the string (which need not be null-terminated).
+ * \param [in] length The number of characters in the string.
+ * \param [inout] value Pointer to where to store the value referring to the string (with a reference added).
+ * \return 0 if the string was found or created; 1 if memory ran out.
+ */
+int intern_string(const char * text, int length, literal_value * value) {
+    if (length == 1) {
+        return make_character(text[0], value);
+    }
+    // long strings are simply made, since they are unlikely to be written more than once
+    if (length > MAX_INTERN_LEN) {
+        return make_string(text, length, value);
+    }
+    unsigned int hash = hash_string(text, length);
+    if (interned_strings.count > 0) {
+        string_object ** entry = find_interned(interned_strings.entries, interned_strings.capacity, text, length, hash);
+        if (*entry) {
+            value -> bits = (uint64_t) (uintptr_t) (*entry);
+            (*entry) -> header.references++;
+            return 0;
+        }
+    }
+    if (make_string(text, length, value)) {
+        return 1;
+    }
+    string_object * string = (string_object *) object_of(value);
+    string -> hash = hash;
+    // grow before the table gets so full that probe sequences become long (a string that cannot be stored is just not interned)
+    if (4 * (interned_strings.count + 1) > TABLE_MAX_LOAD * interned_strings.capacity) {
+        int capacity = interned_strings.capacity ? (2 * interned_strings.capacity) : INTERN_MIN_CAPACITY;
+        if (grow_interned(capacity)) {
+            return 0;
+        }
+    }
+    *find_interned(interned_strings.entries, interned_strings.capacity, text, length, hash) = string;
+    string -> interned = true;
+    interned_strings.count++;
+    return 0;
+}
+
+
+/**
+ * \brief Makes the strings of every single character, all in one block.
+ * \return 0 if the strings were made; 1 if memory ran out.
+ */
+static int make_characters() {
+    // malloc gives memory aligned to at least 8 bytes, and each string takes a multiple of 8 bytes
+    character_block = (char *) malloc(256 * CHARACTER_STRIDE);
+    if (!character_block) {
+        return 1;
+    }
+    for (int i = 0; i < 256; i++) {
+        string_object * object = (string_object *) (character_block + i * CHARACTER_STRIDE);
+        // the block holds a reference to each string, so that none is ever freed
+        object -> header.type = STRING_VALUE;
+        object -> header.references = 1;
+        object -> length = 1;
+        object -> text = object -> characters;
+        object -> text[0] = (char) i;
+        object -> hash = hash_string(object -> text, 1);
+        object -> storage = object;
+        object -> capacity = 1;
+        object -> used = 1;
+        object -> interned = true;
+    }
+    return 0;
+}
+
+
+/**
+ * \brief Fetches the string object holding a single character, which is only ever made once.
+ * \param [in] character The character of the string.
+ * \param [inout] value Pointer to where to store the value referring to the string (with a reference added).
+ * \return 0 if the string was found; 1 if memory ran out.
+ */
+int make_character(char character, literal_value * value) {
+    if (!character_block && make_characters()) {
+        return 1;
+    }
+    string_object * object = (string_object *) (character_block + (unsigned char) character * CHARACTER_STRIDE);
+    object -> header.references++;
+    value -> bits = (uint64_t) (uintptr_t) object;
+    return 0;
+}
+
+
+/**
+ * \brief Finds the hash of the characters of a string, computing it only the first time.
+ * \param [in] value Pointer to a value holding a string.
+ * \return The hash of the string.
+ */
+unsigned int hash_of(const literal_value * value) {
+    string_object * string = (string_object *) object_of(value);
+    // a string whose hash really is 0 just has it computed each time
+    if (!(string -> hash)) {
+        string -> hash = hash_string(string -> text, string -> length);
+    }
+    return string -> hash;
+}
+
+
+/**
+ * \brief Releases the memory used by an object once nothing refers to it.
+ * \param [inout] object Pointer to the object to free.
+ */
+void free_object(heap_object * object) {
+    // a string made by appending holds a reference to the string whose memory it shares,
+    // and an interned string is forgotten by the intern table along with it
+    string_object * string = (string_object *) object;
+    if ((object -> type == STRING_VALUE) && (string -> storage != string)) {
+        literal_value storage = {(uint64_t) (uintptr_t) (string -> storage)};
+        release(&storage);
+    } else if ((object -> type == STRING_VALUE) && (string -> interned)) {
+        forget_interned(string);
+    }
+    free(object);
+}
@@ -0,0 +1,300 @@
+/*********************************************************************************
+* Description: The virtual machine (executes the bytecode produced by the compiler)
+* Author(s): Isaac Joffe
+* Copyright: University of Alberta, 2024
+* License: CC-BY-4.0
+*********************************************************************************/
+
+
+#include <cstdio>
+#include "chunk.h"
+#include "environment.h"
+#include "error.h"
+#include "operations.h"
+#include "vm.h"
+
+
+/** Much of this code is based on Crafting Interpreters by Robert Nystrom.
+    Specifically, this file takes inspiration mostly from these chapters:
+      * Chapter 15 (https://craftinginterpreters.com/a-virtual-machine.html)
+      * Chapter 23 (https://craftinginterpreters.com/jumping-back-and-forth.html)
+    The operators themselves live in operations.cpp so that the results match the evaluator's exactly.
+*/
+
+
+/**
+ * \brief Constructor for the virtual machine class.
+ * \param [inout] env Pointer to the pre-created environment to use.
+ */
+VirtualMachine::VirtualMachine(environment * env) {
+    this -> env = env;
+}
+
+
+/**
+ * \brief Finds the scope that a resolved variable is stored in.
+ * \param [in] depth The number of scopes out from the current one, as found by the resolver.
+ * \return Pointer to the environment of that scope.
+ */
+environment * VirtualMachine::scope_at(int depth) {
+    // walk out exactly as far as needed, never searching by name
+    environment * scope = env;
+    for (int i = 0; i < depth; i++) {
+        scope = scope -> enclosing;
+    }
+    return scope;
+}
+
+
+/**
+ * \brief Executes each instruction of a chunk of bytecode in turn.
+ * \param [in] code Pointer to the bytecode to execute.
+ * \return 0 if execution succeeded; non-zero value if an error occurred.
+ */
+int VirtualMachine::run(chunk * code) {
+    // keep the hottest state in locals so the compiler can keep it in registers
+    unsigned char * ip = code -> code;
+    literal_value * constants = code -> constants;
+    literal_value * stack_top = stack;
+    while (true) {
+        // decode the next instruction and call the appropriate logic
+        switch (*ip++) {
+            // push a stored constant
+            case OP_CONSTANT:
+                *stack_top = constants[*ip++];
+                retain(stack_top);
+                stack_top++;
+                break;
+            case OP_CONSTANT_LONG:
+                *stack_top = constants[(ip[0] << 16) | (ip[1] << 8) | ip[2]];
+                ip += 3;
+                retain(stack_top);
+                stack_top++;
+                break;
+
+            // push a sentinel value
+            case OP_NONE:
+                *stack_top = make_none();
+                stack_top++;
+                break;
+            case OP_TRUE:
+                *stack_top = make_bool(true);
+                stack_top++;
+                break;
+            case OP_FALSE:
+                *stack_top = make_bool(false);
+                stack_top++;
+                break;
+
+            // discard the top value
+            case OP_POP:
+                stack_top--;
+                release(stack_top);
+                break;
+
+            // discard the top value, adding it to the output string
+            case OP_PRINT:
+                stack_top--;
+                if (stringify_value(stack_top, printed)) {
+                    report_failure("out of memory for output");
+                    return fail(stack_top + 1);
+                }
+                release(stack_top);
+                break;
+
+            // push the value of a variable, found directly by its scope and slot
+            case OP_GET_VARIABLE: {
+                environment * scope = scope_at(ip[0]);
+                int slot = (ip[1] << 16) | (ip[2] << 8) | ip[3];
+                ip += 4;
+                if (!(scope -> defined[slot])) {
+                    report_error(NAME, "name is not defined");
+                    return fail(stack_top);
+                }
+                *stack_top = scope -> values[slot];
+                retain(stack_top);
+                stack_top++;
+                break;
+            }
+
+            // pop a value and assign it to a variable, found directly by its scope and slot
+            case OP_SET_VARIABLE: {
+                environment * scope = scope_at(ip[0]);
+                int slot = (ip[1] << 16) | (ip[2] << 8) | ip[3];
+                ip += 4;
+                stack_top--;
+                // the variable's reference moves from the stack, and the one to its old value is dropped
+                release(&(scope -> values[slot]));
+                scope -> values[slot] = *stack_top;
+                scope -> defined[slot] = true;
+                break;
+            }
+
+            // replace the top two values with the result of an operator
+            case OP_BINARY: {
+                lexemes opcode = (lexemes) *ip++;
+                literal_value result;
+                if (apply_binary(opcode, stack_top - 2, stack_top - 1, &result)) {
+                    return fail(stack_top);
+                }
+                stack_top--;
+                release(stack_top - 1);
+                release(stack_top);
+                *(stack_top - 1) = result;
+                break;
+            }
+
+            // replace the top value with the result of an operator
+            case OP_UNARY: {
+                lexemes opcode = (lexemes) *ip++;
+                literal_value result;
+                if (apply_unary(opcode, stack_top - 1, &result)) {
+                    return fail(stack_top);
+                }
+                release(stack_top - 1);
+                *(stack_top - 1) = result;
+                break;
+            }
+
+            // move forwards unconditionally
+            case OP_JUMP: {
+                int offset = (ip[0] << 16) | (ip[1] << 8) | ip[2];
+                ip += 3 + offset;
+                break;
+            }
+
+            // move forwards if the top value is false, leaving it in place (short-circuiting)
+            case OP_JUMP_IF_FALSE: {
+                int offset = (ip[0] << 16) | (ip[1] << 8) | ip[2];
+                ip += 3;
+                if (!boolify(stack_top - 1)) {
+                    ip += offset;
+                }
+                break;
+            }
+
+            // move forwards if the top value is true, leaving it in place (short-circuiting)
+            case OP_JUMP_IF_TRUE: {
+                int offset = (ip[0] << 16) | (ip[1] << 8) | ip[2];
+                ip += 3;
+                if (boolify(stack_top - 1)) {
+                    ip += offset;
+                }
+                break;
+            }
+
+            // pop the top value and move forwards if it is false (branching)
+            case OP_POP_JUMP_IF_FALSE: {
+                int offset = (ip[0] << 16) | (ip[1] << 8) | ip[2];
+                ip += 3;
+                stack_top--;
+                if (!boolify(stack_top)) {
+                    ip += offset;
+                }
+                release(stack_top);
+                break;
+            }
+
+            // move backwards unconditionally
+            case OP_LOOP: {
+                int offset = (ip[0] << 16) | (ip[1] << 8) | ip[2];
+                ip += 3 - offset;
+                break;
+            }
+
+            // start iterating over the top value by pushing the position within it
+            case OP_GET_ITER:
+                if (!is_iterable(type_of(stack_top - 1))) {
+                    // error detected, the variable to iterate over must be iterable
+                    report_error(SYNTAX, "object is not iterable");
+                    return fail(stack_top);
+                }
+                *stack_top = make_number(0);
+                stack_top++;
+                break;
+
+            // assign the next item to the loop variable, or pop the iterator and leave the loop
+            case OP_FOR_ITER: {
+                environment * scope = scope_at(ip[0]);
+                int slot = (ip[1] << 16) | (ip[2] << 8) | ip[3];
+                ip += 4;
+                int offset = (ip[0] << 16) | (ip[1] << 8) | ip[2];
+                ip += 3;
+                const char * iterable = string_of(stack_top - 2);
+                int index = number_of(stack_top - 1);
+                // iterator of a string is just each character (itself another string)
+                if (index < length_of(stack_top - 2)) {
+                    literal_value iterator;
+                    if (make_character(iterable[index], &iterator)) {
+                        report_failure("out of memory for string");
+                        return fail(stack_top);
+                    }
+                    release(&(scope -> values[slot]));
+                    scope -> values[slot] = iterator;
+                    scope -> defined[slot] = true;
+                    *(stack_top - 1) = make_number(index + 1);
+                } else {
+                    // the position is just a number, so only the string needs releasing
+                    stack_top -= 2;
+                    release(stack_top);
+                    ip += offset;
+                }
+                break;
+            }
+
+            // end of the command
+            case OP_RETURN:
+                return 0;
+
+            // theoretically unreachable
+            default:
+                report_failure("no such instruction exists");
+                return fail(stack_top);
+        }
+    }
+}
+
+
+/**
+ * \brief Stops execution after an error, dropping the values left on the stack.
+ * \param [in] stack_top Pointer to just past the top value of the stack.
+ * \return 1, since an error occurred.
+ */
+int VirtualMachine::fail(literal_value * stack_top) {
+    while (stack_top > stack) {
+        stack_top--;
+        release(stack_top);
+    }
+    error_occurred = true;
+    return 1;
+}
+
+
+/**
+ * \brief Tells if an error has occurred while executing bytecode.
+ * \return True if an error has occurred; false otherwise.
+ */
+bool VirtualMachine::has_error() {
+    return error_occurred;
+}
+
+
+/**
+ * \brief Executes the input bytecode.
+ * \param [in] input The bytecode to execute.
+ * \param [inout] output Pointer to where to store the text to be printed.
+ * \return 0 if execution succeeded; non-zero value if an error occurred.
+ */
+int VirtualMachine::run_input(chunk * input, output_text * output) {
+    // write straight into the caller's output, clearing it from other runs
+    printed = output;
+    clear_output(printed);
+    error_occurred = false;
+    // execute the whole chunk
+    run(input);
+    // report any errors that occurred during execution
+    if (has_error()) {
+        return 1;
+    }
+    return 0;
+}
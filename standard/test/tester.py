@@ -69,6 +69,8 @@ def main():
             is_incorrect = (outputs[i] != 'TypeError')
         except ZeroDivisionError:
             is_incorrect = (outputs[i] != 'ZeroDivisionError')
+        except SyntaxError:
+            is_incorrect = (outputs[i] != 'SyntaxError')
         # print error information to help localize
         if is_incorrect:
             error_count += 1
@@ -108,6 +110,12 @@ def main():
                         if message == outputs[test_number]:
                             test_number += 1
                             continue
+                    # account for syntax errors, which have no traceback
+                    if line[1].strip().startswith('File'):
+                        message = data[i + 1].split(':')[0]
+                        if message == outputs[test_number]:
+                            test_number += 1
+                            continue
                     # print error information to help localize
                     error_count += 1
                     print(f'Error in test #{test_number}:')